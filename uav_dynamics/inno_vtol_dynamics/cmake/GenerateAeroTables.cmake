@@ -0,0 +1,103 @@
+# Convert aerodynamics_coeffs.yaml into a header of constexpr arrays
+#
+# Usage: cmake -DINPUT=<yaml> -DOUTPUT=<header> -DAIRFRAME=<type name> -P GenerateAeroTables.cmake
+#
+# The header defines AIRFRAME as a struct with a constexpr array per table of
+# TablesWithCoeffs named as its field, see InnoVtolAeroModel. The arrays are in the yaml
+# order, their sizes are checked by InnoVtolAeroModel at compile time.
+
+if(NOT INPUT OR NOT OUTPUT OR NOT AIRFRAME)
+    message(FATAL_ERROR "GenerateAeroTables: INPUT, OUTPUT and AIRFRAME must be set")
+endif()
+
+# yaml name : TablesWithCoeffs field
+set(AERO_TABLES
+    CS_rudder_table:CS_rudder
+    CS_beta:CS_beta
+    AoA:AoA
+    AoS:AoS
+    actuator_table:actuator
+    airspeed_table:airspeed
+    CLPolynomial:CLPolynomial
+    CSPolynomial:CSPolynomial
+    CDPolynomial:CDPolynomial
+    CmxPolynomial:CmxPolynomial
+    CmyPolynomial:CmyPolynomial
+    CmzPolynomial:CmzPolynomial
+    CmxAileron:CmxAileron
+    CmyElevator:CmyElevator
+    CmzRudder:CmzRudder
+    prop:prop
+    actuatorTimeConstants:actuatorTimeConstants
+)
+set(VALUES_PER_LINE 8)
+
+file(READ ${INPUT} YAML_CONTENT)
+string(REGEX REPLACE "#[^\n]*" "" YAML_CONTENT "${YAML_CONTENT}")
+get_filename_component(INPUT_NAME ${INPUT} NAME)
+get_filename_component(OUTPUT_NAME ${OUTPUT} NAME)
+string(REGEX REPLACE "([a-z0-9])([A-Z])" "\\1_\\2" GUARD "${AIRFRAME}_GENERATED_HPP")
+string(TOUPPER "${GUARD}" GUARD)
+
+set(DECLARATIONS "")
+set(DEFINITIONS "")
+foreach(TABLE ${AERO_TABLES})
+    string(REPLACE ":" ";" TABLE ${TABLE})
+    list(GET TABLE 0 YAML_NAME)
+    list(GET TABLE 1 FIELD_NAME)
+
+    string(REGEX MATCH "(^|\n)${YAML_NAME}[ \t]*:[ \t\r\n]*\\[([^]]*)\\]" MATCHED "${YAML_CONTENT}")
+    if(NOT MATCHED)
+        message(FATAL_ERROR "GenerateAeroTables: there is no ${YAML_NAME} in ${INPUT}")
+    endif()
+    string(REGEX MATCHALL "[-+]?[0-9]*\\.?[0-9]+([eE][-+]?[0-9]+)?" NUMBERS "${CMAKE_MATCH_2}")
+    list(LENGTH NUMBERS SIZE)
+
+    set(BODY "")
+    set(IDX 0)
+    foreach(NUMBER ${NUMBERS})
+        # leading zeros would make an integer literal octal
+        string(REGEX REPLACE "^([-+]?)0+([0-9])" "\\1\\2" NUMBER ${NUMBER})
+        math(EXPR COL "${IDX} % ${VALUES_PER_LINE}")
+        if(IDX EQUAL 0)
+            set(BODY "        ${NUMBER}")
+        elseif(COL EQUAL 0)
+            set(BODY "${BODY},\n        ${NUMBER}")
+        else()
+            set(BODY "${BODY}, ${NUMBER}")
+        endif()
+        math(EXPR IDX "${IDX} + 1")
+    endforeach()
+
+    set(DECLARATIONS "${DECLARATIONS}    static constexpr Scalar ${FIELD_NAME}[${SIZE}] = {\n${BODY}\n    };\n")
+    set(DEFINITIONS "${DEFINITIONS}template<typename Scalar>\nconstexpr Scalar ${AIRFRAME}T<Scalar>::${FIELD_NAME}[${SIZE}];\n")
+endforeach()
+
+set(HEADER "/**
+ * @file ${OUTPUT_NAME}
+ * @brief Aerodynamic tables of ${AIRFRAME} generated from ${INPUT_NAME}, do not edit
+ */
+
+#ifndef ${GUARD}
+#define ${GUARD}
+
+/**
+ * @note It is a template only to define the arrays in the header
+ */
+template<typename Scalar>
+struct ${AIRFRAME}T{
+${DECLARATIONS}};
+
+${DEFINITIONS}
+typedef ${AIRFRAME}T<double> ${AIRFRAME};
+
+#endif  // ${GUARD}
+")
+
+# Unchanged header is not rewritten, so the dependent sources are not rebuilt
+if(EXISTS ${OUTPUT})
+    file(READ ${OUTPUT} OLD_HEADER)
+endif()
+if(NOT "${OLD_HEADER}" STREQUAL "${HEADER}")
+    file(WRITE ${OUTPUT} "${HEADER}")
+endif()
@@ -0,0 +1,92 @@
+/**
+ * @file actuatorsDynamics.hpp
+ * @brief Actuators dynamics as exactly discretized first or second order lags with
+ * rate and position limits
+ */
+
+#ifndef ACTUATORS_DYNAMICS_HPP
+#define ACTUATORS_DYNAMICS_HPP
+
+#include <Eigen/Dense>
+#include <string>
+
+typedef Eigen::Array<double, 8, 1> ActuatorsArray;
+
+/**
+ * @brief Per vehicle actuators state. It is kept apart from ActuatorsDynamics, so the
+ * cached coefficients might be shared between many vehicles.
+ */
+struct ActuatorsState{
+    ActuatorsArray position = ActuatorsArray::Zero();   // the same units as the command
+    ActuatorsArray rate = ActuatorsArray::Zero();       // units/sec
+};
+
+/**
+ * @brief First order model is tau * x' + x = u, it is a motor or a fast servo.
+ * Second order model is a critically damped servo tau^2 * x'' + 2 * tau * x' + x = u.
+ * Both are discretized exactly with zero order hold of the command, the coefficients are
+ * calculated once per time constants and sample period and recalculated only when dt
+ * changes, so a tick is a few array multiply-adds without any transcendental call.
+ * The coefficients are calculated for dt rounded to DT_QUANTUM, so a wall-clock dt with
+ * a jitter still hits the cache, the rounding error is negligible for any time constant.
+ * The position is clamped by [min, max] and its change by rateMax, zero or negative
+ * time constant means an ideal actuator.
+ */
+class ActuatorsDynamics{
+public:
+    enum Model_t{
+        FIRST_ORDER = 0,
+        SECOND_ORDER,
+    };
+
+    ActuatorsDynamics();
+
+    void setModel(Model_t model);
+    Model_t getModel() const {return model_;}
+    void setTimeConstants(const ActuatorsArray& timeConstants);
+    void setLimits(const ActuatorsArray& positionMin,
+                   const ActuatorsArray& positionMax,
+                   const ActuatorsArray& rateMax);
+
+    /**
+     * @param modelName - "first_order" or "second_order"
+     * @return -1 if the name is unknown, else 0
+     */
+    static int8_t parseModel(const std::string& modelName, Model_t& model);
+
+    /**
+     * @brief Advance the actuators on dtSecs toward the command
+     */
+    void process(ActuatorsState& state, const ActuatorsArray& cmd, double dtSecs);
+
+    /**
+     * @return how many times the coefficients have been calculated, it is for tests
+     */
+    size_t getCoefficientsUpdatesAmount() const {return coefficientsUpdates_;}
+
+    static constexpr double DT_QUANTUM = 1e-6;          // sec
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+private:
+    void updateCoefficients(double dtSecs);
+
+    Model_t model_ = FIRST_ORDER;
+    ActuatorsArray timeConstants_;                      // sec
+    ActuatorsArray positionMin_;
+    ActuatorsArray positionMax_;
+    ActuatorsArray rateMax_;                            // units/sec
+
+    /**
+     * @note The error e = x - u and the rate v evolve as [e, v]' = Phi * [e, v] with
+     * Phi = [c11, c12; c21, c22], the first order model uses only c11
+     */
+    double coefficientsDt_;                             // sec, NaN means invalidated
+    size_t coefficientsUpdates_ = 0;
+    ActuatorsArray c11_;
+    ActuatorsArray c12_;
+    ActuatorsArray c21_;
+    ActuatorsArray c22_;
+};
+
+#endif  // ACTUATORS_DYNAMICS_HPP
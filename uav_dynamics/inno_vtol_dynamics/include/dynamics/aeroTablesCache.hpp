@@ -0,0 +1,66 @@
+/**
+ * @file aeroTablesCache.hpp
+ * @brief Binary cache of the aerodynamic tables for fast startup without parameter server
+ */
+
+#ifndef AERO_TABLES_CACHE_HPP
+#define AERO_TABLES_CACHE_HPP
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include "vtolDynamicsSim.hpp"
+
+/**
+ * @brief File layout is a header, a directory of named blocks and the blocks themselves.
+ * Each block is a row-major float64 table aligned to ALIGNMENT bytes from the file start.
+ * The header holds the checksum of everything after it and the checksum of the yaml file
+ * the tables were loaded from, so a corrupted or an outdated cache is rejected and the
+ * caller falls back to the parameter server.
+ */
+class AeroTablesCache{
+public:
+    /**
+     * @param sourceChecksum - expected checksum of the source yaml, see calculateFileChecksum
+     * @return -1 if there is no valid cache, else 0
+     */
+    static int8_t load(const std::string& path, uint64_t sourceChecksum, TablesWithCoeffs& tables);
+
+    /**
+     * @brief The file is written into a temporary file and renamed, so the concurrently
+     * started simulators never see a partially written cache
+     */
+    static int8_t save(const std::string& path, uint64_t sourceChecksum, const TablesWithCoeffs& tables);
+
+    /**
+     * @brief 64-bit FNV-1a
+     */
+    static uint64_t calculateChecksum(const void* data, size_t size, uint64_t checksum = FNV_OFFSET_BASIS);
+
+    /**
+     * @return checksum of the file content or 0 if the file can't be read
+     */
+    static uint64_t calculateFileChecksum(const std::string& path);
+
+    static constexpr uint32_t VERSION = 1;
+    static constexpr size_t ALIGNMENT = 64;
+    static constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+
+private:
+    struct Header{
+        char magic[8];
+        uint32_t version;
+        uint32_t blocksAmount;
+        uint64_t fileSize;                          // bytes
+        uint64_t sourceChecksum;
+        uint64_t payloadChecksum;                   // everything after the header
+    };
+    struct Block{
+        char name[32];
+        uint32_t rows;
+        uint32_t cols;
+        uint64_t offset;                            // bytes from the file start
+    };
+};
+
+#endif  // AERO_TABLES_CACHE_HPP
@@ -0,0 +1,98 @@
+/**
+ * @file airframeRegistry.hpp
+ * @brief Immutable aerodynamic tables shared by the simulators of the same airframe within
+ * a process and across the processes on the same host
+ */
+
+#ifndef AIRFRAME_REGISTRY_HPP
+#define AIRFRAME_REGISTRY_HPP
+
+#include <string>
+#include <map>
+#include <mutex>
+#include <memory>
+#include <functional>
+#include "vtolDynamicsKernel.hpp"
+
+/**
+ * @brief Each distinct airframe is loaded once and the simulators attach to it by name
+ * (see VtolDynamicsKernel::init with SharedTables), so many simulators on one host keep a
+ * single copy of the tables and it stays hot in the shared cache.
+ * The registry keeps only weak references: the tables are released with the last simulator
+ * that uses them and loaded again by the next request.
+ */
+class AirframeRegistry{
+    public:
+        typedef VtolDynamicsKernel<double>::SharedTables SharedTables;
+        typedef std::function<void(TablesWithCoeffs&)> Loader;
+
+        /**
+         * @brief The process wide registry, InnoVtolDynamicsSim::init uses it
+         */
+        static AirframeRegistry& getInstance();
+
+        /**
+         * @brief In-process tables, the loader is called only if they are not loaded yet.
+         * Concurrent requests wait for the single load.
+         * @throw exceptions of the loader are passed to the caller, nothing is registered then
+         */
+        SharedTables get(const std::string& name, const Loader& loader);
+
+        /**
+         * @brief As get, but the tables are in the POSIX shared memory object with the name and
+         * mapped read only, so the simulators of all the processes read the same physical
+         * pages. The first process loads and publishes them, the others only map them.
+         * The object outlives the processes until unlinkShared.
+         * An object of another source yaml or layout, or the one whose creator has not made
+         * it ready within the attach timeout (e.g. it died), is unlinked and created again.
+         * The processes that have mapped the old object keep using it.
+         * @param name - POSIX shared memory name, e.g. "/inno_vtol_airframe"
+         * @param sourceChecksum - checksum of the source yaml as in AeroTablesCache, 0 means
+         * it is unknown and the object of any source is used
+         * @return nullptr if the object can't be created or mapped
+         */
+        SharedTables getShared(const std::string& name, const Loader& loader, uint64_t sourceChecksum = 0);
+
+        /**
+         * @brief Remove the shared memory object, the processes that have mapped it keep
+         * their mapping and the next getShared loads the tables again
+         */
+        static int8_t unlinkShared(const std::string& name);
+
+        /**
+         * @return how many times the loaders have been called, it is for diagnostics
+         */
+        size_t getLoadsAmount() const;
+
+        /**
+         * @brief How long getShared waits for another process to make the object ready
+         */
+        void setAttachTimeout(double timeoutSec);
+
+        static constexpr double ATTACH_TIMEOUT = 5.0;               // sec
+
+    private:
+        enum SharedStatus_t{
+            SHARED_ATTACHED = 0,
+            SHARED_NOT_FOUND,
+            SHARED_STALE,                           ///< not ready in time or another source
+            SHARED_ERROR,
+        };
+        struct SharedEntry{
+            std::weak_ptr<const TablesWithCoeffs> tables;
+            uint64_t sourceChecksum;
+        };
+
+        static int8_t createShared(const std::string& name, const TablesWithCoeffs& tables,
+                                   uint64_t sourceChecksum);
+        SharedTables attachShared(const std::string& name, uint64_t sourceChecksum,
+                                  SharedStatus_t& status) const;
+
+        mutable std::mutex mutex_;
+        std::map<std::string, std::weak_ptr<const TablesWithCoeffs>> entries_;
+        std::map<std::string, SharedEntry> sharedEntries_;
+        size_t loadsAmount_ = 0;
+        double attachTimeout_ = ATTACH_TIMEOUT;     // sec
+};
+
+#endif  // AIRFRAME_REGISTRY_HPP
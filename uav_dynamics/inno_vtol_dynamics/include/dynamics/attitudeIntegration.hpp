@@ -0,0 +1,60 @@
+/**
+ * @file attitudeIntegration.hpp
+ * @brief Geometric (Lie group) integrators of the attitude quaternion
+ */
+
+#ifndef ATTITUDE_INTEGRATION_HPP
+#define ATTITUDE_INTEGRATION_HPP
+
+#include <Eigen/Geometry>
+#include <string>
+
+/**
+ * @note All angular velocities are in body frame, so the kinematics is q' = 0.5 * q * (0, w)
+ * and a step with constant w is exactly q * exp(w * dt). Unlike adding the derivative to the
+ * quaternion coefficients and renormalizing, it has no error for a constant rotation axis
+ * whatever dt and the rate are.
+ */
+namespace AttitudeIntegration
+{
+
+enum Method_t{
+    EXPONENTIAL = 0,        // exponential map of the angular velocity at the end of the step
+    CROUCH_GROSSMAN,        // 3rd order Crouch-Grossman method for attitude and angular velocity
+};
+
+/**
+ * @param methodName - "exponential" or "crouch_grossman"
+ * @return -1 if the name is unknown, else 0
+ */
+int8_t parseMethod(const std::string& methodName, Method_t& method);
+
+/**
+ * @brief Unit quaternion of the rotation vector, i.e. rotation by |v| around v
+ * @note Instantiated for float and double
+ */
+template<typename Scalar>
+Eigen::Quaternion<Scalar> expMap(const Eigen::Matrix<Scalar, 3, 1>& rotationVector);
+
+/**
+ * @brief attitude = attitude * exp(angularVel * dtSecs)
+ */
+template<typename Scalar>
+void integrateAttitude(Eigen::Quaternion<Scalar>& attitude,
+                       const Eigen::Matrix<Scalar, 3, 1>& angularVel,
+                       Scalar dtSecs);
+
+/**
+ * @brief Integrate the attitude together with the Euler rigid body equation
+ * J * w' = M - w x (J * w), the moment is constant within the step
+ */
+void integrateRigidBody(Eigen::Quaterniond& attitude,
+                        Eigen::Vector3d& angularVel,
+                        const Eigen::Matrix3d& inertia,
+                        const Eigen::Matrix3d& inertiaInverse,
+                        const Eigen::Vector3d& moment,
+                        double dtSecs);
+
+}  // namespace AttitudeIntegration
+
+#endif  // ATTITUDE_INTEGRATION_HPP
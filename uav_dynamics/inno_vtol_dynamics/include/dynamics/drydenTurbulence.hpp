@@ -0,0 +1,117 @@
+/**
+ * @file drydenTurbulence.hpp
+ * @brief Dryden turbulence model (MIL-F-8785C, low altitude) as a set of discretized
+ * shaping filters driven by white noise
+ */
+
+#ifndef DRYDEN_TURBULENCE_HPP
+#define DRYDEN_TURBULENCE_HPP
+
+#include <Eigen/Geometry>
+#include <Eigen/StdVector>
+#include <vector>
+#include <random>
+#include <cstdint>
+
+/**
+ * @brief Per vehicle filter state. It is kept apart from DrydenTurbulence, so a single
+ * coefficients table might be shared between many vehicles.
+ */
+struct DrydenFilterState{
+    double u = 0;                                   // longitudinal filter state
+    Eigen::Vector2d v = Eigen::Vector2d::Zero();    // lateral filter state
+    Eigen::Vector2d w = Eigen::Vector2d::Zero();    // vertical filter state
+    double timeAccumulator = 0;                     // sec
+    Eigen::Vector3d gust = Eigen::Vector3d::Zero(); // m/sec, body frame (FRD)
+
+    std::default_random_engine generator;
+    std::normal_distribution<double> distribution{0.0, 1.0};
+};
+
+/**
+ * @brief Longitudinal component is the first order filter
+ * H_u(s) = sigma_u * sqrt(2 * L_u / (pi * V)) / (1 + L_u / V * s),
+ * lateral and vertical components are the second order filters
+ * H_v(s) = sigma_v * sqrt(L_v / (pi * V)) * (1 + sqrt(3) * L_v / V * s) / (1 + L_v / V * s)^2.
+ * Filters are discretized exactly for a fixed sample period and their coefficients are
+ * precomputed for a grid of airspeed and altitude buckets, so a filter tick costs only a
+ * few multiply-adds. Outputs are normalized to have exactly sigma_u, sigma_v, sigma_w
+ * stationary deviations.
+ * @note Only low altitude model (below 1000 ft) is implemented, the altitude is clamped
+ */
+class DrydenTurbulence{
+public:
+    DrydenTurbulence() = default;
+
+    /**
+     * @param windSpeedAt6m - W20 from MIL-F-8785C, m/sec. 0 disables turbulence.
+     * Typical values are 7.7 (light), 15.4 (moderate) and 23.1 (severe).
+     * @param samplePeriod - filters sample period, sec
+     */
+    void init(double windSpeedAt6m, double samplePeriod = DEFAULT_SAMPLE_PERIOD);
+    bool isEnabled() const;
+
+    /**
+     * @brief Reset the filters of a vehicle and reseed its noise generator. Vehicles,
+     * processes and runs with different seeds get independent gusts.
+     */
+    static void seed(DrydenFilterState& state, uint32_t seed);
+
+    /**
+     * @return a nondeterministic seed from std::random_device
+     */
+    static uint32_t randomSeed();
+
+    /**
+     * @brief Advance the filters on dtSecs and return the gust in body frame
+     * @param airspeed - mean airspeed, m/sec
+     * @param altitude - altitude above ground, m
+     */
+    const Eigen::Vector3d& process(DrydenFilterState& state,
+                                   double dtSecs,
+                                   double airspeed,
+                                   double altitude) const;
+
+    /**
+     * @brief The same as process, but for a batch of vehicles sharing this model
+     */
+    void processBatch(DrydenFilterState* states,
+                      const double* airspeeds,
+                      const double* altitudes,
+                      size_t numberOfVehicles,
+                      double dtSecs) const;
+
+    static constexpr double DEFAULT_SAMPLE_PERIOD = 0.01;       // sec
+
+    static constexpr double AIRSPEED_BUCKET_MIN = 1.0;          // m/sec
+    static constexpr double AIRSPEED_BUCKET_STEP = 2.0;         // m/sec
+    static constexpr size_t AIRSPEED_BUCKETS_AMOUNT = 21;
+    static constexpr double ALTITUDE_BUCKET_MIN = 3.0;          // m
+    static constexpr double ALTITUDE_BUCKET_STEP = 20.0;        // m
+    static constexpr size_t ALTITUDE_BUCKETS_AMOUNT = 16;
+
+private:
+    struct BucketCoeffs{
+        double uA;
+        double uB;
+        Eigen::Matrix2d vA;
+        Eigen::Matrix2d vL;
+        Eigen::RowVector2d vC;
+        Eigen::Matrix2d wA;
+        Eigen::Matrix2d wL;
+        Eigen::RowVector2d wC;
+    };
+
+    void calculateBucket(double airspeed, double altitude, BucketCoeffs& coeffs) const;
+    void calculateSecondOrderFilter(double scaleLength, double sigma, double airspeed,
+                                    Eigen::Matrix2d& A, Eigen::Matrix2d& L,
+                                    Eigen::RowVector2d& C) const;
+    const BucketCoeffs& findBucket(double airspeed, double altitude) const;
+    void tick(const BucketCoeffs& coeffs, DrydenFilterState& state) const;
+
+    double windSpeedAt6m_ = 0;
+    double samplePeriod_ = DEFAULT_SAMPLE_PERIOD;
+    std::vector<BucketCoeffs, Eigen::aligned_allocator<BucketCoeffs>> buckets_;
+};
+
+#endif  // DRYDEN_TURBULENCE_HPP
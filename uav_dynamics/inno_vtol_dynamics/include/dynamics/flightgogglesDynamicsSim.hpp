@@ -7,13 +7,13 @@
 #define MULTICOPTER_DYNAMICS_WRAPPER_BASE_HPP
 
 #include "uavDynamicsSimBase.hpp"
-#include "../libs/multicopterDynamicsSim/multicopterDynamicsSim.hpp"
+#include "../libs/multicopterDynamicsSim/multicopterDynamics.hpp"
 
 class FlightgogglesDynamics: public UavDynamicsSimBase{
 public:
     FlightgogglesDynamics();
 
-    virtual int8_t init() override;
+    virtual int8_t init(const ParamsSource& source) override;
     virtual void setInitialPosition(const Eigen::Vector3d & position,
                                     const Eigen::Quaterniond& attitude) override;
 
@@ -25,17 +25,44 @@ public:
     virtual Eigen::Vector3d getVehicleAngularVelocity(void) const;
     virtual void getIMUMeasurement(Eigen::Vector3d & accOutput, Eigen::Vector3d & gyroOutput);
 
+    /**
+     * @brief The policy is read from multicopter_params: integration_method is euler or rk4
+     * and integration_substeps splits each process() call into equal physics steps, so the
+     * motors time constant limits only the inner step and not the outer physics rate
+     */
+    enum IntegrationMethod_t{
+        INTEGRATION_EULER = 0,
+        INTEGRATION_RK4,
+    };
+    IntegrationMethod_t getIntegrationMethod() const {return integrationMethod_;}
+    size_t getSubstepsAmount() const {return substepsAmount_;}
+    void setIntegrationPolicy(IntegrationMethod_t integrationMethod, size_t substepsAmount);
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
 private:
-    MulticopterDynamicsSim * multicopterSim_;
+    typedef MulticopterDynamics<4> QuadcopterDynamics;
+    QuadcopterDynamics * multicopterSim_;
 
-    void initStaticMotorTransform();
+    IntegrationMethod_t integrationMethod_ = INTEGRATION_EULER;
+    size_t substepsAmount_ = 1;
+    Eigen::Array4d mappedCmd_;
+
+    void initStaticMotorTransform(const ParamsSource& source);
+    int8_t initIntegrationPolicy(const ParamsSource& source);
+
+    /**
+     * @brief Flightgoggles motor index is 0 - front left, 1 - tail left, 2 - tail right,
+     * 3 - front right, the table holds PX4 index of each of them
+     */
+    static constexpr uint8_t PX4_MOTORS_INDEXES[4] = {2, 1, 3, 0};
 
     /**
      * @brief Convert actuator indexes from PX4 notation to internal Flightgoggles notation
      * @param cmd with indexes: 0 - front right, 1 - tail left, 2 - front left, 3 - tail right
-     * @return cmd with indexes: 0 - front left, 1 - tail left, 2 - tail right, 3 - front right
+     * @param mappedCmd with indexes: 0 - front left, 1 - tail left, 2 - tail right, 3 - front right
      */
-    std::vector<double> mapCmdActuator(std::vector<double> cmd) const;
+    static void mapCmdActuator(const std::vector<double>& cmd, Eigen::Array4d& mappedCmd);
 };
 
 #endif  // MULTICOPTER_DYNAMICS_WRAPPER_BASE_HPP
\ No newline at end of file
@@ -0,0 +1,205 @@
+/**
+ * @file innoVtolAeroModel.hpp
+ * @brief Vtol dynamics kernel with the aerodynamic tables compiled in for a fixed airframe
+ */
+
+#ifndef INNO_VTOL_AERO_MODEL_HPP
+#define INNO_VTOL_AERO_MODEL_HPP
+
+#include <cstddef>
+#include <iterator>
+#include <algorithm>
+#include <type_traits>
+#include "vtolDynamicsKernel.hpp"
+
+/**
+ * @return true if each stride-th element is strictly increasing or, if allowed, strictly
+ * decreasing, it is the first column of a row major table
+ */
+template<size_t N>
+constexpr bool isAeroTableSorted(const double (&data)[N], size_t stride, bool isDescendingAllowed = false){
+    bool isAscending = true;
+    bool isDescending = isDescendingAllowed;
+    for(size_t idx = stride; idx < N; idx += stride){
+        isAscending = isAscending && data[idx - stride] < data[idx];
+        isDescending = isDescending && data[idx - stride] > data[idx];
+    }
+    return isAscending || isDescending;
+}
+
+/**
+ * @brief Row major view of a constexpr array with the interface of an Eigen table used by
+ * the lookups of VtolDynamicsKernel, so the sizes and the values are compile time constants
+ * there. Negation gives the view of the negated table without a copy.
+ */
+template<size_t Rows, size_t Cols>
+class AeroTableView{
+    public:
+        constexpr explicit AeroTableView(const double* data, double sign = 1.0) : data_(data), sign_(sign){}
+
+        constexpr double operator()(size_t row, size_t col) const {return sign_ * data_[row * Cols + col];}
+        constexpr double operator()(size_t idx) const {return sign_ * data_[idx];}
+        constexpr AeroTableView operator-() const {return AeroTableView(data_, -sign_);}
+        static constexpr size_t rows() {return Rows;}
+        static constexpr size_t cols() {return Cols;}
+        static constexpr size_t size() {return Rows * Cols;}
+
+    private:
+        const double* data_;
+        double sign_;
+};
+
+/**
+ * @return view of the generated array with the shape of the table of TablesWithCoeffs
+ */
+template<typename Table, size_t N>
+constexpr AeroTableView<Table::RowsAtCompileTime, Table::ColsAtCompileTime> makeAeroTableView(const double (&data)[N]){
+    static_assert(N == static_cast<size_t>(Table::SizeAtCompileTime),
+                  "InnoVtolAeroModel: generated table has a wrong size");
+    return AeroTableView<Table::RowsAtCompileTime, Table::ColsAtCompileTime>(data);
+}
+
+/**
+ * @brief The same fields as the Eigen tables of TablesWithCoeffs
+ */
+struct AeroTableViews{
+    #define VIEW(table) AeroTableView<decltype(TablesWithCoeffs::table)::RowsAtCompileTime, \
+                                      decltype(TablesWithCoeffs::table)::ColsAtCompileTime> table
+    VIEW(CS_rudder);
+    VIEW(CS_beta);
+    VIEW(AoA);
+    VIEW(AoS);
+    VIEW(actuator);
+    VIEW(airspeed);
+    VIEW(CLPolynomial);
+    VIEW(CSPolynomial);
+    VIEW(CDPolynomial);
+    VIEW(CmxPolynomial);
+    VIEW(CmyPolynomial);
+    VIEW(CmzPolynomial);
+    VIEW(CmxAileron);
+    VIEW(CmyElevator);
+    VIEW(CmzRudder);
+    VIEW(prop);
+    #undef VIEW
+};
+
+template<typename Airframe>
+constexpr AeroTableViews makeAeroTableViews(){
+    #define VIEW(table, data) makeAeroTableView<decltype(TablesWithCoeffs::table)>(Airframe::data)
+    return AeroTableViews{
+        VIEW(CS_rudder, CS_rudder),
+        VIEW(CS_beta, CS_beta),
+        VIEW(AoA, AoA),
+        VIEW(AoS, AoS),
+        VIEW(actuator, actuator),
+        VIEW(airspeed, airspeed),
+        VIEW(CLPolynomial, CLPolynomial),
+        VIEW(CSPolynomial, CSPolynomial),
+        VIEW(CDPolynomial, CDPolynomial),
+        VIEW(CmxPolynomial, CmxPolynomial),
+        VIEW(CmyPolynomial, CmyPolynomial),
+        VIEW(CmzPolynomial, CmzPolynomial),
+        VIEW(CmxAileron, CmxAileron),
+        VIEW(CmyElevator, CmyElevator),
+        VIEW(CmzRudder, CmzRudder),
+        VIEW(prop, prop),
+    };
+    #undef VIEW
+}
+
+/**
+ * @brief Airframe is a struct of constexpr arrays generated by cmake/GenerateAeroTables.cmake
+ * from aerodynamics_coeffs.yaml, see INNO_VTOL_GENERATED_AERO_TABLES option in CMakeLists.txt.
+ * The sizes of the tables and the order of the lookup columns are checked at compile time, so
+ * a broken yaml fails the build. The aerodynamics of the model reads the generated arrays
+ * directly through AeroTableView, so the table sizes are constants and the compiler may
+ * unroll and fold the lookups. The rest of the kernel (thrusters, step) reads the copy of
+ * the tables made at init without any parsing or parameter server requests.
+ */
+template<typename Airframe>
+class InnoVtolAeroModel : public VtolDynamicsKernel<double>{
+    public:
+        InnoVtolAeroModel() = default;
+        explicit InnoVtolAeroModel(const VtolParameters& params){
+            init(params);
+        }
+
+        static constexpr AeroTableViews TABLES = makeAeroTableViews<Airframe>();
+
+        /**
+         * @brief VtolDynamicsKernel::calculateAerodynamics over the compile time tables
+         */
+        void calculateAerodynamics(const Eigen::Vector3d& airspeed,
+                                   double AoA,
+                                   double AoS,
+                                   double aileron_pos,
+                                   double elevator_pos,
+                                   double rudder_pos,
+                                   Eigen::Vector3d& Faero,
+                                   Eigen::Vector3d& Maero,
+                                   AeroComponents* components = nullptr) const{
+            calculateAerodynamicsUsingTables(TABLES, airspeed, AoA, AoS, aileron_pos, elevator_pos, rudder_pos,
+                                             Faero, Maero, components);
+        }
+
+        using VtolDynamicsKernel<double>::init;
+        void init(const VtolParameters& params){
+            TablesWithCoeffs tables;
+            loadTables(tables);
+            init(params, tables);
+        }
+
+        static void loadTables(TablesWithCoeffs& tables){
+            copyTable(tables.CS_rudder, Airframe::CS_rudder);
+            copyTable(tables.CS_beta, Airframe::CS_beta);
+            copyTable(tables.AoA, Airframe::AoA);
+            copyTable(tables.AoS, Airframe::AoS);
+            copyTable(tables.actuator, Airframe::actuator);
+            copyTable(tables.airspeed, Airframe::airspeed);
+            copyTable(tables.CLPolynomial, Airframe::CLPolynomial);
+            copyTable(tables.CSPolynomial, Airframe::CSPolynomial);
+            copyTable(tables.CDPolynomial, Airframe::CDPolynomial);
+            copyTable(tables.CmxPolynomial, Airframe::CmxPolynomial);
+            copyTable(tables.CmyPolynomial, Airframe::CmyPolynomial);
+            copyTable(tables.CmzPolynomial, Airframe::CmzPolynomial);
+            copyTable(tables.CmxAileron, Airframe::CmxAileron);
+            copyTable(tables.CmyElevator, Airframe::CmyElevator);
+            copyTable(tables.CmzRudder, Airframe::CmzRudder);
+            copyTable(tables.prop, Airframe::prop);
+            static_assert(std::extent<decltype(Airframe::actuatorTimeConstants)>::value ==
+                          std::tuple_size<decltype(tables.actuatorTimeConstants)>::value,
+                          "InnoVtolAeroModel: generated table has a wrong size");
+            std::copy(std::begin(Airframe::actuatorTimeConstants), std::end(Airframe::actuatorTimeConstants),
+                      tables.actuatorTimeConstants.begin());
+        }
+
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    private:
+        template<typename Table, size_t N>
+        static void copyTable(Table& table, const double (&data)[N]){
+            static_assert(N == static_cast<size_t>(Table::SizeAtCompileTime),
+                          "InnoVtolAeroModel: generated table has a wrong size");
+            table = Eigen::Map<const Table>(data);
+        }
+
+        #define COLS(table) decltype(TablesWithCoeffs::table)::ColsAtCompileTime
+        static_assert(isAeroTableSorted(Airframe::airspeed, 1), "airspeed_table must be sorted");
+        static_assert(isAeroTableSorted(Airframe::AoA, 1), "AoA must be sorted");
+        static_assert(isAeroTableSorted(Airframe::AoS, 1, true), "AoS must be sorted");
+        static_assert(isAeroTableSorted(Airframe::actuator, 1, true), "actuator_table must be sorted");
+        static_assert(isAeroTableSorted(Airframe::prop, COLS(prop)), "prop must be sorted");
+        static_assert(isAeroTableSorted(Airframe::CLPolynomial, COLS(CLPolynomial)), "CLPolynomial must be sorted");
+        static_assert(isAeroTableSorted(Airframe::CSPolynomial, COLS(CSPolynomial)), "CSPolynomial must be sorted");
+        static_assert(isAeroTableSorted(Airframe::CDPolynomial, COLS(CDPolynomial)), "CDPolynomial must be sorted");
+        static_assert(isAeroTableSorted(Airframe::CmxPolynomial, COLS(CmxPolynomial)), "CmxPolynomial must be sorted");
+        static_assert(isAeroTableSorted(Airframe::CmyPolynomial, COLS(CmyPolynomial)), "CmyPolynomial must be sorted");
+        static_assert(isAeroTableSorted(Airframe::CmzPolynomial, COLS(CmzPolynomial)), "CmzPolynomial must be sorted");
+        #undef COLS
+};
+
+template<typename Airframe>
+constexpr AeroTableViews InnoVtolAeroModel<Airframe>::TABLES;
+
+#endif  // INNO_VTOL_AERO_MODEL_HPP
@@ -0,0 +1,64 @@
+/**
+ * @file paramsSource.hpp
+ * @brief Source of the simulator parameters which doesn't depend on ROS
+ */
+
+#ifndef PARAMS_SOURCE_HPP
+#define PARAMS_SOURCE_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdint>
+
+/**
+ * @brief Parameters are addressed by the full names as on the ROS parameter server,
+ * e.g. "/uav/vtol_params/mass", so the simulators are agnostic of the source
+ */
+class ParamsSource{
+public:
+    virtual ~ParamsSource() = default;
+    virtual bool get(const std::string& name, double& value) const = 0;
+    virtual bool get(const std::string& name, std::vector<double>& value) const = 0;
+    virtual bool get(const std::string& name, std::string& value) const = 0;
+
+    /**
+     * @return directory with the package yaml configs, empty if it is unknown
+     */
+    virtual std::string getConfigDirectory() const = 0;
+};
+
+/**
+ * @brief Parameters loaded directly from the package yaml files. Only the flat subset of
+ * yaml used by the configs is supported: "key: value" where value is a number, a boolean,
+ * a string or a list of numbers which may span multiple lines.
+ */
+class YamlParamsSource : public ParamsSource{
+public:
+    /**
+     * @param ns - namespace prepended to the keys, e.g. "/uav/vtol_params/"
+     * @return -1 if error occured, else 0
+     */
+    int8_t load(const std::string& path, const std::string& ns);
+
+    /**
+     * @brief Load all the configs in the same namespaces as load_parameters.launch does,
+     * including /uav/vtol_params/aeroTablesPath
+     */
+    int8_t loadPackageConfigs(const std::string& configDirectory);
+
+    void set(const std::string& name, const std::vector<double>& value);
+    void set(const std::string& name, const std::string& value);
+
+    virtual bool get(const std::string& name, double& value) const override;
+    virtual bool get(const std::string& name, std::vector<double>& value) const override;
+    virtual bool get(const std::string& name, std::string& value) const override;
+    virtual std::string getConfigDirectory() const override {return configDirectory_;}
+
+private:
+    std::map<std::string, std::vector<double>> numbers_;
+    std::map<std::string, std::string> strings_;
+    std::string configDirectory_;
+};
+
+#endif  // PARAMS_SOURCE_HPP
@@ -9,9 +9,7 @@
 
 #include <Eigen/Geometry>
 #include <vector>
-#include <ros/ros.h>
-#include <geometry_msgs/TransformStamped.h>
-#include <tf2_ros/static_transform_broadcaster.h>
+#include "paramsSource.hpp"
 
 
 class UavDynamicsSimBase{
@@ -19,10 +17,10 @@ public:
     UavDynamicsSimBase() {};
 
     /**
-     * @brief Use rosparam here to initialize sim 
+     * @brief Load the parameters from the source and initialize sim
      * @return -1 if error occures and simulation can't start
      */
-    virtual int8_t init() = 0;
+    virtual int8_t init(const ParamsSource& source) = 0;
     virtual void setInitialPosition(const Eigen::Vector3d & position,
                                     const Eigen::Quaterniond& attitude) = 0;
 
@@ -38,6 +36,25 @@ public:
     virtual void getIMUMeasurement(Eigen::Vector3d & accOutput, Eigen::Vector3d & gyroOutput) = 0;
     virtual bool getMotorsRpm(std::vector<double>& motorsRpm);
 
+    /**
+     * @brief Run the whole loop with constant dt in a single call, the buffers are owned by
+     * the caller (e.g. numpy arrays), so nothing is allocated per step
+     * @param commands - row-major stepsAmount x commandsSize
+     * @param states - row-major stepsAmount x STATE_SIZE, each row is written by getStateVector
+     */
+    void stepN(double dt_secs,
+               const double* commands,
+               size_t commandsSize,
+               size_t stepsAmount,
+               double* states,
+               bool isCmdPercent);
+
+    /**
+     * @brief Flat state: position, linear velocity, attitude (w, x, y, z), angular velocity
+     */
+    void getStateVector(double* state) const;
+    static constexpr size_t STATE_SIZE = 13;
+
     enum CalibrationType_t{
         WORK_MODE,
         MAG_1_NORMAL=1,             // ROLL OK              ROTATE YAW POSITIVE
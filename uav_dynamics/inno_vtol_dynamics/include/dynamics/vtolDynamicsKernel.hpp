@@ -0,0 +1,477 @@
+/**
+ * @file vtolDynamicsKernel.hpp
+ * @brief Scalar templated math of the vtol dynamics: aerodynamics tables, thrusters and
+ * a rigid body step. It is instantiated for double (used by InnoVtolDynamicsSim), for
+ * float (fast mode for large batches) and partly for an automatic differentiation scalar
+ * (see vtolLinearization.hpp), so the math here should call std functions unqualified.
+ */
+
+#ifndef VTOL_DYNAMICS_KERNEL_HPP
+#define VTOL_DYNAMICS_KERNEL_HPP
+
+#include <Eigen/Geometry>
+#include <array>
+#include <vector>
+#include <memory>
+#include <algorithm>
+
+struct VtolParameters;
+
+template<typename Scalar>
+struct TablesWithCoeffsT{
+    Eigen::Matrix<Scalar, 8, 20, Eigen::RowMajor> CS_rudder;
+    Eigen::Matrix<Scalar, 8, 90, Eigen::RowMajor> CS_beta;
+
+    Eigen::Matrix<Scalar, 1, 47, Eigen::RowMajor> AoA;
+    Eigen::Matrix<Scalar, 90, 1, Eigen::ColMajor> AoS;
+
+    Eigen::Matrix<Scalar, 20, 1, Eigen::ColMajor> actuator;
+    Eigen::Matrix<Scalar, 8, 1, Eigen::ColMajor> airspeed;
+
+    Eigen::Matrix<Scalar, 8, 8, Eigen::RowMajor> CLPolynomial;
+    Eigen::Matrix<Scalar, 8, 8, Eigen::RowMajor> CSPolynomial;
+    Eigen::Matrix<Scalar, 8, 6, Eigen::RowMajor> CDPolynomial;
+    Eigen::Matrix<Scalar, 8, 8, Eigen::RowMajor> CmxPolynomial;
+    Eigen::Matrix<Scalar, 8, 8, Eigen::RowMajor> CmyPolynomial;
+    Eigen::Matrix<Scalar, 8, 8, Eigen::RowMajor> CmzPolynomial;
+
+    Eigen::Matrix<Scalar, 8, 20, Eigen::RowMajor> CmxAileron;
+    Eigen::Matrix<Scalar, 8, 20, Eigen::RowMajor> CmyElevator;
+    Eigen::Matrix<Scalar, 8, 20, Eigen::RowMajor> CmzRudder;
+
+    Eigen::Matrix<Scalar, 40, 5, Eigen::RowMajor> prop;
+
+    std::array<Scalar, 8> actuatorTimeConstants{};             // sec
+
+    TablesWithCoeffsT() = default;
+
+    /**
+     * @brief Convert the tables from another precision
+     */
+    template<typename OtherScalar>
+    explicit TablesWithCoeffsT(const TablesWithCoeffsT<OtherScalar>& other);
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+typedef TablesWithCoeffsT<double> TablesWithCoeffs;
+
+/**
+ * @brief Call visitor(name, table) for each Eigen table of TablesWithCoeffs, the names are
+ * the same as in aerodynamics_coeffs.yaml
+ */
+template<typename Tables, typename Visitor>
+void forEachTable(Tables& tables, Visitor visitor){
+    visitor("CS_rudder_table", tables.CS_rudder);
+    visitor("CS_beta", tables.CS_beta);
+    visitor("AoA", tables.AoA);
+    visitor("AoS", tables.AoS);
+    visitor("actuator_table", tables.actuator);
+    visitor("airspeed_table", tables.airspeed);
+    visitor("CLPolynomial", tables.CLPolynomial);
+    visitor("CSPolynomial", tables.CSPolynomial);
+    visitor("CDPolynomial", tables.CDPolynomial);
+    visitor("CmxPolynomial", tables.CmxPolynomial);
+    visitor("CmyPolynomial", tables.CmyPolynomial);
+    visitor("CmzPolynomial", tables.CmzPolynomial);
+    visitor("CmxAileron", tables.CmxAileron);
+    visitor("CmyElevator", tables.CmyElevator);
+    visitor("CmzRudder", tables.CmzRudder);
+    visitor("prop", tables.prop);
+}
+
+template<typename Scalar>
+template<typename OtherScalar>
+TablesWithCoeffsT<Scalar>::TablesWithCoeffsT(const TablesWithCoeffsT<OtherScalar>& other) :
+    CS_rudder(other.CS_rudder.template cast<Scalar>()),
+    CS_beta(other.CS_beta.template cast<Scalar>()),
+    AoA(other.AoA.template cast<Scalar>()),
+    AoS(other.AoS.template cast<Scalar>()),
+    actuator(other.actuator.template cast<Scalar>()),
+    airspeed(other.airspeed.template cast<Scalar>()),
+    CLPolynomial(other.CLPolynomial.template cast<Scalar>()),
+    CSPolynomial(other.CSPolynomial.template cast<Scalar>()),
+    CDPolynomial(other.CDPolynomial.template cast<Scalar>()),
+    CmxPolynomial(other.CmxPolynomial.template cast<Scalar>()),
+    CmyPolynomial(other.CmyPolynomial.template cast<Scalar>()),
+    CmzPolynomial(other.CmzPolynomial.template cast<Scalar>()),
+    CmxAileron(other.CmxAileron.template cast<Scalar>()),
+    CmyElevator(other.CmyElevator.template cast<Scalar>()),
+    CmzRudder(other.CmzRudder.template cast<Scalar>()),
+    prop(other.prop.template cast<Scalar>()){
+    std::copy(other.actuatorTimeConstants.begin(), other.actuatorTimeConstants.end(),
+              actuatorTimeConstants.begin());
+}
+
+/**
+ * @brief Aerodynamics and thrusters of InnoVTOL and a plain rigid body step on top of them.
+ * InnoVtolDynamicsSim adds wind, turbulence, actuators dynamics, sensors and landing.
+ * @note Accuracy of the float instantiation: after 2 sec of 20 m/sec flight with 1 ms steps
+ * and the tumbling up to 8 rad/sec the position differs from the double one by less than
+ * 1 mm, the velocity by less than 1 mm/sec and the attitude by less than 1e-4 rad
+ * (see VtolDynamicsKernel.floatAccuracyEnvelope). The float tables take half of the memory.
+ */
+template<typename Scalar>
+class VtolDynamicsKernel{
+    public:
+        typedef Eigen::Matrix<Scalar, 3, 1> Vector3;
+        typedef Eigen::Matrix<Scalar, 3, 3> Matrix3;
+        typedef Eigen::Quaternion<Scalar> Quaternion;
+        typedef Eigen::Array<Scalar, 8, 1> Actuators;
+
+        static constexpr size_t MOTORS_AMOUNT = 5;
+
+        /**
+         * @brief Parts of the aerodynamics, they are for debug only
+         */
+        struct AeroComponents{
+            Vector3 Flift;                              // N
+            Vector3 Fdrug;                              // N
+            Vector3 Fside;                              // N
+            Vector3 Msteer;                             // N*m
+            Vector3 Mairspeed;                          // N*m
+        };
+
+        /**
+         * @note Inertial frame is NED, body frame is FRD
+         */
+        struct RigidBodyState{
+            Vector3 position = Vector3::Zero();         // meters
+            Vector3 linearVel = Vector3::Zero();        // m/sec
+            Vector3 linearAccel = Vector3::Zero();      // m/sec^2
+            Quaternion attitude = Quaternion::Identity();
+            Vector3 angularVel = Vector3::Zero();       // rad/sec
+            Vector3 angularAccel = Vector3::Zero();     // rad/sec^2
+        };
+
+        /**
+         * @brief Tables are immutable after init, so the kernels with the same tables may
+         * share them (see airframeRegistry.hpp), copies of a kernel share them too
+         */
+        typedef std::shared_ptr<const TablesWithCoeffsT<Scalar>> SharedTables;
+
+        /**
+         * @brief The tables are copied (converted to Scalar) into a new shared instance
+         */
+        void init(const VtolParameters& params, const TablesWithCoeffs& tables);
+
+        /**
+         * @brief The tables are attached without a copy, they must not be nullptr
+         */
+        void init(const VtolParameters& params, SharedTables tables);
+        const TablesWithCoeffsT<Scalar>& getTables() const {return *tables_;}
+        const SharedTables& getSharedTables() const {return tables_;}
+
+        Scalar calculateDynamicPressure(Scalar airSpeedMod) const;
+        static Scalar calculateAnglesOfAtack(const Vector3& airSpeed);
+        static Scalar calculateAnglesOfSideslip(const Vector3& airSpeed);
+        void calculateAerodynamics(const Vector3& airspeed,
+                                   Scalar AoA,
+                                   Scalar AoS,
+                                   Scalar aileron_pos,
+                                   Scalar elevator_pos,
+                                   Scalar rudder_pos,
+                                   Vector3& Faero,
+                                   Vector3& Maero,
+                                   AeroComponents* components = nullptr) const;
+
+        /**
+         * @brief The same aerodynamics for any tables with the fields of TablesWithCoeffs,
+         * they are either Eigen matrices or compile time views (see innoVtolAeroModel.hpp)
+         */
+        template<typename Tables>
+        void calculateAerodynamicsUsingTables(const Tables& tables,
+                                              const Vector3& airspeed,
+                                              Scalar AoA,
+                                              Scalar AoS,
+                                              Scalar aileron_pos,
+                                              Scalar elevator_pos,
+                                              Scalar rudder_pos,
+                                              Vector3& Faero,
+                                              Vector3& Maero,
+                                              AeroComponents* components = nullptr) const;
+
+        /**
+         * @note Outputs are not changed if the actuator is out of the prop table
+         */
+        void thruster(Scalar actuator, Scalar& thrust, Scalar& torque, Scalar& rpm) const;
+
+        /**
+         * @brief Forces and moments of 4 copter motors and the pusher in body frame
+         */
+        void calculateMotors(const Scalar* actuators,
+                             std::array<Vector3, MOTORS_AMOUNT>& forces,
+                             std::array<Vector3, MOTORS_AMOUNT>& moments,
+                             std::array<Scalar, MOTORS_AMOUNT>& rpm) const;
+
+        /**
+         * @brief Sum of the aerodynamics and the thrusters in body frame, there is no wind
+         */
+        void calculateBodyForces(const RigidBodyState& state,
+                                 const Actuators& actuators,
+                                 Vector3& Fbody,
+                                 Vector3& Mbody) const;
+
+        /**
+         * @brief Time derivative of the velocities at the given state, the linear
+         * acceleration is in NED and includes gravity, the angular one is in FRD.
+         * It is the function the linearization differentiates (see vtolLinearization.hpp).
+         */
+        void calculateDerivative(const RigidBodyState& state,
+                                 const Actuators& actuators,
+                                 Vector3& linearAccel,
+                                 Vector3& angularAccel) const;
+
+        /**
+         * @brief Advance the rigid body without wind and actuators dynamics, the ground
+         * stops the vehicle at zero altitude
+         * @param actuators - motors in rad/sec, surfaces in deg, as after the actuators dynamics
+         */
+        void step(RigidBodyState& state, const Actuators& actuators, Scalar dtSecs) const;
+
+        Scalar calculateCSRudder(Scalar rudder_pos, Scalar airspeed) const;
+        Scalar calculateCSBeta(Scalar AoS_deg, Scalar airspeed) const;
+        Scalar calculateCmxAileron(Scalar aileron_pos, Scalar airspeed) const;
+        Scalar calculateCmyElevator(Scalar elevator_pos, Scalar airspeed) const;
+        Scalar calculateCmzRudder(Scalar rudder_pos, Scalar airspeed) const;
+
+        template<typename Tables>
+        static Scalar calculateCSRudder(const Tables& tables, Scalar rudder_pos, Scalar airspeed){
+            return griddata(-tables.actuator, tables.airspeed, tables.CS_rudder, rudder_pos, airspeed);
+        }
+        template<typename Tables>
+        static Scalar calculateCSBeta(const Tables& tables, Scalar AoS_deg, Scalar airspeed){
+            return griddata(-tables.AoS, tables.airspeed, tables.CS_beta, AoS_deg, airspeed);
+        }
+        template<typename Tables>
+        static Scalar calculateCmxAileron(const Tables& tables, Scalar aileron_pos, Scalar airspeed){
+            return griddata(tables.actuator, tables.airspeed, tables.CmxAileron, aileron_pos, airspeed);
+        }
+        template<typename Tables>
+        static Scalar calculateCmyElevator(const Tables& tables, Scalar elevator_pos, Scalar airspeed){
+            return griddata(tables.actuator, tables.airspeed, tables.CmyElevator, elevator_pos, airspeed);
+        }
+        template<typename Tables>
+        static Scalar calculateCmzRudder(const Tables& tables, Scalar rudder_pos, Scalar airspeed){
+            return griddata(tables.actuator, tables.airspeed, tables.CmzRudder, rudder_pos, airspeed);
+        }
+
+        /**
+         * @brief Interpolate the polynomial coefficients between the table rows, the first
+         * column is airspeed. Coefficients missed in the table are set to zero.
+         */
+        template<typename Table, typename Coeffs>
+        static void calculatePolynomialUsingTable(const Table& table, Scalar airSpeedMod, Coeffs& polynomialCoeffs){
+            size_t prevRowIdx = findRow(table, airSpeedMod);
+            size_t nextRowIdx = prevRowIdx + 1;
+            Scalar t = (airSpeedMod - table(prevRowIdx, 0)) / (table(nextRowIdx, 0) - table(prevRowIdx, 0));
+            size_t coeffsAmount = std::min<size_t>(polynomialCoeffs.size(), table.cols() - 1);
+            for(size_t idx = 0; idx < coeffsAmount; idx++){
+                polynomialCoeffs[idx] = lerp(table(prevRowIdx, idx + 1), table(nextRowIdx, idx + 1), t);
+            }
+            for(size_t idx = coeffsAmount; idx < static_cast<size_t>(polynomialCoeffs.size()); idx++){
+                polynomialCoeffs[idx] = 0;
+            }
+        }
+
+        /**
+         * @note first collomn of the table must be sorted and it must have at least 2 rows
+         */
+        template<typename Table>
+        static size_t findRow(const Table& table, Scalar value){
+            size_t row = 0;
+            size_t c = table.rows();
+            while(row + 2 < c && table(row + 1, 0) < value){
+                row++;
+            }
+            return row;
+        }
+
+        /**
+         * @note size should be greater or equel than 2!
+         */
+        template<typename Table>
+        static size_t search(const Table& matrix, Scalar key){
+            size_t row_idx;
+            size_t rows = matrix.rows();
+            if(matrix(rows - 1, 0) > matrix(0, 0)){
+                for(row_idx = 1; row_idx < rows - 1; row_idx++){
+                    if(key <= matrix(row_idx, 0)){
+                        break;
+                    }
+                }
+            }else{
+                for(row_idx = 1; row_idx < rows - 1; row_idx++){
+                    if(key >= matrix(row_idx, 0)){
+                        break;
+                    }
+                }
+            }
+            return row_idx - 1;
+        }
+
+        static Scalar lerp(Scalar a, Scalar b, Scalar f){
+            return a + f * (b - a);
+        }
+
+        /**
+         * @note Similar to https://www.mathworks.com/help/matlab/ref/griddata.html
+         * Implementation from https://en.wikipedia.org/wiki/Bilinear_interpolation
+         */
+        template<typename X, typename Y, typename Z>
+        static Scalar griddata(const X& x, const Y& y, const Z& z, Scalar x_val, Scalar y_val){
+            size_t x1_idx = search(x, x_val);
+            size_t y1_idx = search(y, y_val);
+            size_t x2_idx = x1_idx + 1;
+            size_t y2_idx = y1_idx + 1;
+            Scalar Q11 = z(y1_idx, x1_idx);
+            Scalar Q12 = z(y2_idx, x1_idx);
+            Scalar Q21 = z(y1_idx, x2_idx);
+            Scalar Q22 = z(y2_idx, x2_idx);
+            Scalar R1 = ((x(x2_idx) - x_val) * Q11 + (x_val - x(x1_idx)) * Q21) / (x(x2_idx) - x(x1_idx));
+            Scalar R2 = ((x(x2_idx) - x_val) * Q12 + (x_val - x(x1_idx)) * Q22) / (x(x2_idx) - x(x1_idx));
+            return ((y(y2_idx) - y_val) * R1  + (y_val - y(y1_idx)) * R2)  / (y(y2_idx) - y(y1_idx));
+        }
+
+        /**
+         * @brief Horner's scheme, coefficients are from the highest power
+         */
+        template<typename Poly>
+        static Scalar polyval(const Poly& poly, Scalar val){
+            Scalar result = 0;
+            for(size_t idx = 0; idx < static_cast<size_t>(poly.size()); idx++){
+                result = result * val + poly[idx];
+            }
+            return result;
+        }
+
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    private:
+        static constexpr double PI = 3.1415;
+
+        static Scalar clamp(Scalar value, Scalar min, Scalar max){
+            return std::max(min, std::min(value, max));
+        }
+
+        /**
+         * @brief The default tables of a not initialized kernel, all of them share one instance
+         */
+        static const SharedTables& getDefaultTables(){
+            static const SharedTables tables(new TablesWithCoeffsT<Scalar>());
+            return tables;
+        }
+
+        SharedTables tables_ = getDefaultTables();
+        Scalar mass_ = 1;                               // kg
+        Scalar gravity_ = 0;                            // m/sec^2
+        Scalar atmoRho_ = 0;                            // kg/m^3
+        Scalar wingArea_ = 0;                           // m^2
+        Scalar characteristicLength_ = 0;               // m
+        Matrix3 inertia_ = Matrix3::Identity();         // kg*m^2
+        Matrix3 inertiaInverse_ = Matrix3::Identity();
+        std::array<Vector3, MOTORS_AMOUNT> propellersLocation_;
+};
+
+/**
+ * @note definitions:
+ * FD, CD - drug force and drug coeeficient respectively
+ * FL - lift force and lift coeeficient respectively
+ * FS - side force and side coeeficient respectively
+ */
+template<typename Scalar>
+template<typename Tables>
+void VtolDynamicsKernel<Scalar>::calculateAerodynamicsUsingTables(const Tables& tables,
+                                                                  const Vector3& airspeed,
+                                                                  Scalar AoA,
+                                                                  Scalar AoS,
+                                                                  Scalar aileron_pos,
+                                                                  Scalar elevator_pos,
+                                                                  Scalar rudder_pos,
+                                                                  Vector3& Faero,
+                                                                  Vector3& Maero,
+                                                                  AeroComponents* components) const{
+    using std::abs;
+
+    // 0. Common computation
+    Scalar AoA_deg = clamp(AoA * Scalar(180 / PI), -45, +45);
+    Scalar AoS_deg = clamp(AoS * Scalar(180 / PI), -90, +90);
+    Scalar airspeedMod = airspeed.norm();
+    if(airspeedMod <= 0){
+        // there is no pressure, the early exit also keeps the derivatives of norm() finite
+        Faero.setZero();
+        Maero.setZero();
+        if(components != nullptr){
+            components->Flift.setZero();
+            components->Fdrug.setZero();
+            components->Fside.setZero();
+            components->Msteer.setZero();
+            components->Mairspeed.setZero();
+        }
+        return;
+    }
+    Scalar dynamicPressure = calculateDynamicPressure(airspeedMod);
+    Scalar airspeedModClamped = clamp(airspeedMod, 5, 40);
+    const Vector3 unitY = Vector3::UnitY();
+
+    // 1. Calculate aero force
+    Eigen::Matrix<Scalar, 7, 1> polynomialCoeffs;
+    Eigen::Matrix<Scalar, 5, 1> dragPolynomialCoeffs;
+
+    calculatePolynomialUsingTable(tables.CLPolynomial, airspeedModClamped, polynomialCoeffs);
+    Scalar CL = polyval(polynomialCoeffs, AoA_deg);
+    Vector3 FL = unitY.cross(airspeed.normalized()) * CL;
+
+    calculatePolynomialUsingTable(tables.CSPolynomial, airspeedModClamped, polynomialCoeffs);
+    Scalar CS = polyval(polynomialCoeffs, AoA_deg);
+    Scalar CS_rudder = calculateCSRudder(tables, rudder_pos, airspeedModClamped);
+    Scalar CS_beta = calculateCSBeta(tables, AoS_deg, airspeedModClamped);
+    Vector3 FS = airspeed.cross(unitY.cross(airspeed.normalized())) * (CS + CS_rudder + CS_beta);
+
+    calculatePolynomialUsingTable(tables.CDPolynomial, airspeedModClamped, dragPolynomialCoeffs);
+    Scalar CD = polyval(dragPolynomialCoeffs, AoA_deg);
+    Vector3 FD = (-airspeed).normalized() * CD;
+
+    Faero = Scalar(0.5) * dynamicPressure * (FL + FS + FD);
+
+    // 2. Calculate aero moment
+    calculatePolynomialUsingTable(tables.CmxPolynomial, airspeedModClamped, polynomialCoeffs);
+    Scalar Cmx = polyval(polynomialCoeffs, AoA_deg);
+
+    calculatePolynomialUsingTable(tables.CmyPolynomial, airspeedModClamped, polynomialCoeffs);
+    Scalar Cmy = polyval(polynomialCoeffs, AoA_deg);
+
+    calculatePolynomialUsingTable(tables.CmzPolynomial, airspeedModClamped, polynomialCoeffs);
+    Scalar Cmz = -polyval(polynomialCoeffs, AoA_deg);
+
+    Scalar Cmx_aileron = calculateCmxAileron(tables, aileron_pos, airspeedModClamped);
+    /**
+     * @note InnoDynamics from octave has some mistake in elevator logic
+     * It always generate non positive moment in both positive and negative position
+     * Temporary decision is to create positive moment in positive position and
+     * negative moment in negative position
+     */
+    Scalar Cmy_elevator = calculateCmyElevator(tables, abs(elevator_pos), airspeedModClamped);
+    Scalar Cmz_rudder = calculateCmzRudder(tables, rudder_pos, airspeedModClamped);
+
+    Scalar Mx = Cmx + Cmx_aileron * aileron_pos;
+    Scalar My = Cmy + Cmy_elevator * elevator_pos;
+    Scalar Mz = Cmz + Cmz_rudder * rudder_pos;
+
+    Scalar momentScale = Scalar(0.5) * dynamicPressure * characteristicLength_;
+    Maero = momentScale * Vector3(Mx, My, Mz);
+
+    if(components != nullptr){
+        components->Flift = momentScale * FL;
+        components->Fdrug = momentScale * FD;
+        components->Fside = momentScale * FS;
+        components->Msteer = momentScale * Vector3(Cmx_aileron * aileron_pos,
+                                                   Cmy_elevator * elevator_pos,
+                                                   Cmz_rudder * rudder_pos);
+        components->Mairspeed = momentScale * Vector3(Cmx, Cmy, Cmz);
+    }
+}
+
+extern template class VtolDynamicsKernel<double>;
+extern template class VtolDynamicsKernel<float>;
+
+#endif  // VTOL_DYNAMICS_KERNEL_HPP
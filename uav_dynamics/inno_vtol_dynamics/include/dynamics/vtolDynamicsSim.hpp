@@ -10,9 +10,26 @@
 #include <Eigen/Geometry>
 #include <vector>
 #include <array>
+#include <limits>
 #include <random>
+#include <string>
 #include "uavDynamicsSimBase.hpp"
+#include "drydenTurbulence.hpp"
+#include "windField.hpp"
+#include "actuatorsDynamics.hpp"
+#include "attitudeIntegration.hpp"
+#include "vtolDynamicsKernel.hpp"
 
+class VtolModelReloader;
+
+
+/**
+ * @brief How the aerodynamics forces are propagated between two evaluations
+ */
+enum AeroForcesPolicy_t{
+    AERO_FORCES_HOLD = 0,                           // zero order hold
+    AERO_FORCES_EXTRAPOLATE,                        // linear extrapolation of the last two evaluations
+};
 
 struct VtolParameters{
     double mass;                                    // kg
@@ -26,11 +43,23 @@ struct VtolParameters{
 
     std::vector<double> actuatorMin;                // rad/sec
     std::vector<double> actuatorMax;                // rad/sec
-    std::array<double, 8> deltaControlMax;          // rad/sec^2
-    std::array<double, 8> timeConstant;             // sec
+    ActuatorsArray deltaControlMax = ActuatorsArray::Constant(std::numeric_limits<double>::infinity());  // units/sec
+    ActuatorsDynamics::Model_t actuatorsModel = ActuatorsDynamics::FIRST_ORDER;
+
+    /**
+     * @note Multi-rate stepping: actuators, thrusters and rigid body are advanced
+     * innerSubsteps times per process, aerodynamics is evaluated once per aeroUpdatePeriod
+     */
+    uint32_t innerSubsteps = 1;
+    double aeroUpdatePeriod = 0;                    // sec, 0 means on each substep
+    AeroForcesPolicy_t aeroForcesPolicy = AERO_FORCES_HOLD;
+    AttitudeIntegration::Method_t attitudeIntegrationMethod = AttitudeIntegration::EXPONENTIAL;
 
     double accVariance;
     double gyroVariance;
+    double turbulenceWindSpeedAt6m;                 // m/sec, 0 means no turbulence
+    uint32_t turbulenceSeed = 0;                    // noise seed of the turbulence
+    std::string windFieldPath;                      // empty means the constant mean wind
 
     /**
      * @note not ready yet
@@ -83,36 +112,19 @@ struct State{
      * @note not ready yet
      */
     Eigen::Vector3d windVelocity;                   // m/sec^2
-    Eigen::Vector3d gustVelocity;                   // m/sec^2
-    double gustVariance;
-    std::vector<double> prevActuators;              // rad/sec
-    std::vector<double> crntActuators;              // rad/sec
-};
-
-struct TablesWithCoeffs{
-    Eigen::Matrix<double, 8, 20, Eigen::RowMajor> CS_rudder;
-    Eigen::Matrix<double, 8, 90, Eigen::RowMajor> CS_beta;
+    Eigen::Vector3d gustVelocity;                   // m/sec, inertial frame (NED)
+    double windFieldTime;                           // sec, the clock of the wind field
+    DrydenFilterState turbulenceState;
+    ActuatorsState actuators;                       // rad/sec for motors, deg for surfaces
 
-    Eigen::Matrix<double, 1, 47, Eigen::RowMajor> AoA;
-    Eigen::Matrix<double, 90, 1, Eigen::ColMajor> AoS;
-
-    Eigen::Matrix<double, 20, 1, Eigen::ColMajor> actuator;
-    Eigen::Matrix<double, 8, 1, Eigen::ColMajor> airspeed;
-
-    Eigen::Matrix<double, 8, 8, Eigen::RowMajor> CLPolynomial;
-    Eigen::Matrix<double, 8, 8, Eigen::RowMajor> CSPolynomial;
-    Eigen::Matrix<double, 8, 6, Eigen::RowMajor> CDPolynomial;
-    Eigen::Matrix<double, 8, 8, Eigen::RowMajor> CmxPolynomial;
-    Eigen::Matrix<double, 8, 8, Eigen::RowMajor> CmyPolynomial;
-    Eigen::Matrix<double, 8, 8, Eigen::RowMajor> CmzPolynomial;
-
-    Eigen::Matrix<double, 8, 20, Eigen::RowMajor> CmxAileron;
-    Eigen::Matrix<double, 8, 20, Eigen::RowMajor> CmyElevator;
-    Eigen::Matrix<double, 8, 20, Eigen::RowMajor> CmzRudder;
-
-    Eigen::Matrix<double, 40, 5, Eigen::RowMajor> prop;
-
-    std::vector<double> actuatorTimeConstants;
+    /**
+     * @note The last aerodynamics evaluation and its rate of change
+     */
+    Eigen::Vector3d FaeroHeld;                      // N
+    Eigen::Vector3d MaeroHeld;                      // N*m
+    Eigen::Vector3d FaeroRate;                      // N/sec
+    Eigen::Vector3d MaeroRate;                      // N*m/sec
+    double aeroAge;                                 // sec since the evaluation, inf if there is none
 };
 
 /**
@@ -121,7 +133,25 @@ struct TablesWithCoeffs{
 class InnoVtolDynamicsSim : public UavDynamicsSimBase{
     public:
         InnoVtolDynamicsSim();
-        virtual int8_t init() override;
+        virtual int8_t init(const ParamsSource& source) override;
+
+        /**
+         * @brief Plain C++ initialization without any parameters source
+         */
+        int8_t init(const VtolParameters& params, const TablesWithCoeffs& tables);
+
+        /**
+         * @brief As above, but the tables are attached without a copy, see airframeRegistry.hpp
+         */
+        int8_t init(const VtolParameters& params, VtolDynamicsKernel<double>::SharedTables tables);
+
+        /**
+         * @brief Fill the config structs from a parameters source, path is the namespace
+         * of the parameters, e.g. "/uav/vtol_params/"
+         * @throw std::runtime_error if a table is missed or has wrong size
+         */
+        static void loadTables(const ParamsSource& source, const std::string& path, TablesWithCoeffs& tables);
+        static void loadParams(const ParamsSource& source, const std::string& path, VtolParameters& params);
         virtual void setInitialPosition(const Eigen::Vector3d & position,
                                         const Eigen::Quaterniond& attitude) override;
         virtual void land() override;
@@ -217,22 +247,62 @@ class InnoVtolDynamicsSim : public UavDynamicsSimBase{
 
 
         void setWindParameter(Eigen::Vector3d windMeanVelocity, double wind_velocityVariance);
+        void setTurbulenceParameter(double windSpeedAt6m);
+        void setTurbulenceSeed(uint32_t seed);
+
+        /**
+         * @brief Reseed all the noise sources: turbulence, wind variance and IMU noise
+         */
+        void setNoiseSeed(uint32_t seed);
+
         void setInitialVelocity(const Eigen::Vector3d& linearVelocity,
                                 const Eigen::Vector3d& angularVelocity);
 
+        /**
+         * @brief Snapshot and restore the whole simulator state and tables, they are used
+         * to warm start many runs from the same point and to fit the tables
+         */
+        const State& getState() const;
+        void setState(const State& state);
+        const TablesWithCoeffs& getTables() const;
+        const VtolDynamicsKernel<double>::SharedTables& getSharedTables() const;
+        void setTables(const TablesWithCoeffs& tables);
+        const VtolParameters& getParams() const;
+
+        /**
+         * @brief The newest model published by the reloader is taken at the beginning of
+         * each process, nullptr disables it. The reloader must outlive the simulator.
+         */
+        void setModelReloader(VtolModelReloader* modelReloader);
+        size_t getModelReloadsAmount() const {return modelReloads_;}
+
+        /**
+         * @return how many times the aerodynamics has been evaluated, it is for profiling
+         */
+        size_t getAeroEvaluationsAmount() const {return aeroEvaluations_;}
+
     private:
-        void loadTables(const std::string& path);
-        void loadParams(const std::string& path);
         std::vector<double> mapCmdToActuatorStandardVTOL(const std::vector<double>& cmd) const;
         std::vector<double> mapCmdToActuatorInnoVTOL(const std::vector<double>& cmd) const;
-        void updateActuators(std::vector<double>& cmd, double dtSecs);
+        void updateActuators(const std::vector<double>& cmd, double dtSecs, std::vector<double>& actuators);
+        void updateAerodynamics(const std::vector<double>& actuators);
+        void initActuatorsDynamics();
+        void updateTurbulence(double dtSecs);
+        void updateWindField(double dtSecs);
+        void takeReloadedModel();
         Eigen::Vector3d calculateAirSpeed(const Eigen::Matrix3d& rotationMatrix,
                                     const Eigen::Vector3d& estimatedVelocity,
                                     const Eigen::Vector3d& windSpeed) const;
 
         VtolParameters params_;
         State state_;
-        TablesWithCoeffs tables_;
+        VtolDynamicsKernel<double> kernel_;
+        DrydenTurbulence turbulence_;
+        WindField windField_;
+        ActuatorsDynamics actuatorsDynamics_;
+        size_t aeroEvaluations_ = 0;
+        VtolModelReloader* modelReloader_ = nullptr;
+        size_t modelReloads_ = 0;
 
         std::default_random_engine generator_;
         std::normal_distribution<double> distribution_;
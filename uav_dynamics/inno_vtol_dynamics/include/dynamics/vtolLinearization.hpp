@@ -0,0 +1,134 @@
+/**
+ * @file vtolLinearization.hpp
+ * @brief Linear models of the vtol dynamics by automatic differentiation, a trim solver and
+ * a parallel sweep of trim points over an airspeed and altitude grid
+ */
+
+#ifndef VTOL_LINEARIZATION_HPP
+#define VTOL_LINEARIZATION_HPP
+
+#include <Eigen/Geometry>
+#include <unsupported/Eigen/AutoDiff>
+#include <vector>
+#include <limits>
+#include "vtolDynamicsKernel.hpp"
+
+/**
+ * @brief Forward mode dual number with a derivative per state and control component,
+ * so all the Jacobians come out of a single evaluation of the dynamics
+ */
+typedef Eigen::AutoDiffScalar<Eigen::Matrix<double, 20, 1>> VtolAutoDiff;
+
+/**
+ * @brief x' = f(x0, u0) + A * (x - x0) + B * (u - u0)
+ * State is [position NED (m), velocity NED (m/sec), attitude error (rad), angular velocity
+ * FRD (rad/sec)], the attitude error is in body frame: q = q0 * exp(error).
+ * Control is 8 actuators: motors in rad/sec, surfaces in deg.
+ */
+struct LinearModel{
+    Eigen::Matrix<double, 12, 1> stateDerivative;
+    Eigen::Matrix<double, 12, 12> A;
+    Eigen::Matrix<double, 12, 8> B;
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+enum TrimMode_t{
+    TRIM_HOVER = 0,                                 // copter motors only
+    TRIM_TRANSITION,                                // copter motors, pusher and elevator
+    TRIM_CRUISE,                                    // pusher and all surfaces
+};
+
+/**
+ * @brief Steady level flight along the north. Roll and pitch are always free, the free
+ * actuators depend on the mode, the others keep their initial values.
+ */
+struct TrimPoint{
+    TrimMode_t mode = TRIM_HOVER;
+    double airspeed = 0;                            // m/sec
+    double altitude = 0;                            // m
+    Eigen::Quaterniond attitude = Eigen::Quaterniond::Identity();
+    VtolDynamicsKernel<double>::Actuators actuators = VtolDynamicsKernel<double>::Actuators::Zero();
+    double residual = 0;                            // norm of accelerations, m/sec^2 and rad/sec^2
+    bool isConverged = false;
+    LinearModel model;
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+class VtolLinearization{
+    public:
+        typedef VtolDynamicsKernel<double>::RigidBodyState RigidBodyState;
+        typedef VtolDynamicsKernel<double>::Actuators Actuators;
+
+        static constexpr size_t STATE_SIZE = 12;
+        static constexpr size_t CONTROL_SIZE = 8;
+        static constexpr size_t DEFAULT_MAX_ITERATIONS = 50;
+        static constexpr double TOLERANCE = 1e-6;                   // m/sec^2 and rad/sec^2
+        static constexpr double HOVER_MAX_AIRSPEED = 1.0;           // m/sec
+        static constexpr double CRUISE_MIN_AIRSPEED = 18.0;         // m/sec
+
+        /**
+         * @note The actuators limits are taken from the parameters if they are set
+         */
+        void init(const VtolParameters& params, const TablesWithCoeffs& tables);
+
+        /**
+         * @brief Jacobians of the windless dynamics at the given state and actuators,
+         * they are calculated in one pass of VtolDynamicsKernel::calculateDerivative
+         */
+        void linearize(const RigidBodyState& state, const Actuators& actuators, LinearModel& model) const;
+
+        /**
+         * @brief Damped Gauss-Newton on the linear and angular accelerations with the
+         * Jacobians from linearize. The point attitude and actuators are the initial guess
+         * as input and the trim as output, the model is the linearization at the trim.
+         * @return -1 if it is not converged, else 0
+         */
+        int8_t trim(TrimPoint& point, size_t maxIterations = DEFAULT_MAX_ITERATIONS) const;
+
+        /**
+         * @brief Mode by airspeed and a reasonable initial guess for it
+         */
+        static void initTrimPoint(TrimPoint& point, double airspeed, double altitude);
+
+        /**
+         * @brief ISA troposphere density scaled to the given sea level density
+         */
+        static double calculateAirDensity(double seaLevelRho, double altitude);
+
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    private:
+        void calculateState(const TrimPoint& point, RigidBodyState& state) const;
+        double calculateResidual(const TrimPoint& point) const;
+
+        VtolDynamicsKernel<double> kernel_;
+        VtolDynamicsKernel<VtolAutoDiff> autoDiffKernel_;
+        Actuators actuatorMin_ = Actuators::Constant(-std::numeric_limits<double>::infinity());
+        Actuators actuatorMax_ = Actuators::Constant(std::numeric_limits<double>::infinity());
+};
+
+/**
+ * @brief Trim and linearize the vehicle at each airspeed for each altitude. The air density
+ * follows ISA with params.atmoRho at sea level. Points are processed in parallel by the
+ * workers, each altitude has its own kernels shared by the workers.
+ * @param points - output, the point of airspeeds[i] at altitudes[j] has index
+ * j * airspeeds.size() + i
+ * @param threadsAmount - amount of workers, 0 means hardware concurrency
+ * @return -1 if any of the points is not converged, else 0
+ */
+int8_t sweepTrimPoints(const VtolParameters& params,
+                       const TablesWithCoeffs& tables,
+                       const std::vector<double>& airspeeds,
+                       const std::vector<double>& altitudes,
+                       std::vector<TrimPoint, Eigen::aligned_allocator<TrimPoint>>& points,
+                       size_t threadsAmount = 0);
+
+extern template void VtolDynamicsKernel<VtolAutoDiff>::init(const VtolParameters&, const TablesWithCoeffs&);
+extern template void VtolDynamicsKernel<VtolAutoDiff>::calculateDerivative(const RigidBodyState&,
+                                                                          const Actuators&,
+                                                                          Vector3&,
+                                                                          Vector3&) const;
+
+#endif  // VTOL_LINEARIZATION_HPP
@@ -0,0 +1,100 @@
+/**
+ * @file vtolModelReloader.hpp
+ * @brief Live reload of vtol_params.yaml and aerodynamics_coeffs.yaml without a restart
+ */
+
+#ifndef VTOL_MODEL_RELOADER_HPP
+#define VTOL_MODEL_RELOADER_HPP
+
+#include <string>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include "vtolDynamicsSim.hpp"
+
+/**
+ * @brief Immutable snapshot of the vehicle model, the kernel is already initialized
+ */
+struct VtolModel{
+    VtolParameters params;
+    VtolDynamicsKernel<double> kernel;
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+/**
+ * @brief The writer side builds a new model from the yaml files on a background thread or
+ * on request, validates it and publishes it into a single slot. The reader side is the
+ * dynamics thread: at a step boundary it takes the published model with try_lock, so it
+ * never waits for the writer and never sees a half-built model. The taken model is swapped
+ * with the reader's params and kernel and the previous ones are left in the slot to be
+ * released by the writer, so the reader neither allocates nor frees memory.
+ * @note Turbulence and wind field are not reloaded, they keep the startup settings.
+ */
+class VtolModelReloader{
+    public:
+        VtolModelReloader() = default;
+        ~VtolModelReloader();
+        VtolModelReloader(const VtolModelReloader&) = delete;
+        VtolModelReloader& operator=(const VtolModelReloader&) = delete;
+
+        /**
+         * @brief Watch vtol_params.yaml and aerodynamics_coeffs.yaml in the directory, any
+         * change of their content triggers a reload
+         * @param periodSec - period of the files checks, 0 means reload by request only
+         * @return -1 if it is already started, else 0
+         */
+        int8_t start(const std::string& configDirectory, double periodSec = DEFAULT_PERIOD);
+        void stop();
+
+        /**
+         * @brief Wake the watcher up to reload the model now, it doesn't wait for the reload
+         */
+        void requestReload();
+
+        /**
+         * @brief Load, validate and publish the model in the calling thread
+         * @return -1 if the files can't be loaded or the model is invalid, else 0
+         */
+        int8_t reload(const std::string& configDirectory);
+
+        /**
+         * @brief Reader side, it should be called only by a single dynamics thread
+         * @return true if a new model has been taken into params and kernel
+         */
+        bool tryTake(VtolParameters& params, VtolDynamicsKernel<double>& kernel);
+
+        /**
+         * @brief Check the values a half-edited yaml usually breaks: physical parameters,
+         * finite tables and sorted lookup columns
+         * @return -1 if the model is invalid, else 0
+         */
+        static int8_t validate(const VtolParameters& params, const TablesWithCoeffs& tables);
+
+        size_t getPublishedAmount() const {return publishedAmount_;}
+        size_t getRejectedAmount() const {return rejectedAmount_;}
+
+        static constexpr double DEFAULT_PERIOD = 0.5;               // sec
+
+    private:
+        void watcherLoop(double periodSec);
+
+        std::string configDirectory_;
+        uint64_t paramsChecksum_ = 0;                   // they are used only by the watcher
+        uint64_t tablesChecksum_ = 0;
+        std::thread watcher_;
+        std::mutex watcherMutex_;
+        std::condition_variable watcherCondition_;
+        bool isStopped_ = false;
+        bool isReloadRequested_ = false;
+
+        std::mutex slotMutex_;
+        std::unique_ptr<VtolModel> pending_;
+        std::unique_ptr<VtolModel> retired_;
+        std::atomic<size_t> publishedAmount_{0};
+        std::atomic<size_t> rejectedAmount_{0};
+};
+
+#endif  // VTOL_MODEL_RELOADER_HPP
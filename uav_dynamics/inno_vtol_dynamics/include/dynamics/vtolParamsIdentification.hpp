@@ -0,0 +1,175 @@
+/**
+ * @file vtolParamsIdentification.hpp
+ * @brief Identification of the aerodynamic tables entries from recorded flight logs
+ */
+
+#ifndef VTOL_PARAMS_IDENTIFICATION_HPP
+#define VTOL_PARAMS_IDENTIFICATION_HPP
+
+#include <Eigen/Geometry>
+#include <Eigen/StdVector>
+#include <vector>
+#include <string>
+#include <ostream>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <condition_variable>
+#include "vtolDynamicsSim.hpp"
+
+/**
+ * @brief A single flight log record, the actuators are in the same format as
+ * InnoVtolDynamicsSim::process expects with isCmdPercent
+ */
+struct FlightLogSample{
+    double timeSec;                                 // sec
+    Eigen::Vector3d position;                       // m, NED
+    Eigen::Vector3d linearVel;                      // m/sec, NED
+    Eigen::Quaterniond attitude;                    // FRD to NED
+    Eigen::Vector3d angularVel;                     // rad/sec, FRD
+    std::vector<double> actuators;                  // InnoVTOL mixer output
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+typedef std::vector<FlightLogSample, Eigen::aligned_allocator<FlightLogSample>> FlightLog;
+
+/**
+ * @brief Entry of one of TablesWithCoeffs, the table is named as in aerodynamics_coeffs.yaml
+ */
+struct TableEntry{
+    std::string table;
+    size_t row;
+    size_t col;
+};
+
+/**
+ * @brief Load csv log with columns: time, position xyz, linear velocity xyz,
+ * attitude wxyz, angular velocity xyz, 8 actuators. Lines started not from a number
+ * are skipped.
+ * @return -1 if error occured, else 0
+ */
+int8_t loadFlightLog(const std::string& path, FlightLog& log);
+
+/**
+ * @brief Parse an entry in "table/row/col" format
+ * @return -1 if error occured, else 0
+ */
+int8_t parseTableEntry(const std::string& str, TableEntry& entry);
+
+/**
+ * @return pointer to the entry or nullptr if there is no such table or entry
+ */
+double* getTableEntry(TablesWithCoeffs& tables, const TableEntry& entry);
+
+/**
+ * @brief Write the whole table in aerodynamics_coeffs.yaml format
+ * @return -1 if there is no such table, else 0
+ */
+int8_t printTable(std::ostream& os, TablesWithCoeffs& tables, const std::string& name);
+
+/**
+ * @brief Gradient-free Nelder-Mead simplex minimization
+ * @param x - initial guess as input and the best point as output
+ * @param initialStep - initial simplex size for each coordinate
+ * @return the cost at the best point
+ */
+double minimizeNelderMead(const std::function<double(const std::vector<double>&)>& cost,
+                          std::vector<double>& x,
+                          const std::vector<double>& initialStep,
+                          size_t maxIterations,
+                          double tolerance);
+
+/**
+ * @brief The log is split into short segments. Each segment is simulated in open loop
+ * from the logged state with the logged actuators and the residual is the squared error
+ * of the simulated linear and angular velocities. Segments are simulated in parallel by
+ * the workers, each of them owns a simulator instance initialized only once and a private
+ * copy of the tables attached to it, only the identified entries are updated in place
+ * before a rollout. The initial states of the segments, including the actuators dynamics
+ * and the wind field clock, are warmed up once on init and reused by all the evaluations,
+ * so the residual is a pure function of the entries values.
+ */
+class VtolParamsIdentification{
+    public:
+        VtolParamsIdentification() = default;
+        ~VtolParamsIdentification();
+        VtolParamsIdentification(const VtolParamsIdentification&) = delete;
+        VtolParamsIdentification& operator=(const VtolParamsIdentification&) = delete;
+
+        /**
+         * @brief Simulators are initialized from the parameters source as usual
+         * @param segmentDurationSec - duration of the open loop simulation
+         * @param threadsAmount - amount of workers, 0 means hardware concurrency
+         * @return -1 if error occured, else 0
+         */
+        int8_t init(const ParamsSource& source,
+                    const FlightLog& log,
+                    const std::vector<TableEntry>& entries,
+                    double segmentDurationSec = DEFAULT_SEGMENT_DURATION,
+                    size_t threadsAmount = 0);
+
+        /**
+         * @brief Mean residual over all samples of all segments for given entries values
+         */
+        double evaluate(const std::vector<double>& values);
+
+        /**
+         * @param values - initial values as input and the identified values as output
+         * @return the residual with the identified values
+         */
+        double identify(std::vector<double>& values, size_t maxIterations = DEFAULT_MAX_ITERATIONS);
+
+        std::vector<double> getInitialValues() const;
+        const TablesWithCoeffs& getTables() const {return tables_;}
+        size_t getSegmentsAmount() const {return segments_.size();}
+
+        static constexpr double DEFAULT_SEGMENT_DURATION = 1.0;     // sec
+        static constexpr double WARMUP_DURATION = 0.1;              // sec
+        static constexpr double MAX_STEP = 0.002;                   // sec
+        static constexpr double ANGULAR_VELOCITY_WEIGHT = 1.0;      // (m/sec)^2 per (rad/sec)^2
+        static constexpr size_t DEFAULT_MAX_ITERATIONS = 200;
+
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    private:
+        struct Segment{
+            size_t firstSample;
+            size_t lastSample;
+            State warmState;
+
+            EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+        };
+        struct Worker{
+            std::unique_ptr<InnoVtolDynamicsSim> sim;
+            std::shared_ptr<TablesWithCoeffs> tables;
+            std::vector<double*> entries;               // identified entries of the tables
+            std::thread thread;
+            double residual;
+            size_t samplesAmount;
+        };
+
+        void pinState(State& state, const FlightLogSample& sample) const;
+        void warmUp(InnoVtolDynamicsSim& sim, Segment& segment) const;
+        void simulateSegment(InnoVtolDynamicsSim& sim, const Segment& segment,
+                             double& residual, size_t& samplesAmount) const;
+        void workerLoop(Worker& worker);
+
+        FlightLog log_;
+        std::vector<TableEntry> entries_;
+        TablesWithCoeffs tables_;
+        std::vector<double> initialValues_;
+        std::vector<Segment, Eigen::aligned_allocator<Segment>> segments_;
+        std::vector<std::unique_ptr<Worker>> workers_;
+
+        std::mutex mutex_;
+        std::condition_variable startCondition_;
+        std::condition_variable finishCondition_;
+        uint64_t generation_ = 0;
+        size_t finishedWorkers_ = 0;
+        std::atomic<size_t> nextSegment_{0};
+        bool isStopped_ = false;
+};
+
+#endif  // VTOL_PARAMS_IDENTIFICATION_HPP
@@ -0,0 +1,201 @@
+/**
+ * @file vtolVectorEnv.hpp
+ * @brief Vectorized environment for reinforcement learning: many vtol simulators stepped
+ * by a thread pool with a shared-memory exchange of actions and observations
+ */
+
+#ifndef VTOL_VECTOR_ENV_HPP
+#define VTOL_VECTOR_ENV_HPP
+
+#include <Eigen/Geometry>
+#include <vector>
+#include <string>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include "vtolDynamicsSim.hpp"
+
+/**
+ * @brief Ring of request/response slots in a POSIX shared memory object. The layout is
+ * a Header followed by slotsAmount slots of slotSize bytes aligned to ALIGNMENT. Each slot is
+ * - actions: envsAmount x actionsSize float64, written by the trainer
+ * - observations: envsAmount x observationsSize float64, written by the server
+ * - resetFlags: envsAmount uint8, nonzero resets the environment before the step
+ * Request k uses slot k % slotsAmount, the trainer publishes it by incrementing
+ * requestsAmount and the server answers by incrementing responsesAmount, so both sides
+ * work directly on the shared buffers (e.g. numpy views of /dev/shm/<name>).
+ */
+class VectorEnvRing{
+public:
+    VectorEnvRing() = default;
+    ~VectorEnvRing();
+    VectorEnvRing(const VectorEnvRing&) = delete;
+    VectorEnvRing& operator=(const VectorEnvRing&) = delete;
+
+    /**
+     * @brief Create the shared memory object, it is unlinked by the creator on close
+     * @return -1 if error occured, else 0
+     */
+    int8_t create(const std::string& name,
+                  uint32_t slotsAmount,
+                  uint32_t envsAmount,
+                  uint32_t actionsSize,
+                  uint32_t observationsSize);
+    int8_t open(const std::string& name);
+    void close();
+
+    double* getActions(uint64_t request);
+    double* getObservations(uint64_t request);
+    uint8_t* getResetFlags(uint64_t request);
+
+    /**
+     * @brief Trainer side, the slot of the next request is free when its previous
+     * response has been published
+     * @return false on timeout
+     */
+    bool waitFreeSlot(uint64_t request, uint32_t timeoutMs);
+    void publishRequest();
+    bool waitResponse(uint64_t request, uint32_t timeoutMs);
+
+    /**
+     * @brief Server side
+     * @param request - index of the oldest unanswered request
+     * @return false on timeout
+     */
+    bool waitRequest(uint64_t& request, uint32_t timeoutMs);
+    void publishResponse();
+
+    uint64_t getRequestsAmount() const;
+    uint32_t getEnvsAmount() const {return header_ == nullptr ? 0 : header_->envsAmount;}
+    uint32_t getActionsSize() const {return header_ == nullptr ? 0 : header_->actionsSize;}
+    uint32_t getObservationsSize() const {return header_ == nullptr ? 0 : header_->observationsSize;}
+
+    static constexpr uint64_t MAGIC = 0x474E495256455456ULL;    // "VTEVRING"
+    static constexpr uint32_t VERSION = 1;
+    static constexpr size_t ALIGNMENT = 64;
+
+    struct Header{
+        uint64_t magic;
+        uint32_t version;
+        uint32_t slotsAmount;
+        uint32_t envsAmount;
+        uint32_t actionsSize;
+        uint32_t observationsSize;
+        uint32_t reserved;
+        uint64_t slotSize;                          // bytes
+        uint64_t actionsOffset;                     // bytes from the slot start
+        uint64_t observationsOffset;                // bytes from the slot start
+        uint64_t resetFlagsOffset;                  // bytes from the slot start
+        alignas(64) std::atomic<uint64_t> requestsAmount;
+        alignas(64) std::atomic<uint64_t> responsesAmount;
+    };
+
+private:
+    uint8_t* getSlot(uint64_t request);
+    int8_t map(const std::string& name, size_t size, bool isCreated);
+
+    Header* header_ = nullptr;
+    size_t size_ = 0;
+    std::string name_;
+    bool isOwner_ = false;
+};
+
+/**
+ * @brief The environments are split between the workers in contiguous chunks once, each
+ * worker steps its chunk in place, so a step does not allocate and does not copy the
+ * actions and the observations. An observation is the UavDynamicsSimBase state vector.
+ * Each episode of each env has its own noise seed derived from the base seed, the env
+ * index and the episode counter, so the envs and the episodes get independent gusts.
+ */
+class VtolVectorEnv{
+    public:
+        VtolVectorEnv() = default;
+        ~VtolVectorEnv();
+        VtolVectorEnv(const VtolVectorEnv&) = delete;
+        VtolVectorEnv& operator=(const VtolVectorEnv&) = delete;
+
+        /**
+         * @brief Parameters and tables are loaded once, the tables are shared by all
+         * environments. The base seed is turbulenceSeed of the parameters.
+         * @param dtSecs - duration of a single env step
+         * @param substepsAmount - amount of physics steps per env step
+         * @param threadsAmount - amount of workers, 0 means hardware concurrency
+         * @return -1 if error occured, else 0
+         */
+        int8_t init(const ParamsSource& source,
+                    size_t envsAmount,
+                    double dtSecs = DEFAULT_DT,
+                    size_t substepsAmount = 1,
+                    size_t threadsAmount = 0);
+
+        /**
+         * @brief By default the snapshot is a vehicle landed at the origin
+         */
+        void setSnapshot(const State& snapshot);
+        const State& getSnapshot() const {return snapshot_;}
+
+        /**
+         * @brief Restore the snapshot, including its wind field clock, and start a new
+         * episode with a new noise seed
+         */
+        void reset(size_t envIdx);
+        void resetAll();
+
+        /**
+         * @param actions - row-major envsAmount x ACTIONS_SIZE
+         * @param observations - row-major envsAmount x OBSERVATIONS_SIZE
+         * @param resetFlags - optional, nonzero resets the env from the snapshot before the step
+         */
+        void step(const double* actions, double* observations, const uint8_t* resetFlags = nullptr);
+        void getObservations(double* observations) const;
+
+        /**
+         * @brief Answer the requests of the ring until isRunning is cleared
+         * @return -1 if the ring doesn't match the environments, else 0
+         */
+        int8_t serve(VectorEnvRing& ring, const std::atomic<bool>& isRunning);
+
+        InnoVtolDynamicsSim& getEnv(size_t envIdx) {return *envs_[envIdx];}
+        size_t getEnvsAmount() const {return envs_.size();}
+
+        static constexpr size_t ACTIONS_SIZE = 8;
+        static constexpr size_t OBSERVATIONS_SIZE = UavDynamicsSimBase::STATE_SIZE;
+        static constexpr double DEFAULT_DT = 0.01;                   // sec
+        static constexpr uint32_t SERVE_POLL_PERIOD_MS = 100;
+
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    private:
+        struct Worker{
+            size_t firstEnv;
+            size_t lastEnv;
+            std::vector<double> command;
+            std::thread thread;
+        };
+
+        void stepChunk(Worker& worker);
+        void workerLoop(Worker& worker);
+
+        std::vector<std::unique_ptr<InnoVtolDynamicsSim>> envs_;
+        std::vector<std::unique_ptr<Worker>> workers_;
+        State snapshot_;
+        uint32_t seed_ = 0;
+        std::vector<uint32_t> episodes_;
+        double substepDt_ = DEFAULT_DT;
+        size_t substepsAmount_ = 1;
+
+        const double* actions_ = nullptr;
+        double* observations_ = nullptr;
+        const uint8_t* resetFlags_ = nullptr;
+
+        std::mutex mutex_;
+        std::condition_variable startCondition_;
+        std::condition_variable finishCondition_;
+        uint64_t generation_ = 0;
+        size_t finishedWorkers_ = 0;
+        bool isStopped_ = false;
+};
+
+#endif  // VTOL_VECTOR_ENV_HPP
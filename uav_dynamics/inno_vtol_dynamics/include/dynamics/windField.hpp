@@ -0,0 +1,83 @@
+/**
+ * @file windField.hpp
+ * @brief Precomputed 3D + time wind field memory mapped from a binary file
+ */
+
+#ifndef WIND_FIELD_HPP
+#define WIND_FIELD_HPP
+
+#include <Eigen/Geometry>
+#include <functional>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Grid description. Nodes are located at origin + index * spacing, inertial frame (NED)
+ */
+struct WindFieldGrid{
+    uint32_t size[3];                               // nodes amount along x, y, z
+    uint32_t timeFrames;                            // 1 means the steady field
+    double origin[3];                               // m
+    double spacing[3];                              // m
+    double timeStep;                                // sec
+};
+
+/**
+ * @brief File layout is a header followed by time frames. Each frame is split into bricks of
+ * 4x4x4 nodes, bricks follow each other in x-y-z order and nodes inside a brick are stored
+ * in Morton (Z-order). The 8 nodes of an interpolation cell lie in a single 768 bytes brick
+ * only for the 27 of 64 cells which don't touch the last node layer of a brick, the others
+ * span 2, 4 or 8 neighbouring bricks. Either way they are read from a few compact blocks
+ * instead of 4 distant rows. The file is mapped read only and shared, so any amount of
+ * simulator processes uses the same physical pages.
+ */
+class WindField{
+public:
+    WindField() = default;
+    ~WindField();
+    WindField(const WindField&) = delete;
+    WindField& operator=(const WindField&) = delete;
+
+    int8_t open(const std::string& path);
+    void close();
+    bool isLoaded() const;
+    const WindFieldGrid& getGrid() const;
+
+    /**
+     * @brief Trilinear interpolation in space and linear in time.
+     * Position and time are clamped to the grid bounds.
+     * @return wind velocity in NED, m/sec
+     */
+    Eigen::Vector3d sample(const Eigen::Vector3d& position, double timeSec) const;
+
+    /**
+     * @brief Procedurally fill a grid using windAt(position, time) and save it in the
+     * format expected by open
+     */
+    static int8_t generate(const std::string& path,
+                           const WindFieldGrid& grid,
+                           const std::function<Eigen::Vector3d(const Eigen::Vector3d&, double)>& windAt);
+
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint32_t BRICK_SIZE = 4;
+
+private:
+    struct Header{
+        char magic[4];
+        uint32_t version;
+        WindFieldGrid grid;
+    };
+
+    static size_t calculateFrameSize(const WindFieldGrid& grid);
+    static size_t calculateNodeOffset(const WindFieldGrid& grid, uint32_t x, uint32_t y, uint32_t z);
+    Eigen::Vector3d sampleFrame(const float* frame, const uint32_t idx[3], const double t[3]) const;
+
+    WindFieldGrid grid_;
+    void* mapped_ = nullptr;
+    size_t mappedSize_ = 0;
+    const float* data_ = nullptr;
+    size_t frameSize_ = 0;                          // floats
+};
+
+#endif  // WIND_FIELD_HPP
@@ -0,0 +1,58 @@
+/**
+ * @file imu_decimator.hpp
+ * @brief IMU oversampling with anti-aliasing decimation filter and delta integration
+ */
+
+#ifndef INNO_VTOL_DYNAMICS_IMU_DECIMATOR_HPP
+#define INNO_VTOL_DYNAMICS_IMU_DECIMATOR_HPP
+
+#include <Eigen/Geometry>
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief The IMU is sampled at every physics tick, and its output is the anti-aliasing
+ * filter evaluated at the output instant only, like a MEMS part with an on-board
+ * decimation chain. The filter is the CIC impulse response, i.e. cicOrder cascaded boxcars
+ * of the decimation ratio length, stored as float FIR taps. The history is kept per channel
+ * in a doubled circular buffer, so each output is 6 contiguous dot products which the
+ * compiler vectorizes.
+ * Delta velocity and delta angle are integrated at the full rate between the reads.
+ * @note Coning and sculling corrections are not applied
+ */
+class ImuDecimator{
+    public:
+        /**
+         * @param inputRate - physics rate, Hz
+         * @param outputRate - IMU output rate, Hz
+         * @param cicOrder - amount of the cascaded boxcars, 0 disables the filter
+         */
+        int8_t init(double inputRate, double outputRate, size_t cicOrder = DEFAULT_CIC_ORDER);
+        void push(const Eigen::Vector3d& accFrd, const Eigen::Vector3d& gyroFrd, double dtSecs);
+        void getFiltered(Eigen::Vector3d& accFrd, Eigen::Vector3d& gyroFrd) const;
+
+        /**
+         * @brief Return the integrals since the previous call and reset them
+         */
+        void popDeltas(Eigen::Vector3d& deltaVelocity, Eigen::Vector3d& deltaAngle, double& dtSecs);
+
+        size_t getTapsAmount() const {return taps_.size();}
+
+        static constexpr size_t DEFAULT_CIC_ORDER = 3;
+
+    private:
+        static constexpr size_t CHANNELS = 6;
+
+        std::vector<float> taps_;                               // reversed, the oldest first
+        std::array<std::vector<float>, CHANNELS> history_;      // acc xyz, gyro xyz
+        size_t head_ = 0;
+        bool isEmpty_ = true;
+
+        Eigen::Vector3d deltaVelocity_ = Eigen::Vector3d::Zero();   // m/sec
+        Eigen::Vector3d deltaAngle_ = Eigen::Vector3d::Zero();      // rad
+        double deltaTime_ = 0;                                      // sec
+};
+
+#endif  // INNO_VTOL_DYNAMICS_IMU_DECIMATOR_HPP
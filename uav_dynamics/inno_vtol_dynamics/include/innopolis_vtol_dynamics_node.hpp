@@ -12,12 +12,13 @@
 #define UAV_DYNAMICS_HPP
 
 #include <thread>
+#include <array>
 #include <random>
 #include <geographiclib_conversions/geodetic_conv.hpp>
 
 #include <ros/ros.h>
 #include <ros/time.h>
-#include <tf2_ros/transform_broadcaster.h>
+#include <tf2_msgs/TFMessage.h>
 
 #include <sensor_msgs/Imu.h>
 #include <sensor_msgs/Joy.h>
@@ -25,9 +26,17 @@
 #include <std_msgs/Bool.h>
 #include <std_msgs/UInt8.h>
 #include <std_msgs/Empty.h>
+#include <visualization_msgs/MarkerArray.h>
 
 #include "uavDynamicsSimBase.hpp"
 #include "sensors.hpp"
+#include "mag_field_cache.hpp"
+#include "local_geodetic_converter.hpp"
+#include "sensor_scheduler.hpp"
+#include "imu_decimator.hpp"
+#include "shared_state_export.hpp"
+#include "vtolModelReloader.hpp"
+#include "subscribed_publisher.hpp"
 
 
 
@@ -81,10 +90,27 @@ class Uav_Dynamics {
         std::string vehicleName_;
         std::string dynamicsTypeName_;
 
-        geodetic_converter::GeodeticConverter geodeticConverter_;
+        LocalGeodeticConverter geodeticConverter_;
+        //@}
+
+        /// @name Export of the state into shared memory, it is disabled if the name is empty
+        //@{
+        std::string stateExportShmName_;
+        SharedStateWriter stateExport_;
+        SharedVehicleState exportedState_{};
+        std::vector<double> exportedMotorsRpm_;
+        void exportState();
         //@}
 
 
+        /// @name Live reload of the vtol model, a negative period disables it
+        //@{
+        double modelReloadPeriod_ = VtolModelReloader::DEFAULT_PERIOD;     // sec, 0 means by request only
+        VtolModelReloader modelReloader_;
+        ros::Subscriber modelReloadSub_;
+        void modelReloadCallback(std_msgs::Empty msg);
+        //@}
+
         /// @name Communication with PX4
         //@{
         ros::Subscriber actuatorsSub_;
@@ -98,44 +124,37 @@ class Uav_Dynamics {
         bool armed_ = false;
         void armCallback(std_msgs::Bool msg);
 
-        ros::Publisher attitudePub_;
-        double attitudeLastPubTimeSec_ = 0;
-        const double ATTITUDE_PERIOD = 0.005;
-        void publishUavAttitude(Eigen::Quaterniond attitude_frd_to_ned);
+        SubscribedPublisher attitudePub_;
+        void publishUavAttitude(Eigen::Quaterniond attitude_frd_to_ned, const ros::Time& stamp);
+
+        SubscribedPublisher imuPub_;
+        void publishIMUMeasurement(Eigen::Vector3d accFrd, Eigen::Vector3d gyroFrd, const ros::Time& stamp);
 
-        ros::Publisher imuPub_;
-        double imuLastPubTimeSec_ = 0;
-        const double IMU_PERIOD = 0.005;
-        void publishIMUMeasurement(Eigen::Vector3d accFrd, Eigen::Vector3d gyroFrd);
+        bool isImuOversamplingEnabled_ = false;
+        int imuCicOrder_ = ImuDecimator::DEFAULT_CIC_ORDER;
+        ImuDecimator imuDecimator_;
+        SubscribedPublisher imuDeltaPub_;
+        void publishIMUDelta(const ros::Time& stamp);
 
-        ros::Publisher gpsPositionPub_;
-        double gpsLastPubTimeSec_ = 0;
-        const double GPS_POSITION_PERIOD = 0.1;
-        void publishUavGpsPosition(Eigen::Vector3d geoPosition, Eigen::Vector3d nedVelocity);
+        SubscribedPublisher gpsPositionPub_;
+        void publishUavGpsPosition(Eigen::Vector3d geoPosition,
+                                   Eigen::Vector3d nedVelocity,
+                                   const ros::Time& stamp);
 
-        ros::Publisher speedPub_;
-        double velocityLastPubTimeSec_ = 0;
-        const double VELOCITY_PERIOD = 0.05;
+        SubscribedPublisher speedPub_;
         void publishUavVelocity(Eigen::Vector3d linVelNed, Eigen::Vector3d angVelFrd);
 
-        ros::Publisher magPub_;
-        double magLastPubTimeSec_ = 0;
-        const double MAG_PERIOD = 0.03;
+        SubscribedPublisher magPub_;
+        MagFieldCache magFieldCache_;
         void publishUavMag(Eigen::Vector3d geoPosition, Eigen::Quaterniond attitudeFluToEnu);
 
-        ros::Publisher rawAirDataPub_;
-        double rawAirDataLastPubTimeSec_ = 0;
-        const double RAW_AIR_DATA_PERIOD = 0.05;
+        SubscribedPublisher rawAirDataPub_;
         void publishUavAirData(float absPressure, float diffPressure, float staticTemperature);
 
-        ros::Publisher staticTemperaturePub_;
-        double staticTemperatureLastPubTimeSec_ = 0;
-        const double STATIC_TEMPERATURE_PERIOD = 0.05;
+        SubscribedPublisher staticTemperaturePub_;
         void publishUavStaticTemperature(float staticTemperature);
 
-        ros::Publisher staticPressurePub_;
-        double staticPressureLastPubTimeSec_ = 0;
-        const double STATIC_PRESSURE_PERIOD = 0.05;
+        SubscribedPublisher staticPressurePub_;
         void publishUavStaticPressure(float staticPressure);
 
         EscStatusSensor escStatusSensor_;
@@ -148,6 +167,90 @@ class Uav_Dynamics {
         bool isFuelTankStatusEnabled_;
         bool isBatteryStatusEnabled_;
 
+        double fuelLevelPercentage_ = 100.0;
+        double fuelLastUpdateTimeSec_ = -1;         // -1 means there was no fuel sample yet
+
+        /**
+         * @brief Each sensor declares its period and the inputs it requires. The scheduler
+         * emits samples at the exact sensor timestamps and only the inputs required by the
+         * emitted samples are calculated.
+         */
+        enum SensorInput_t : uint16_t{
+            INPUT_POSITION          = 1 << 0,
+            INPUT_GEODETIC          = 1 << 1,   // requires INPUT_POSITION
+            INPUT_VELOCITY          = 1 << 2,
+            INPUT_ATMOSPHERE        = 1 << 3,   // requires INPUT_GEODETIC and INPUT_VELOCITY
+            INPUT_IMU               = 1 << 4,
+            INPUT_ANGULAR_VELOCITY  = 1 << 5,
+            INPUT_ATTITUDE          = 1 << 6,
+            INPUT_MOTORS_RPM        = 1 << 7,
+        };
+        struct SensorsInputs{
+            Eigen::Vector3d enuPosition;
+            Eigen::Vector3d gpsPosition;
+            Eigen::Vector3d linVelNed;
+            Eigen::Vector3d accFrd;
+            Eigen::Vector3d gyroFrd;
+            Eigen::Vector3d angVelFrd;
+            Eigen::Quaterniond attitudeFrdToNed;
+            float temperatureKelvin;
+            float absPressureHpa;
+            float diffPressureHpa;
+            std::vector<double> motorsRpm;
+        };
+        enum PeriodicSensorType_t{
+            SENSOR_GPS_POSITION = 0,
+            SENSOR_ATTITUDE,
+            SENSOR_VELOCITY,
+            SENSOR_IMU,
+            SENSOR_MAG,
+            SENSOR_RAW_AIR_DATA,
+            SENSOR_STATIC_PRESSURE,
+            SENSOR_STATIC_TEMPERATURE,
+            SENSOR_ESC_STATUS,
+            SENSOR_ICE_STATUS,
+            SENSOR_FUEL_TANK_STATUS,
+            SENSOR_BATTERY_STATUS,
+            PERIODIC_SENSORS_AMOUNT,
+        };
+        struct PeriodicSensor{
+            double period;                  // sec, auxilliary sensors periods are set on init
+            uint16_t inputs;                // SensorInput_t mask
+        };
+        std::array<PeriodicSensor, PERIODIC_SENSORS_AMOUNT> periodicSensors_{{
+            {0.1,   INPUT_GEODETIC | INPUT_VELOCITY},           // SENSOR_GPS_POSITION
+            {0.005, INPUT_ATTITUDE},                            // SENSOR_ATTITUDE
+            {0.05,  INPUT_VELOCITY | INPUT_ANGULAR_VELOCITY},   // SENSOR_VELOCITY
+            {0.005, INPUT_IMU},                                 // SENSOR_IMU
+            {0.03,  INPUT_GEODETIC | INPUT_ATTITUDE},           // SENSOR_MAG
+            {0.05,  INPUT_ATMOSPHERE},                          // SENSOR_RAW_AIR_DATA
+            {0.05,  INPUT_ATMOSPHERE},                          // SENSOR_STATIC_PRESSURE
+            {0.05,  INPUT_ATMOSPHERE},                          // SENSOR_STATIC_TEMPERATURE
+            {0,     INPUT_MOTORS_RPM},                          // SENSOR_ESC_STATUS
+            {0,     INPUT_MOTORS_RPM},                          // SENSOR_ICE_STATUS
+            {0,     INPUT_MOTORS_RPM},                          // SENSOR_FUEL_TANK_STATUS
+            {0,     0},                                         // SENSOR_BATTERY_STATUS
+        }};
+        SensorScheduler sensorScheduler_;
+
+        /**
+         * @brief Vehicle state at the last two physics ticks in simulator notation,
+         * it is used to interpolate the state at the sample timestamp
+         */
+        struct VehicleState{
+            uint64_t timeNsec = 0;
+            Eigen::Vector3d position;
+            Eigen::Vector3d linVel;
+            Eigen::Vector3d angVel;
+            Eigen::Quaterniond attitude;
+        };
+        VehicleState prevVehicleState_;
+        VehicleState crntVehicleState_;
+
+        void updateVehicleState(uint64_t crntTimeNsec);
+        void calculateSensorsInputs(uint16_t requiredInputs, uint64_t sampleTimeNsec, SensorsInputs& inputs);
+        bool isSensorSubscribed(size_t sensorType) const;
+        void publishSensor(size_t sensorType, uint64_t sampleTimeNsec, const SensorsInputs& inputs);
         void publishStateToCommunicator();
         //@}
 
@@ -167,29 +270,38 @@ class Uav_Dynamics {
 
         /// @name Visualization (Markers and tf)
         //@{
-        tf2_ros::TransformBroadcaster tfPub_;
-
-        visualization_msgs::Marker arrowMarkers_;
-
-        ros::Publisher totalForcePub_;
-        ros::Publisher aeroForcePub_;
-        ros::Publisher motorsForcesPub_[5];
-        ros::Publisher liftForcePub_;
-        ros::Publisher drugForcePub_;
-        ros::Publisher sideForcePub_;
-
-        ros::Publisher totalMomentPub_;
-        ros::Publisher aeroMomentPub_;
-        ros::Publisher controlSurfacesMomentPub_;
-        ros::Publisher aoaMomentPub_;
-        ros::Publisher motorsMomentsPub_[5];
-
-        ros::Publisher velocityPub_;
+        SubscribedPublisher tfPub_;
+        tf2_msgs::TFMessage tfMsg_;
+
+        /**
+         * @brief Forces and moments arrows are published as a single MarkerArray, each
+         * marker has its own namespace named as in FORCE_MARKERS and id equal to its type.
+         * The array holds only the enabled markers and it is allocated once on init.
+         */
+        enum ForceMarker_t : int32_t{
+            MARKER_FTOTAL = 0,
+            MARKER_FAERO,
+            MARKER_FMOTOR_0,
+            MARKER_FMOTOR_4 = MARKER_FMOTOR_0 + 4,
+            MARKER_FLIFT,
+            MARKER_FDRUG,
+            MARKER_FSIDE,
+            MARKER_MTOTAL,
+            MARKER_MAERO,
+            MARKER_MSTEER,
+            MARKER_MAIRSPEED,
+            MARKER_MMOTOR_0,
+            MARKER_MMOTOR_4 = MARKER_MMOTOR_0 + 4,
+            MARKER_LINEAR_VELOCITY,
+            MARKERS_AMOUNT,
+        };
+        SubscribedPublisher markersPub_;
+        visualization_msgs::MarkerArray markers_;
+        double markersRate_ = 20.0;                         // Hz, 0 disables the markers
+        std::vector<std::string> disabledMarkers_;
 
         void initMarkers();
-        visualization_msgs::Marker& makeArrow(const Eigen::Vector3d& vector3D,
-                                              const Eigen::Vector3d& rgbColor,
-                                              const char* frameId);
+        Eigen::Vector3d calculateMarkerVector(int32_t markerType) const;
         void publishMarkers();
         void publishState();
         //@}
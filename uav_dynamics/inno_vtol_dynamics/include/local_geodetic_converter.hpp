@@ -0,0 +1,59 @@
+/**
+ * @file local_geodetic_converter.hpp
+ * @brief Fast ENU to geodetic conversion using a local tangent expansion
+ */
+
+#ifndef INNO_VTOL_DYNAMICS_LOCAL_GEODETIC_CONVERTER_HPP
+#define INNO_VTOL_DYNAMICS_LOCAL_GEODETIC_CONVERTER_HPP
+
+#include <Eigen/Geometry>
+#include <geographiclib_conversions/geodetic_conv.hpp>
+
+/**
+ * @brief Exact conversion (ENU -> ECEF -> geodetic) is performed only for an anchor point,
+ * positions within the valid radius around it are converted using the second order
+ * expansion of the ellipsoid at the anchor, it costs a few multiplications and no
+ * transcendental functions. When the vehicle goes further than the valid radius, the
+ * anchor is moved to the current position. The error is dominated by the neglected change
+ * of the meridian curvature with latitude, it is about 0.75 * e^2 * sin(2 * lat) * d^2 / R,
+ * where d is the distance to the anchor, e is the eccentricity and R is the Earth radius.
+ * The spherical d^3 / R^2 term is an order smaller. So at 45 degrees the error is 0.8 mm
+ * at the default radius, it is below 1 mm at any latitude, and it reaches 3.2 mm at 2 km.
+ */
+class LocalGeodeticConverter{
+    public:
+        void initialiseReference(double latitude, double longitude, double altitude,
+                                 double validRadius = DEFAULT_VALID_RADIUS);
+
+        /**
+         * @param enu - position relative to the reference, m
+         * @param geodetic - latitude and longitude in degrees, altitude in m
+         */
+        void enu2Geodetic(const Eigen::Vector3d& enu, Eigen::Vector3d& geodetic);
+
+        size_t getAnchorsAmount() const {return anchorsAmount_;}
+
+        static constexpr double DEFAULT_VALID_RADIUS = 1000.0;     // m
+
+    private:
+        void moveAnchor(const Eigen::Vector3d& enu);
+        static Eigen::Matrix3d calculateEcefToEnu(double latRad, double lonRad);
+
+        geodetic_converter::GeodeticConverter exactConverter_;
+        Eigen::Matrix3d referenceEnuToEcef_;
+        double validRadiusSquared_ = DEFAULT_VALID_RADIUS * DEFAULT_VALID_RADIUS;
+
+        Eigen::Vector3d anchorEnu_;                     // m, relative to the reference
+        Eigen::Matrix3d referenceEnuToAnchorEnu_;
+        double anchorLat_;                              // rad
+        double anchorLon_;                              // rad
+        double anchorAlt_;                              // m
+        double anchorSinLat_;
+        double anchorCosLat_;
+        double anchorTanLat_;
+        double meridianRadius_;                         // m, M + h
+        double primeVerticalRadius_;                    // m, N + h
+        size_t anchorsAmount_ = 0;
+};
+
+#endif  // INNO_VTOL_DYNAMICS_LOCAL_GEODETIC_CONVERTER_HPP
@@ -0,0 +1,65 @@
+/**
+ * @file mag_field_cache.hpp
+ * @brief Cache of the geomagnetic model around the vehicle
+ */
+
+#ifndef INNO_VTOL_DYNAMICS_MAG_FIELD_CACHE_HPP
+#define INNO_VTOL_DYNAMICS_MAG_FIELD_CACHE_HPP
+
+#include <Eigen/Geometry>
+#include <array>
+
+/**
+ * @brief The geomagnetic model is evaluated only at the 8 corners of a lat-lon-alt cell
+ * containing the vehicle, inside the cell the field is interpolated trilinearly.
+ * Cells are aligned to the reference point. When the vehicle leaves the cell, a new one is
+ * built. If the interpolated value in the cell center differs from the model by more than
+ * the tolerance, the cell is split until it fits or becomes the minimal one.
+ */
+class MagFieldCache{
+    public:
+        /**
+         * @param tolerance - max allowed interpolation error in the cell center, Gauss
+         * @param cellSizeDeg - max cell size along latitude and longitude, degrees
+         * @param cellAltitude - cell size along altitude, m
+         */
+        void init(double latRef, double lonRef, double altRef,
+                  double tolerance = DEFAULT_TOLERANCE,
+                  double cellSizeDeg = DEFAULT_CELL_SIZE_DEG,
+                  double cellAltitude = DEFAULT_CELL_ALTITUDE);
+
+        /**
+         * @return magnetic field in NED, Gauss
+         */
+        Eigen::Vector3d getNed(double lat, double lon, double alt);
+
+        size_t getRefreshesAmount() const {return refreshesAmount_;}
+
+        static Eigen::Vector3d calculateNed(double lat, double lon, double alt);
+
+        static constexpr double DEFAULT_TOLERANCE = 0.0005;         // Gauss
+        static constexpr double DEFAULT_CELL_SIZE_DEG = 0.05;       // degrees
+        static constexpr double DEFAULT_CELL_ALTITUDE = 1000.0;     // m
+        static constexpr size_t MAX_SPLITS = 4;
+
+    private:
+        bool isInsideCell(double lat, double lon, double alt) const;
+        void refreshCell(double lat, double lon, double alt);
+        void buildCell(double lat, double lon, double alt, double cellSizeDeg);
+        Eigen::Vector3d interpolate(double lat, double lon, double alt) const;
+
+        double latRef_ = 0;
+        double lonRef_ = 0;
+        double altRef_ = 0;
+        double tolerance_ = DEFAULT_TOLERANCE;
+        double maxCellSizeDeg_ = DEFAULT_CELL_SIZE_DEG;
+        double cellAltitude_ = DEFAULT_CELL_ALTITUDE;
+
+        bool isCellValid_ = false;
+        double cellSizeDeg_ = DEFAULT_CELL_SIZE_DEG;
+        Eigen::Vector3d cellMin_;                       // lat, lon in degrees, alt in m
+        std::array<Eigen::Vector3d, 8> corners_;        // Gauss, NED
+        size_t refreshesAmount_ = 0;
+};
+
+#endif  // INNO_VTOL_DYNAMICS_MAG_FIELD_CACHE_HPP
@@ -86,6 +86,8 @@ public:
 
     /**
      * @brief Send hil_sensor (#107) and hil_gps (#113) to PX4 via mavlink
+     * @param isMagUpdated, isBaroUpdated - the sensor rates are defined by the dynamics
+     * node, so mag and baro fields are marked as updated only if a new sample has come
      */
     int SendHilSensor(unsigned int time_usec,
                       float gpsAltitude,
@@ -94,7 +96,9 @@ public:
                       Eigen::Vector3d gyro_frd,
                       float staticTemperature,
                       float staticPressure,
-                      float diffPressure);
+                      float diffPressure,
+                      bool isMagUpdated,
+                      bool isBaroUpdated);
     int SendHilGps(unsigned int time_usec,
                    Eigen::Vector3d vel_ned,
                    Eigen::Vector3d pose_geodetic);
@@ -119,11 +123,6 @@ private:
 
     // const float ALT_HOME;
 
-    static constexpr uint64_t MAG_PERIOD_US = 1e6 / 100;
-    static constexpr uint64_t BARO_PERIOD_US = 1e6 / 50;
-    uint64_t lastMagTimeUsec_ = 0;
-    uint64_t lastBaroTimeUsec_ = 0;
-
     const int PORT_BASE = 4560;
     struct sockaddr_in px4MavlinkAddr_;
     struct sockaddr_in simulatorMavlinkAddr_;
@@ -165,6 +164,7 @@ private:
     ros::Subscriber staticPressureSub_;
     uavcan_msgs::StaticPressure staticPressureMsg_;
     float staticPressure_;
+    bool isBaroUpdated_ = false;
     void staticPressureCallback(uavcan_msgs::StaticPressure::Ptr staticPressure);
 
     ros::Subscriber rawAirDataSub_;
@@ -177,23 +177,21 @@ private:
     Eigen::Vector3d gpsPosition_;
     Eigen::Vector3d linearVelocityNed_;
     uint64_t gpsMsgCounter_ = 0;
+    bool isGpsUpdated_ = false;
     void gpsCallback(uavcan_msgs::Fix::Ptr gpsPosition);
 
     ros::Subscriber imuSub_;
     sensor_msgs::Imu imuMsg_;
     Eigen::Vector3d accFrd_;
     Eigen::Vector3d gyroFrd_;
+    bool isImuUpdated_ = false;
     void imuCallback(sensor_msgs::Imu::Ptr imu);
 
     ros::Subscriber magSub_;
     sensor_msgs::MagneticField magMsg_;
     Eigen::Vector3d magFrd_;
+    bool isMagUpdated_ = false;
     void magCallback(sensor_msgs::MagneticField::Ptr mag);
-
-    static constexpr uint64_t GPS_PERIOD_US = 1e6 / 10;
-    static constexpr uint64_t IMU_PERIOD_US = 1e6 / 500;
-    uint64_t lastGpsTimeUsec_ = 0;
-    uint64_t lastImuTimeUsec_ = 0;
 };
 
 
@@ -0,0 +1,23 @@
+/**
+ * @file ros_params_source.hpp
+ * @brief Simulator parameters from the ROS parameter server
+ */
+
+#ifndef INNO_VTOL_DYNAMICS_ROS_PARAMS_SOURCE_HPP
+#define INNO_VTOL_DYNAMICS_ROS_PARAMS_SOURCE_HPP
+
+#include "paramsSource.hpp"
+
+/**
+ * @brief The adapter which lets the ROS-free simulators read the parameters loaded by
+ * load_parameters.launch
+ */
+class RosParamsSource : public ParamsSource{
+public:
+    virtual bool get(const std::string& name, double& value) const override;
+    virtual bool get(const std::string& name, std::vector<double>& value) const override;
+    virtual bool get(const std::string& name, std::string& value) const override;
+    virtual std::string getConfigDirectory() const override;
+};
+
+#endif  // INNO_VTOL_DYNAMICS_ROS_PARAMS_SOURCE_HPP
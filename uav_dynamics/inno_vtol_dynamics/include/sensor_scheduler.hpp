@@ -0,0 +1,53 @@
+/**
+ * @file sensor_scheduler.hpp
+ * @brief Multi-rate scheduler of sensor samples
+ */
+
+#ifndef INNO_VTOL_DYNAMICS_SENSOR_SCHEDULER_HPP
+#define INNO_VTOL_DYNAMICS_SENSOR_SCHEDULER_HPP
+
+#include <vector>
+#include <queue>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Min-heap of the next due times of all sensors. Sample times lie on the exact grid
+ * start + k * period of each sensor, so they don't alias to the physics tick and the
+ * effective rate doesn't depend on it. Samples missed because of a late tick are emitted
+ * on the next tick with their original timestamps, but only for the last
+ * MAX_CATCH_UP_PERIODS periods, older ones are skipped.
+ */
+class SensorScheduler{
+    public:
+        /**
+         * @param sensorId - any user defined identifier, it is returned by popDue
+         * @param periodSec - sample period, sec
+         */
+        void addSensor(size_t sensorId, double periodSec);
+        void clear();
+
+        /**
+         * @brief Pop the earliest sample which is due at crntTimeNsec.
+         * The first call defines the start time of all sensors.
+         * @return false if there are no more samples due at crntTimeNsec
+         */
+        bool popDue(uint64_t crntTimeNsec, size_t& sensorId, uint64_t& sampleTimeNsec);
+
+        static constexpr uint64_t MAX_CATCH_UP_PERIODS = 10;
+
+    private:
+        struct Sample{
+            uint64_t dueTimeNsec;
+            size_t sensorId;
+            uint64_t periodNsec;
+            bool operator>(const Sample& other) const {return dueTimeNsec > other.dueTimeNsec;}
+        };
+
+        std::vector<Sample> sensors_;
+        std::priority_queue<Sample, std::vector<Sample>, std::greater<Sample>> queue_;
+        bool isStarted_ = false;
+};
+
+#endif  // INNO_VTOL_DYNAMICS_SENSOR_SCHEDULER_HPP
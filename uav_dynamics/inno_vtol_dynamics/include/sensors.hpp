@@ -9,6 +9,7 @@
 #include <iostream>
 #include <ros/ros.h>
 #include <ros/time.h>
+#include "subscribed_publisher.hpp"
 
 class BaseSensor{
     public:
@@ -16,12 +17,14 @@ class BaseSensor{
         BaseSensor(ros::NodeHandle* nh, double period): node_handler_(nh), PERIOD(period) {};
         void enable() {isEnabled_ = true;}
         void disable() {isEnabled_ = false;}
+        bool isEnabled() const {return isEnabled_;}
+        double getPeriod() const {return PERIOD;}
+        bool hasSubscribers() const {return publisher_.hasSubscribers();}
     protected:
         ros::NodeHandle* node_handler_;
         bool isEnabled_{false};
         const double PERIOD;
-        ros::Publisher publisher_;
-        double nextPubTimeSec_ = 0;
+        SubscribedPublisher publisher_;
 };
 
 class EscStatusSensor : public BaseSensor{
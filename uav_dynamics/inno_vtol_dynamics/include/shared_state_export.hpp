@@ -0,0 +1,107 @@
+/**
+ * @file shared_state_export.hpp
+ * @brief Export of the latest vehicle state into POSIX shared memory for co-simulators
+ * and visualizers on the same host, it doesn't depend on ROS
+ */
+
+#ifndef INNO_VTOL_DYNAMICS_SHARED_STATE_EXPORT_HPP
+#define INNO_VTOL_DYNAMICS_SHARED_STATE_EXPORT_HPP
+
+#include <string>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Plain layout, so the readers may be written in any language. All values are in
+ * PX4 notation: NED for the inertial frame and FRD for the body frame.
+ */
+struct SharedVehicleState{
+    static constexpr size_t MAX_ACTUATORS = 8;
+    static constexpr size_t MAX_MOTORS = 8;
+
+    uint64_t timeNsec;                              // simulation time
+    double position[3];                             // meters, NED
+    double attitude[4];                             // w, x, y, z, FRD to NED
+    double linearVelocity[3];                       // m/sec, NED
+    double angularVelocity[3];                      // rad/sec, FRD
+    double linearAcceleration[3];                   // m/sec^2, NED, zero if not supported by dynamics
+    double angularAcceleration[3];                  // rad/sec^2, FRD, zero if not supported by dynamics
+    double Faero[3];                                // N, FRD, zero if not supported by dynamics
+    double Maero[3];                                // N*m, FRD, zero if not supported by dynamics
+    double Ftotal[3];                               // N, FRD, zero if not supported by dynamics
+    double Mtotal[3];                               // N*m, FRD, zero if not supported by dynamics
+    double actuators[MAX_ACTUATORS];                // setpoints as they are received
+    double motorsRpm[MAX_MOTORS];                   // rpm
+    uint32_t actuatorsAmount;
+    uint32_t motorsAmount;
+};
+
+/**
+ * @brief The shared memory object is a Header followed by a single SharedVehicleState
+ * guarded by a seqlock: the sequence is odd while the writer updates the state, so the
+ * writer never waits and a reader retries if the sequence changed during its copy.
+ */
+struct SharedStateHeader{
+    uint64_t magic;
+    uint32_t version;
+    uint32_t stateSize;                             // bytes, sizeof(SharedVehicleState)
+    alignas(64) std::atomic<uint64_t> sequence;
+};
+
+class SharedStateWriter{
+public:
+    SharedStateWriter() = default;
+    ~SharedStateWriter();
+    SharedStateWriter(const SharedStateWriter&) = delete;
+    SharedStateWriter& operator=(const SharedStateWriter&) = delete;
+
+    /**
+     * @brief Create or truncate the shared memory object, it is unlinked on close
+     * @param name - POSIX shared memory name, e.g. "/inno_vtol_state"
+     * @return -1 if error occured, else 0
+     */
+    int8_t create(const std::string& name);
+    void write(const SharedVehicleState& state);
+    void close();
+    bool isOpened() const {return header_ != nullptr;}
+
+private:
+    SharedStateHeader* header_ = nullptr;
+    SharedVehicleState* state_ = nullptr;
+    std::string name_;
+};
+
+class SharedStateReader{
+public:
+    SharedStateReader() = default;
+    ~SharedStateReader();
+    SharedStateReader(const SharedStateReader&) = delete;
+    SharedStateReader& operator=(const SharedStateReader&) = delete;
+
+    int8_t open(const std::string& name);
+    void close();
+
+    /**
+     * @return false if there is no consistent snapshot after maxAttempts or nothing has been
+     * written yet
+     */
+    bool read(SharedVehicleState& state, size_t maxAttempts = DEFAULT_MAX_ATTEMPTS) const;
+
+    /**
+     * @brief Even sequence grows by 2 with each written state, it lets the reader skip
+     * the copy if nothing is changed since its last read
+     */
+    uint64_t getSequence() const;
+
+    static constexpr size_t DEFAULT_MAX_ATTEMPTS = 1000;
+
+private:
+    const SharedStateHeader* header_ = nullptr;
+    const SharedVehicleState* state_ = nullptr;
+};
+
+constexpr uint64_t SHARED_STATE_MAGIC = 0x4554415453565449ULL;     // "ITVSTATE"
+constexpr uint32_t SHARED_STATE_VERSION = 1;
+
+#endif  // INNO_VTOL_DYNAMICS_SHARED_STATE_EXPORT_HPP
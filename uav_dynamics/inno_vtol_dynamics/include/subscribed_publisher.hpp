@@ -0,0 +1,52 @@
+/**
+ * @file subscribed_publisher.hpp
+ * @brief Publisher which knows whether anybody listens to it, so the caller may skip both
+ * the calculation and the serialization of a message nobody needs
+ */
+
+#ifndef INNO_VTOL_DYNAMICS_SUBSCRIBED_PUBLISHER_HPP
+#define INNO_VTOL_DYNAMICS_SUBSCRIBED_PUBLISHER_HPP
+
+#include <atomic>
+#include <string>
+#include <ros/ros.h>
+
+/**
+ * @brief The amount of subscribers is cached and updated by the connect and disconnect
+ * callbacks, so hasSubscribers() is a single atomic load instead of a topic manager query.
+ * The callbacks hold this pointer, so the object must not be moved after advertise().
+ */
+class SubscribedPublisher{
+    public:
+        SubscribedPublisher() = default;
+        SubscribedPublisher(const SubscribedPublisher&) = delete;
+        SubscribedPublisher& operator=(const SubscribedPublisher&) = delete;
+
+        template<class Message>
+        void advertise(ros::NodeHandle& node, const std::string& topic, uint32_t queueSize){
+            subscribersAmount_ = 0;
+            publisher_ = node.advertise<Message>(topic, queueSize,
+                [this](const ros::SingleSubscriberPublisher&){subscribersAmount_++;},
+                [this](const ros::SingleSubscriberPublisher&){subscribersAmount_--;});
+        }
+
+        bool hasSubscribers() const {return subscribersAmount_.load(std::memory_order_relaxed) > 0;}
+
+        /**
+         * @return false if the message is dropped because nobody listens
+         */
+        template<class Message>
+        bool publish(const Message& msg){
+            if(!hasSubscribers()){
+                return false;
+            }
+            publisher_.publish(msg);
+            return true;
+        }
+
+    private:
+        ros::Publisher publisher_;
+        std::atomic<int32_t> subscribersAmount_{0};
+};
+
+#endif  // INNO_VTOL_DYNAMICS_SUBSCRIBED_PUBLISHER_HPP
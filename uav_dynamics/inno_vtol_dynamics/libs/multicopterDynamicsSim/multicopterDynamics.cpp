@@ -0,0 +1,627 @@
+/**
+ * @file multicopterDynamics.cpp
+ * @brief Multicopter dynamics simulator class template implementation, it is explicitly
+ * instantiated for the dynamic and the quadcopter motors amount
+ *
+ */
+#include "multicopterDynamics.hpp"
+#include <chrono>
+
+/**
+ * @brief Construct a new Multicopter Dynamics object
+ *
+ * @param numCopter Number of motors, it must be equal to NumMotors if it is fixed
+ * @param thrustCoefficient Motors thrust coefficient
+ * @param torqueCoefficient Motors torque coefficient
+ * @param minMotorSpeed Motors minimum rotation speed
+ * @param maxMotorSpeed Motors maximum rotation speed
+ * @param motorTimeConstant Motors time constant
+ * @param motorRotationalInertia Motors rotational mass moment of inertia (including propeller)
+ * @param vehicleMass Vehicle mass
+ * @param vehicleInertia Vehicle inertia matrix
+ * @param aeroMomentCoefficient Vehicle aerodynamic moment coefficient matrix
+ * @param dragCoefficient Vehicle drag coefficient
+ * @param momentProcessNoiseAutoCorrelation Vehicle dynamics stochastic moment process noise auto correlation
+ * @param forceProcessNoiseAutoCorrelation Vehicle dynamics stochastic force process noise auto correlation
+ * @param gravity Gravity vector in world-fixed reference frame
+ */
+template<int NumMotors>
+MulticopterDynamics<NumMotors>::MulticopterDynamics(int numCopter,
+double thrustCoefficient, double torqueCoefficient,
+double minMotorSpeed, double maxMotorSpeed,
+double motorTimeConstant, double motorRotationalInertia,
+double vehicleMass,
+const Eigen::Matrix3d & vehicleInertia,
+const Eigen::Matrix3d & aeroMomentCoefficient,
+double dragCoefficient,
+double momentProcessNoiseAutoCorrelation,
+double forceProcessNoiseAutoCorrelation,
+const Eigen::Vector3d & gravity
+){
+    initMotors(numCopter);
+    setMotorProperties(thrustCoefficient, torqueCoefficient, motorTimeConstant,
+                       minMotorSpeed, maxMotorSpeed, motorRotationalInertia);
+    setVehicleProperties(vehicleMass, vehicleInertia, aeroMomentCoefficient, dragCoefficient,
+                         momentProcessNoiseAutoCorrelation, forceProcessNoiseAutoCorrelation);
+    gravity_ = gravity;
+}
+
+/**
+ * @brief Brief constructor for a new Multicopter Dynamics object;
+ * vehicle properties must still be set seperately
+ *
+ * @param numCopter Number of motors, it must be equal to NumMotors if it is fixed
+ */
+template<int NumMotors>
+MulticopterDynamics<NumMotors>::MulticopterDynamics(int numCopter){
+    initMotors(numCopter);
+    setMotorProperties(0., 0., 0., 0., 0., 0.);
+
+    // Default is NED, but can be set by changing gravity direction
+    gravity_ << 0.,0.,9.81;
+}
+
+/**
+ * @brief Size the motor arrays and the workspace, motor frames are identity
+ */
+template<int NumMotors>
+void MulticopterDynamics<NumMotors>::initMotors(int numCopter){
+    static_assert(NumMotors == Eigen::Dynamic || NumMotors > 0, "Wrong motors amount");
+    eigen_assert(NumMotors == Eigen::Dynamic || NumMotors == numCopter);
+    numCopter_ = numCopter;
+    randomNumberGenerator_.seed(std::chrono::system_clock::now().time_since_epoch().count());
+
+    thrustAxes_.resize(3, numCopter);
+    thrustAxes_.row(2).setOnes();
+    thrustAxes_.topRows(2).setZero();
+    thrustMomentArms_.setZero(3, numCopter);
+    motorDirection_.setOnes(numCopter);
+    thrustCoefficient_.resize(numCopter);
+    torqueCoefficient_.resize(numCopter);
+    motorTimeConstant_.resize(numCopter);
+    motorRotationalInertia_.resize(numCopter);
+    maxMotorSpeed_.resize(numCopter);
+    minMotorSpeed_.resize(numCopter);
+    motorSpeed_.setZero(numCopter);
+
+    motorSpeedCommand_.setZero(numCopter);
+    motorSpeedAccumulated_.setZero(numCopter);
+    motorSpeedIntermediate_.setZero(numCopter);
+    motorSpeedDer_.setZero(numCopter);
+    motorThrust_.setZero(numCopter);
+    motorTorque_.setZero(numCopter);
+    motorAngularMomentum_.setZero(numCopter);
+}
+
+/**
+ * @brief Set vehicle properties
+ *
+ * @param vehicleMass Vehicle mass
+ * @param vehicleInertia Vehicle inertia matrix
+ * @param aeroMomentCoefficient Vehicle aerodynamic moment coefficient matrix
+ * @param dragCoefficient Vehicle drag coefficient
+ * @param momentProcessNoiseAutoCorrelation Vehicle dynamics stochastic moment process noise auto correlation
+ * @param forceProcessNoiseAutoCorrelation Vehicle dynamics stochastic force process noise auto correlation
+ */
+template<int NumMotors>
+void MulticopterDynamics<NumMotors>::setVehicleProperties(double vehicleMass,
+                                            const Eigen::Matrix3d & vehicleInertia,
+                                            const Eigen::Matrix3d & aeroMomentCoefficient,
+                                            double dragCoefficient,
+                                            double momentProcessNoiseAutoCorrelation,
+                                            double forceProcessNoiseAutoCorrelation){
+    vehicleMass_ = vehicleMass;
+    vehicleInertia_ = vehicleInertia;
+    vehicleInertiaInverse_ = vehicleInertia.inverse();
+    aeroMomentCoefficient_ = aeroMomentCoefficient;
+    dragCoefficient_ = dragCoefficient;
+    momentProcessNoiseAutoCorrelation_ = momentProcessNoiseAutoCorrelation;
+    forceProcessNoiseAutoCorrelation_ = forceProcessNoiseAutoCorrelation;
+}
+
+/**
+ * @brief Set orientation of world-fixed reference frame using gravity vector
+ *
+ * @param gravity Gravity vector in world-fixed reference frame
+ */
+template<int NumMotors>
+void MulticopterDynamics<NumMotors>::setGravityVector(const Eigen::Vector3d & gravity){
+    gravity_ = gravity;
+}
+
+/**
+ * @brief Set orientation and position for individual motor
+ *
+ * @param motorFrame Motor orientation and position with regard to body-fixed reference frame
+ * @param motorDirection Motor rotation direction
+ *         +1 if positive motor speed corresponds to positive moment around the motor frame z-axis
+           -1 if positive motor speed corresponds to negative moment around the motor frame z-axis
+           i.e. -1 indicates a positive motor speed corresponds to a positive rotation rate around the motor z-axis
+ * @param motorIndex Motor index number
+ */
+template<int NumMotors>
+void MulticopterDynamics<NumMotors>::setMotorFrame(const Eigen::Isometry3d & motorFrame,
+                                                   int motorDirection, int motorIndex){
+    thrustAxes_.col(motorIndex) = motorFrame.linear().col(2);
+    thrustMomentArms_.col(motorIndex) = motorFrame.translation().cross(motorFrame.linear().col(2));
+    motorDirection_(motorIndex) = motorDirection;
+}
+
+/**
+ * @brief Set properties for individual motor
+ *
+ * @param thrustCoefficient Motor thrust coefficient
+ * @param torqueCoefficient Motor torque coefficient
+ * @param motorTimeConstant Motor time constant
+ * @param minMotorSpeed Minimum motor rotation speed
+ * @param maxMotorSpeed Maximum motor rotation speed
+ * @param rotationalInertia Motor moment of inertia
+ * @param motorIndex Motor index number
+ */
+template<int NumMotors>
+void MulticopterDynamics<NumMotors>::setMotorProperties(double thrustCoefficient, double torqueCoefficient,
+                                                        double motorTimeConstant,
+                                                        double minMotorSpeed, double maxMotorSpeed,
+                                                        double rotationalInertia, int motorIndex){
+    thrustCoefficient_(motorIndex) = thrustCoefficient;
+    torqueCoefficient_(motorIndex) = torqueCoefficient;
+    motorTimeConstant_(motorIndex) = motorTimeConstant;
+    maxMotorSpeed_(motorIndex) = maxMotorSpeed;
+    minMotorSpeed_(motorIndex) = minMotorSpeed;
+    motorRotationalInertia_(motorIndex) = rotationalInertia;
+}
+
+/**
+ * @brief Set properties for all motors
+ *
+ * @param thrustCoefficient Motor thrust coefficient
+ * @param torqueCoefficient Motor torque coefficient
+ * @param motorTimeConstant Motor time constant
+ * @param minMotorSpeed Minimum motor rotation speed
+ * @param maxMotorSpeed Maximum motor rotation speed
+ * @param rotationalInertia Motor moment of inertia
+ */
+template<int NumMotors>
+void MulticopterDynamics<NumMotors>::setMotorProperties(double thrustCoefficient, double torqueCoefficient,
+                                                        double motorTimeConstant,
+                                                        double minMotorSpeed, double maxMotorSpeed,
+                                                        double rotationalInertia){
+    thrustCoefficient_.setConstant(thrustCoefficient);
+    torqueCoefficient_.setConstant(torqueCoefficient);
+    motorTimeConstant_.setConstant(motorTimeConstant);
+    maxMotorSpeed_.setConstant(maxMotorSpeed);
+    minMotorSpeed_.setConstant(minMotorSpeed);
+    motorRotationalInertia_.setConstant(rotationalInertia);
+}
+
+/**
+ * @brief Set motor speed for individual motor
+ *
+ * @param motorSpeed Motor speed value
+ * @param motorIndex Motor index number
+ */
+template<int NumMotors>
+void MulticopterDynamics<NumMotors>::setMotorSpeed(double motorSpeed, int motorIndex){
+    motorSpeed_(motorIndex) = motorSpeed;
+}
+
+/**
+ * @brief Set motor speed for all motors
+ *
+ * @param motorSpeed Motor speed value
+ */
+template<int NumMotors>
+void MulticopterDynamics<NumMotors>::setMotorSpeed(double motorSpeed){
+    motorSpeed_.setConstant(motorSpeed);
+}
+
+/**
+ * @brief Set motor speed to zero for all motors
+ *
+ */
+template<int NumMotors>
+void MulticopterDynamics<NumMotors>::resetMotorSpeeds(void){
+    motorSpeed_.setZero();
+}
+
+/**
+ * @brief Set vehicle position and attitude
+ *
+ * @param position Position in world-fixed reference frame
+ * @param attitude Vehilce attitude quaternion
+ */
+template<int NumMotors>
+void MulticopterDynamics<NumMotors>::setVehiclePosition(const Eigen::Vector3d & position,
+                                                        const Eigen::Quaterniond & attitude){
+    position_ = position;
+    attitude_ = attitude;
+
+    angularVelocity_.setZero();
+    velocity_.setZero();
+
+    resetMotorSpeeds();
+}
+
+template<int NumMotors>
+void MulticopterDynamics<NumMotors>::setVehicleInitialAttitude(const Eigen::Quaterniond & attitude){
+    default_attitude_ = attitude;
+}
+
+/**
+ * @brief Set vehicle state
+ *
+ * @param position Position in world-fixed reference frame
+ * @param velocity Velocity in world-fixed reference frame
+ * @param angularVelocity Angular velocity in vehicle-fixed reference frame
+ * @param attitude Vehilce attitude quaternion
+ * @param motorSpeed Motor speeds for all motors
+ */
+template<int NumMotors>
+void MulticopterDynamics<NumMotors>::setVehicleState(const Eigen::Vector3d & position,
+                                                     const Eigen::Vector3d & velocity,
+                                                     const Eigen::Vector3d & angularVelocity,
+                                                     const Eigen::Quaterniond & attitude,
+                                                     const Eigen::Ref<const MotorArray> & motorSpeed){
+    position_ = position;
+    velocity_ = velocity;
+    angularVelocity_ = angularVelocity;
+    attitude_ = attitude;
+    motorSpeed_ = motorSpeed;
+}
+
+/**
+ * @brief Get vehicle state
+ *
+ * @param position Position in world-fixed reference frame output
+ * @param velocity Velocity in world-fixed reference frame output
+ * @param angularVelocity Angular velocity in vehicle-fixed reference frame output
+ * @param attitude Vehilce attitude quaternion output
+ * @param motorSpeed Motor speeds for all motors output
+ */
+template<int NumMotors>
+void MulticopterDynamics<NumMotors>::getVehicleState(Eigen::Vector3d & position,
+                                                     Eigen::Vector3d & velocity,
+                                                     Eigen::Vector3d & angularVelocity,
+                                                     Eigen::Quaterniond & attitude,
+                                                     MotorArray & motorSpeed) const{
+    position = position_;
+    velocity = velocity_;
+    angularVelocity = angularVelocity_;
+    attitude = attitude_;
+    motorSpeed = motorSpeed_;
+}
+
+template<int NumMotors>
+Eigen::Vector3d MulticopterDynamics<NumMotors>::getVehiclePosition(void) const{
+    return position_;
+}
+
+template<int NumMotors>
+Eigen::Quaterniond MulticopterDynamics<NumMotors>::getVehicleAttitude(void) const{
+    return attitude_;
+}
+
+template<int NumMotors>
+Eigen::Vector3d MulticopterDynamics<NumMotors>::getVehicleVelocity(void) const{
+    return velocity_;
+}
+
+template<int NumMotors>
+Eigen::Vector3d MulticopterDynamics<NumMotors>::getVehicleAngularVelocity(void) const{
+    return angularVelocity_;
+}
+
+/**
+ * @brief Get total specific force acting on vehicle, excluding gravity force
+ *
+ * @return Eigen::Vector3d Specific force in vehicle-fixed reference frame
+ */
+template<int NumMotors>
+Eigen::Vector3d MulticopterDynamics<NumMotors>::getVehicleSpecificForce(void){
+    return (getThrust(motorSpeed_) + attitude_.inverse()*(getDragForce(velocity_) + stochForce_)) / vehicleMass_;
+}
+
+/**
+ * @brief Get thrust in vehicle-fixed reference frame
+ *
+ * @param motorSpeed Motor speeds
+ * @return Eigen::Vector3d Thrust vector
+ */
+template<int NumMotors>
+Eigen::Vector3d MulticopterDynamics<NumMotors>::getThrust(const MotorArray & motorSpeed){
+    motorThrust_ = motorSpeed.abs() * motorSpeed * thrustCoefficient_;
+    return thrustAxes_ * motorThrust_.matrix();
+}
+
+/**
+ * @brief Get control moment in vehicle-fixed reference frame
+ *
+ * @param motorSpeed Motor speeds
+ * @param motorAcceleration Motor accelerations
+ * @return Eigen::Vector3d Moment vector
+ */
+template<int NumMotors>
+Eigen::Vector3d MulticopterDynamics<NumMotors>::getControlMoment(const MotorArray & motorSpeed,
+                                                                 const MotorArray & motorAcceleration){
+    motorThrust_ = motorSpeed.abs() * motorSpeed * thrustCoefficient_;
+    motorTorque_ = motorDirection_ * (motorSpeed.abs() * motorSpeed * torqueCoefficient_ +
+                                      motorRotationalInertia_ * motorAcceleration);
+    return thrustMomentArms_ * motorThrust_.matrix() + thrustAxes_ * motorTorque_.matrix();
+}
+
+/**
+ * @brief Get aerodynamic moment in vehicle-fixed reference frame
+ *
+ * @param angularVelocity Vehicle angular velocity
+ * @return Eigen::Vector3d Aerodynamic moment vector
+ */
+template<int NumMotors>
+Eigen::Vector3d MulticopterDynamics<NumMotors>::getAeroMoment(const Eigen::Vector3d & angularVelocity) const{
+    return (-angularVelocity.norm()*aeroMomentCoefficient_*angularVelocity);
+}
+
+/**
+ * @brief Get drag force in world-fixed reference frame
+ *
+ * @param velocity Vehicle velocity in world-fixed reference frame
+ * @return Eigen::Vector3d Drag force vector
+ */
+template<int NumMotors>
+Eigen::Vector3d MulticopterDynamics<NumMotors>::getDragForce(const Eigen::Vector3d & velocity) const{
+    return (-dragCoefficient_*velocity.norm()*velocity);
+}
+
+/**
+ * @brief Get IMU measurement
+ *
+ * @param accOutput Ouput accelerometer measurement
+ * @param gyroOutput Ouput gyroscope measurement
+ */
+template<int NumMotors>
+void MulticopterDynamics<NumMotors>::getIMUMeasurement(Eigen::Vector3d & accOutput, Eigen::Vector3d & gyroOutput){
+    if( position_.z() < 0.1){
+        imu_.getMeasurement(accOutput, gyroOutput, Eigen::Vector3d::Zero(), angularVelocity_);
+        accOutput = accOutput - attitude_.inverse()*gravity_;
+    }else{
+        imu_.getMeasurement(accOutput, gyroOutput, getVehicleSpecificForce(), angularVelocity_);
+    }
+}
+
+/**
+ * @brief Scale the command if it is in percents and bound it into the workspace
+ */
+template<int NumMotors>
+void MulticopterDynamics<NumMotors>::boundMotorSpeedCommand(const Eigen::Ref<const MotorArray> & motorSpeedCommand,
+                                                            bool isCmdPercent){
+    if(isCmdPercent){
+        motorSpeedCommand_ = (motorSpeedCommand * maxMotorSpeed_).min(maxMotorSpeed_).max(minMotorSpeed_);
+    }else{
+        motorSpeedCommand_ = motorSpeedCommand.min(maxMotorSpeed_).max(minMotorSpeed_);
+    }
+}
+
+template<int NumMotors>
+Eigen::Vector3d MulticopterDynamics<NumMotors>::getStochMoment(double dt_secs){
+    double stdDev = sqrt(momentProcessNoiseAutoCorrelation_/dt_secs);
+    Eigen::Vector3d stochMoment;
+    stochMoment << stdDev*standardNormalDistribution_(randomNumberGenerator_),
+                   stdDev*standardNormalDistribution_(randomNumberGenerator_),
+                   stdDev*standardNormalDistribution_(randomNumberGenerator_);
+    return stochMoment;
+}
+
+template<int NumMotors>
+void MulticopterDynamics<NumMotors>::updateStochForce(void){
+    double stdDev = sqrt(forceProcessNoiseAutoCorrelation_);
+    stochForce_ << stdDev*standardNormalDistribution_(randomNumberGenerator_),
+                   stdDev*standardNormalDistribution_(randomNumberGenerator_),
+                   stdDev*standardNormalDistribution_(randomNumberGenerator_);
+}
+
+/**
+ * @brief Land the vehicle if it has gone below the ground after an integration step
+ */
+template<int NumMotors>
+void MulticopterDynamics<NumMotors>::clampToGround(void){
+    if( position_.z() < 0){
+        position_[2] = 0.00;
+        velocity_ << 0.0, 0.0, 0.0;
+        angularVelocity_ << 0.0, 0.0, 0.0;
+        attitude_ = default_attitude_;
+    }
+}
+
+/**
+ * @brief Proceed vehicle dynamics using Explicit Euler integration
+ *
+ * @param dt_secs Time step
+ * @param motorSpeedCommand Motor speed commands
+ */
+template<int NumMotors>
+void MulticopterDynamics<NumMotors>::proceedState_ExplicitEuler(double dt_secs,
+                                                                const Eigen::Ref<const MotorArray> & motorSpeedCommand,
+                                                                bool isCmdPercent){
+    boundMotorSpeedCommand(motorSpeedCommand, isCmdPercent);
+
+    stochForce_ /= sqrt(dt_secs);
+    Eigen::Vector3d stochMoment = getStochMoment(dt_secs);
+
+    getMotorSpeedDerivative(motorSpeedDer_, motorSpeed_, motorSpeedCommand_);
+    Eigen::Vector3d positionDer = velocity_;
+    Eigen::Vector3d velocityDer = getVelocityDerivative(attitude_, stochForce_, velocity_, motorSpeed_);
+    Eigen::Vector4d attitudeDer = getAttitudeDerivative(attitude_, angularVelocity_);
+    Eigen::Vector3d angularVelocityDer = getAngularVelocityDerivative(motorSpeed_, motorSpeedDer_,
+                                                                      angularVelocity_, stochMoment);
+
+    motorSpeed_ = (motorSpeed_ + motorSpeedDer_*dt_secs).min(maxMotorSpeed_).max(minMotorSpeed_);
+    position_ += positionDer*dt_secs;
+    velocity_ += velocityDer*dt_secs;
+    angularVelocity_ += angularVelocityDer*dt_secs;
+    attitude_.coeffs() += attitudeDer*dt_secs;
+
+    attitude_.normalize();
+
+    clampToGround();
+
+    updateStochForce();
+
+    imu_.proceedBiasDynamics(dt_secs);
+}
+
+/**
+ * @brief Proceed vehicle dynamics using 4th order Runge-Kutta integration
+ *
+ * @param dt_secs Time step
+ * @param motorSpeedCommand Motor speed commands
+ */
+template<int NumMotors>
+void MulticopterDynamics<NumMotors>::proceedState_RK4(double dt_secs,
+                                                      const Eigen::Ref<const MotorArray> & motorSpeedCommand,
+                                                      bool isCmdPercent){
+    boundMotorSpeedCommand(motorSpeedCommand, isCmdPercent);
+
+    motorSpeedAccumulated_ = motorSpeed_;
+    Eigen::Vector3d position = position_;
+    Eigen::Vector3d velocity = velocity_;
+    Eigen::Vector3d angularVelocity = angularVelocity_;
+    Eigen::Quaterniond attitude = attitude_;
+
+    stochForce_ /= sqrt(dt_secs);
+    Eigen::Vector3d stochMoment = getStochMoment(dt_secs);
+
+    // k1
+    getMotorSpeedDerivative(motorSpeedDer_, motorSpeed_, motorSpeedCommand_);
+    Eigen::Vector3d positionDer = dt_secs*velocity_;
+    Eigen::Vector3d velocityDer = dt_secs*getVelocityDerivative(attitude_, stochForce_, velocity_, motorSpeed_);
+    Eigen::Vector4d attitudeDer = dt_secs*getAttitudeDerivative(attitude_, angularVelocity_);
+    Eigen::Vector3d angularVelocityDer = dt_secs*getAngularVelocityDerivative(motorSpeed_, motorSpeedDer_,
+                                                                              angularVelocity_, stochMoment);
+    motorSpeedDer_ *= dt_secs;
+
+    // x + 1/6*(k1)
+    motorSpeedAccumulated_ += (1./6.)*motorSpeedDer_;
+    position += (1./6.)*positionDer;
+    velocity += (1./6.)*velocityDer;
+    attitude.coeffs() += (1./6.)*attitudeDer;
+    attitude.normalize();
+    angularVelocity += (1./6.)*angularVelocityDer;
+
+    // k2, k3 and k4 are evaluated at x + 0.5*(k1), x + 0.5*(k2) and x + k3
+    Eigen::Quaterniond attitudeIntermediate;
+    const double STAGES_OFFSETS[3] = {0.5, 0.5, 1.0};
+    const double STAGES_WEIGHTS[3] = {1./3., 1./3., 1./6.};
+    for(size_t stage = 0; stage < 3; stage++){
+        const double offset = STAGES_OFFSETS[stage];
+        motorSpeedIntermediate_ = (motorSpeed_ + offset*motorSpeedDer_).min(maxMotorSpeed_).max(minMotorSpeed_);
+        attitudeIntermediate.coeffs() = attitude_.coeffs() + attitudeDer*offset;
+        attitudeIntermediate.normalize();
+
+        getMotorSpeedDerivative(motorSpeedDer_, motorSpeedIntermediate_, motorSpeedCommand_);
+        positionDer = dt_secs*(velocity_ + offset*velocityDer);
+        velocityDer = dt_secs*getVelocityDerivative(attitudeIntermediate, stochForce_,
+                                                    velocity_ + offset*velocityDer, motorSpeedIntermediate_);
+        attitudeDer = dt_secs*getAttitudeDerivative(attitudeIntermediate, angularVelocity_ + offset*angularVelocityDer);
+        angularVelocityDer = dt_secs*getAngularVelocityDerivative(motorSpeedIntermediate_, motorSpeedDer_,
+                                                                  angularVelocity_ + offset*angularVelocityDer,
+                                                                  stochMoment);
+        motorSpeedDer_ *= dt_secs;
+
+        const double weight = STAGES_WEIGHTS[stage];
+        motorSpeedAccumulated_ += weight*motorSpeedDer_;
+        position += weight*positionDer;
+        velocity += weight*velocityDer;
+        attitude.coeffs() += weight*attitudeDer;
+        angularVelocity += weight*angularVelocityDer;
+        if(stage < 2){
+            attitude.normalize();
+        }
+    }
+
+    // x + 1/6*(k1 + 2*k2 + 2*k3 + k4)
+    motorSpeed_ = motorSpeedAccumulated_.min(maxMotorSpeed_).max(minMotorSpeed_);
+    position_ = position;
+    velocity_ = velocity;
+    attitude_ = attitude;
+    attitude_.normalize();
+    angularVelocity_ = angularVelocity;
+
+    clampToGround();
+
+    updateStochForce();
+
+    imu_.proceedBiasDynamics(dt_secs);
+}
+
+/**
+ * @brief Get motor acceleration
+ *
+ * @param motorSpeedDer Output accelerations
+ * @param motorSpeed Motor speeds
+ * @param motorSpeedCommand Motor commanded speeds
+ */
+template<int NumMotors>
+void MulticopterDynamics<NumMotors>::getMotorSpeedDerivative(MotorArray & motorSpeedDer,
+                                                             const MotorArray & motorSpeed,
+                                                             const MotorArray & motorSpeedCommand) const{
+    motorSpeedDer = (motorSpeedCommand - motorSpeed) / motorTimeConstant_;
+}
+
+/**
+ * @brief Get vehicle accelertion in world-fixed reference frame
+ *
+ * @param attitude Vehicle attitude
+ * @param stochForce Stochastic force vecotr
+ * @param velocity Vehicle velocity
+ * @param motorSpeed Motor speeds
+ * @return Eigen::Vector3d Acceleration vector
+ */
+template<int NumMotors>
+Eigen::Vector3d MulticopterDynamics<NumMotors>::getVelocityDerivative(const Eigen::Quaterniond & attitude,
+                                                                      const Eigen::Vector3d & stochForce,
+                                                                      const Eigen::Vector3d & velocity,
+                                                                      const MotorArray & motorSpeed){
+    return (gravity_ + (attitude*getThrust(motorSpeed) + getDragForce(velocity) + stochForce)/vehicleMass_);
+}
+
+/**
+ * @brief Get attitude quaternion time-derivative
+ *
+ * @param attitude Vehicle attitude
+ * @param angularVelocity Vehicle angular velocity in vehicle-fixed reference frame
+ * @return Eigen::Vector4d Attitude derivative
+ */
+template<int NumMotors>
+Eigen::Vector4d MulticopterDynamics<NumMotors>::getAttitudeDerivative(const Eigen::Quaterniond & attitude,
+                                                                      const Eigen::Vector3d & angularVelocity) const{
+    Eigen::Quaterniond angularVelocityQuad;
+    angularVelocityQuad.w() = 0;
+    angularVelocityQuad.vec() = angularVelocity;
+
+    return (0.5*(attitude*angularVelocityQuad).coeffs());
+}
+
+/**
+ * @brief Get vehicle angular acceleration in vehicle-fixed reference frame
+ *
+ * @param motorSpeed Motor speeds
+ * @param motorAcceleration Motor accelerations
+ * @param angularVelocity Vehicle angular velocity
+ * @param stochMoment Stochastic moment vector
+ * @return Eigen::Vector3d Angular acceleration
+ */
+template<int NumMotors>
+Eigen::Vector3d MulticopterDynamics<NumMotors>::getAngularVelocityDerivative(const MotorArray & motorSpeed,
+                                                                             const MotorArray & motorAcceleration,
+                                                                             const Eigen::Vector3d & angularVelocity,
+                                                                             const Eigen::Vector3d & stochMoment){
+    Eigen::Vector3d controlMoment = getControlMoment(motorSpeed, motorAcceleration);
+
+    motorAngularMomentum_ = -motorDirection_ * motorRotationalInertia_ * motorSpeed;
+    Eigen::Vector3d angularMomentum = vehicleInertia_*angularVelocity + thrustAxes_ * motorAngularMomentum_.matrix();
+
+    return (vehicleInertiaInverse_*(controlMoment + getAeroMoment(angularVelocity) + stochMoment
+                                    - angularVelocity.cross(angularMomentum)));
+}
+
+template class MulticopterDynamics<Eigen::Dynamic>;
+template class MulticopterDynamics<4>;
@@ -0,0 +1,194 @@
+/**
+ * @file multicopterDynamics.hpp
+ * @brief Multicopter dynamics simulator class template header file
+ *
+ */
+
+#ifndef MULTICOPTERDYNAMICS_H
+#define MULTICOPTERDYNAMICS_H
+
+#include <Eigen/Dense>
+#include <Eigen/Geometry>
+#include <random>
+#include "inertialMeasurementSim.hpp"
+#include <geographiclib_conversions/geodetic_conv.hpp>
+
+/**
+ * @brief Multicopter dynamics simulator with motors amount known at compile time.
+ * Per-motor properties and states are Eigen arrays and the motor frames are reduced to
+ * thrust axes and moment arms matrices, so the motor loops are a few array expressions.
+ * All intermediate values of the integration live in a workspace allocated once in the
+ * constructor, so a step doesn't allocate even for NumMotors = Eigen::Dynamic.
+ */
+template<int NumMotors>
+class MulticopterDynamics{
+    public:
+        typedef Eigen::Array<double, NumMotors, 1> MotorArray;
+        typedef Eigen::Matrix<double, 3, NumMotors> MotorAxes;
+
+        MulticopterDynamics(int numCopter, double thrustCoefficient, double torqueCoefficient,
+                            double minMotorSpeed, double maxMotorSpeed,
+                            double motorTimeConstant, double motorRotationalInertia,
+                            double vehicleMass,
+                            const Eigen::Matrix3d & vehicleInertia,
+                            const Eigen::Matrix3d & aeroMomentCoefficient,
+                            double dragCoefficient,
+                            double momentProcessNoiseAutoCorrelation,
+                            double forceProcessNoiseAutoCorrelation,
+                            const Eigen::Vector3d & gravity);
+        explicit MulticopterDynamics(int numCopter = NumMotors);
+        void setVehicleProperties(double vehicleMass, const Eigen::Matrix3d & vehicleInertia,
+                                  const Eigen::Matrix3d & aeroMomentCoefficient,
+                                  double dragCoefficient,
+                                  double momentProcessNoiseAutoCorrelation,
+                                  double forceProcessNoiseAutoCorrelation);
+        void setGravityVector(const Eigen::Vector3d & gravity);
+        void setMotorFrame(const Eigen::Isometry3d & motorFrame, int motorDirection, int motorIndex);
+        void setMotorProperties(double thrustCoefficient, double torqueCoefficient, double motorTimeConstant,
+                                double minMotorSpeed, double maxMotorSpeed, double rotationalInertia, int motorIndex);
+        void setMotorProperties(double thrustCoefficient, double torqueCoefficient, double motorTimeConstant,
+                                double minMotorSpeed, double maxMotorSpeed, double rotationalInertia);
+        void setMotorSpeed(double motorSpeed, int motorIndex);
+        void setMotorSpeed(double motorSpeed);
+        void resetMotorSpeeds(void);
+        void setVehiclePosition(const Eigen::Vector3d & position,const Eigen::Quaterniond & attitude);
+        void setVehicleInitialAttitude(const Eigen::Quaterniond & attitude);
+        void setVehicleState(const Eigen::Vector3d & position,
+                             const Eigen::Vector3d & velocity,
+                             const Eigen::Vector3d & angularVelocity,
+                             const Eigen::Quaterniond & attitude,
+                             const Eigen::Ref<const MotorArray> & motorSpeed);
+        void getVehicleState(Eigen::Vector3d & position,
+                             Eigen::Vector3d & velocity,
+                             Eigen::Vector3d & angularVelocity,
+                             Eigen::Quaterniond & attitude,
+                             MotorArray & motorSpeed) const;
+        Eigen::Vector3d getVehiclePosition(void) const;
+        Eigen::Quaterniond getVehicleAttitude(void) const;
+        Eigen::Vector3d getVehicleVelocity(void) const;
+        Eigen::Vector3d getVehicleAngularVelocity(void) const;
+        const MotorArray& getMotorSpeed(void) const {return motorSpeed_;}
+        int getMotorsAmount(void) const {return numCopter_;}
+
+        void proceedState_ExplicitEuler(double dt_secs, const Eigen::Ref<const MotorArray> & motorSpeedCommand,
+                                        bool isCmdPercent = false);
+        void proceedState_RK4(double dt_secs, const Eigen::Ref<const MotorArray> & motorSpeedCommand,
+                              bool isCmdPercent = false);
+
+        void getIMUMeasurement(Eigen::Vector3d & accOutput, Eigen::Vector3d & gyroOutput);
+
+        /// @name IMU simulator
+        inertialMeasurementSim imu_ = inertialMeasurementSim(0.,0.,0.,0.);
+
+        /// Geodetic coordinates converter for GPS simulation
+        geodetic_converter::GeodeticConverter geodetic_converter_;
+
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    private:
+        /// @name  Number of rotors
+        int numCopter_;
+
+        /// @name Motor properties
+        //@{
+
+        /* Motor frame must have prop spinning around z-axis such that
+         a positive motor speed corresponds to a positive thrust in
+         positive motor z-axis direction. Only the z-axis of a motor frame in the vehicle
+         frame and its moment arm around the c.o.g. are needed, so they are stored column
+         per motor: thrustAxes_ = R.col(2), thrustMomentArms_ = t x R.col(2)*/
+        MotorAxes thrustAxes_;
+        MotorAxes thrustMomentArms_;
+
+        /* +1 if positive motor speed corresponds to positive moment around the motor frame z-axis
+           -1 if positive motor speed corresponds to negative moment around the motor frame z-axis
+           i.e. -1 indicates a positive motor speed corresponds to a positive rotation rate around the motor z-axis
+        */
+        MotorArray motorDirection_;
+
+        MotorArray thrustCoefficient_; // N/(rad/s)^2
+        MotorArray torqueCoefficient_; // Nm/(rad/s)^2
+        MotorArray motorTimeConstant_; // s
+        MotorArray motorRotationalInertia_; // kg m^2
+        MotorArray maxMotorSpeed_; // rad/s
+        MotorArray minMotorSpeed_; // rad/s
+        //@}
+
+        /// @name Vehicle properties
+        //@{
+        double dragCoefficient_; // N/(m/s)
+        Eigen::Matrix3d aeroMomentCoefficient_; // Nm/(rad/s)^2
+        double vehicleMass_; // kg
+        Eigen::Matrix3d vehicleInertia_; // kg m^2
+        Eigen::Matrix3d vehicleInertiaInverse_; // 1/(kg m^2)
+        double momentProcessNoiseAutoCorrelation_ = 0.; // (Nm)^2s
+        double forceProcessNoiseAutoCorrelation_ = 0.; // N^2s
+        //@}
+
+        /// @name Std normal RNG
+        //@{
+        std::default_random_engine randomNumberGenerator_;
+        std::normal_distribution<double> standardNormalDistribution_ = std::normal_distribution<double>(0.0,1.0);
+        //@}
+
+        // Default reference frame is NED, but can be set by changing gravity direction
+        /// @name Gravity vector
+        Eigen::Vector3d gravity_; // m/s^2
+
+        /// @name Vehicle state variables
+        //@{
+        MotorArray motorSpeed_; // rad/s
+        Eigen::Vector3d velocity_ = Eigen::Vector3d::Zero(); // m/s
+        Eigen::Vector3d position_ = Eigen::Vector3d::Zero(); // m
+        Eigen::Vector3d angularVelocity_ = Eigen::Vector3d::Zero(); // rad/s
+        Eigen::Quaterniond attitude_ = Eigen::Quaterniond::Identity();
+        Eigen::Quaterniond default_attitude_ = Eigen::Quaterniond::Identity();
+        //@}
+
+        /* Vehicle stochastic force vector (in world frame) is maintained
+        for accelerometer output, since it must include the same
+        random linear acceleration noise as used for dynamics integration*/
+        /// @name Vehicle stochastic force vector
+        Eigen::Vector3d stochForce_ = Eigen::Vector3d::Zero(); // N
+
+        /// @name Integration workspace, it is sized once in the constructor
+        //@{
+        MotorArray motorSpeedCommand_;
+        MotorArray motorSpeedAccumulated_;
+        MotorArray motorSpeedIntermediate_;
+        MotorArray motorSpeedDer_;
+        MotorArray motorThrust_;
+        MotorArray motorTorque_;
+        MotorArray motorAngularMomentum_;
+        //@}
+
+        void initMotors(int numCopter);
+        void boundMotorSpeedCommand(const Eigen::Ref<const MotorArray> & motorSpeedCommand, bool isCmdPercent);
+
+        Eigen::Vector3d getThrust(const MotorArray & motorSpeed);
+        Eigen::Vector3d getControlMoment(const MotorArray & motorSpeed,
+                                         const MotorArray & motorAcceleration);
+        Eigen::Vector3d getAeroMoment(const Eigen::Vector3d & angularVelocity) const;
+        Eigen::Vector3d getDragForce(const Eigen::Vector3d & velocity) const;
+        Eigen::Vector3d getVehicleSpecificForce(void);
+
+        void getMotorSpeedDerivative(MotorArray & motorSpeedDer,
+                                     const MotorArray & motorSpeed,
+                                     const MotorArray & motorSpeedCommand) const;
+        Eigen::Vector3d getVelocityDerivative(const Eigen::Quaterniond & attitude, const Eigen::Vector3d & stochForce,
+                                              const Eigen::Vector3d & velocity, const MotorArray & motorSpeed);
+        Eigen::Vector3d getAngularVelocityDerivative(const MotorArray & motorSpeed,
+                                                     const MotorArray & motorAcceleration,
+                                                     const Eigen::Vector3d & angularVelocity,
+                                                     const Eigen::Vector3d & stochMoment);
+        Eigen::Vector4d getAttitudeDerivative(const Eigen::Quaterniond & attitude,
+                                              const Eigen::Vector3d & angularVelocity) const;
+        Eigen::Vector3d getStochMoment(double dt_secs);
+        void updateStochForce(void);
+        void clampToGround(void);
+};
+
+extern template class MulticopterDynamics<Eigen::Dynamic>;
+extern template class MulticopterDynamics<4>;
+
+#endif // MULTICOPTERDYNAMICS_H
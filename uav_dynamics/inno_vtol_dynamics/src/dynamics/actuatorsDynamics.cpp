@@ -0,0 +1,99 @@
+/**
+ * @file actuatorsDynamics.cpp
+ * @brief Actuators dynamics implementation
+ */
+#include <cmath>
+#include <limits>
+#include "actuatorsDynamics.hpp"
+
+static const double INF = std::numeric_limits<double>::infinity();
+
+ActuatorsDynamics::ActuatorsDynamics(){
+    timeConstants_.setZero();
+    positionMin_.setConstant(-INF);
+    positionMax_.setConstant(INF);
+    rateMax_.setConstant(INF);
+    coefficientsDt_ = std::numeric_limits<double>::quiet_NaN();
+}
+
+void ActuatorsDynamics::setModel(Model_t model){
+    model_ = model;
+    coefficientsDt_ = std::numeric_limits<double>::quiet_NaN();
+}
+
+void ActuatorsDynamics::setTimeConstants(const ActuatorsArray& timeConstants){
+    timeConstants_ = timeConstants;
+    coefficientsDt_ = std::numeric_limits<double>::quiet_NaN();
+}
+
+void ActuatorsDynamics::setLimits(const ActuatorsArray& positionMin,
+                                  const ActuatorsArray& positionMax,
+                                  const ActuatorsArray& rateMax){
+    positionMin_ = positionMin;
+    positionMax_ = positionMax;
+    rateMax_ = rateMax.abs();
+}
+
+int8_t ActuatorsDynamics::parseModel(const std::string& modelName, Model_t& model){
+    if(modelName == "first_order"){
+        model = FIRST_ORDER;
+    }else if(modelName == "second_order"){
+        model = SECOND_ORDER;
+    }else{
+        return -1;
+    }
+    return 0;
+}
+
+void ActuatorsDynamics::process(ActuatorsState& state, const ActuatorsArray& cmd, double dtSecs){
+    if(dtSecs <= 0){
+        return;
+    }
+    double coefficientsDt = std::round(dtSecs / DT_QUANTUM) * DT_QUANTUM;
+    if(coefficientsDt != coefficientsDt_){
+        updateCoefficients(coefficientsDt);
+    }
+
+    ActuatorsArray error = state.position - cmd;
+    ActuatorsArray position;
+    ActuatorsArray rate;
+    if(model_ == FIRST_ORDER){
+        position = cmd + c11_ * error;
+    }else{
+        position = cmd + c11_ * error + c12_ * state.rate;
+        rate = c21_ * error + c22_ * state.rate;
+    }
+
+    ActuatorsArray maxDelta = rateMax_ * dtSecs;
+    position = state.position + (position - state.position).min(maxDelta).max(-maxDelta);
+    position = position.max(positionMin_).min(positionMax_);
+
+    if(model_ == FIRST_ORDER){
+        state.rate = (position - state.position) / dtSecs;
+    }else{
+        rate = rate.min(rateMax_).max(-rateMax_);
+        state.rate = ((position <= positionMin_ && rate < 0) ||
+                      (position >= positionMax_ && rate > 0)).select(0.0, rate);
+    }
+    state.position = position;
+}
+
+void ActuatorsDynamics::updateCoefficients(double dtSecs){
+    auto isIdeal = timeConstants_ <= 0;
+    ActuatorsArray omegaDt = dtSecs / timeConstants_;
+    ActuatorsArray decay = isIdeal.select(0.0, (-omegaDt).exp());
+
+    if(model_ == FIRST_ORDER){
+        c11_ = decay;
+        c12_.setZero();
+        c21_.setZero();
+        c22_.setZero();
+    }else{
+        c11_ = isIdeal.select(0.0, decay * (1 + omegaDt));
+        c12_ = isIdeal.select(0.0, decay * dtSecs);
+        c21_ = isIdeal.select(0.0, -decay * omegaDt / timeConstants_);
+        c22_ = isIdeal.select(0.0, decay * (1 - omegaDt));
+    }
+    coefficientsDt_ = dtSecs;
+    coefficientsUpdates_++;
+}
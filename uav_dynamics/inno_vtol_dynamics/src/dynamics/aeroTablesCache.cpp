@@ -0,0 +1,169 @@
+/**
+ * @file aeroTablesCache.cpp
+ * @brief Binary cache of the aerodynamic tables implementation
+ */
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "aeroTablesCache.hpp"
+
+constexpr uint32_t AeroTablesCache::VERSION;
+constexpr size_t AeroTablesCache::ALIGNMENT;
+constexpr uint64_t AeroTablesCache::FNV_OFFSET_BASIS;
+
+static const char MAGIC[8] = {'V', 'T', 'O', 'L', 'A', 'E', 'R', 'O'};
+static const char ACTUATOR_TIME_CONSTANTS_NAME[] = "actuatorTimeConstants";
+static const uint64_t FNV_PRIME = 1099511628211ULL;
+
+typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> RowMajorTable;
+
+static size_t alignUp(size_t value, size_t alignment){
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+uint64_t AeroTablesCache::calculateChecksum(const void* data, size_t size, uint64_t checksum){
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for(size_t idx = 0; idx < size; idx++){
+        checksum = (checksum ^ bytes[idx]) * FNV_PRIME;
+    }
+    return checksum;
+}
+
+uint64_t AeroTablesCache::calculateFileChecksum(const std::string& path){
+    std::ifstream file(path, std::ios::binary);
+    if(!file.is_open()){
+        return 0;
+    }
+    std::vector<char> content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return calculateChecksum(content.data(), content.size());
+}
+
+int8_t AeroTablesCache::save(const std::string& path, uint64_t sourceChecksum, const TablesWithCoeffs& tables){
+    std::vector<std::pair<std::string, RowMajorTable>> blocksData;
+    forEachTable(tables, [&](const char* name, const auto& table){
+        blocksData.emplace_back(name, table);
+    });
+    blocksData.emplace_back(ACTUATOR_TIME_CONSTANTS_NAME,
+                            Eigen::Map<const RowMajorTable>(tables.actuatorTimeConstants.data(),
+                                                            1, tables.actuatorTimeConstants.size()));
+
+    std::vector<Block> blocks(blocksData.size());
+    size_t offset = alignUp(sizeof(Header) + blocks.size() * sizeof(Block), ALIGNMENT);
+    for(size_t idx = 0; idx < blocks.size(); idx++){
+        memset(&blocks[idx], 0, sizeof(Block));
+        strncpy(blocks[idx].name, blocksData[idx].first.c_str(), sizeof(blocks[idx].name) - 1);
+        blocks[idx].rows = blocksData[idx].second.rows();
+        blocks[idx].cols = blocksData[idx].second.cols();
+        blocks[idx].offset = offset;
+        offset = alignUp(offset + blocksData[idx].second.size() * sizeof(double), ALIGNMENT);
+    }
+
+    std::vector<uint8_t> buffer(offset, 0);
+    memcpy(buffer.data() + sizeof(Header), blocks.data(), blocks.size() * sizeof(Block));
+    for(size_t idx = 0; idx < blocks.size(); idx++){
+        memcpy(buffer.data() + blocks[idx].offset,
+               blocksData[idx].second.data(),
+               blocksData[idx].second.size() * sizeof(double));
+    }
+
+    Header header;
+    memset(&header, 0, sizeof(Header));
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.blocksAmount = blocks.size();
+    header.fileSize = buffer.size();
+    header.sourceChecksum = sourceChecksum;
+    header.payloadChecksum = calculateChecksum(buffer.data() + sizeof(Header), buffer.size() - sizeof(Header));
+    memcpy(buffer.data(), &header, sizeof(Header));
+
+    std::string tmpPath = path + ".tmp" + std::to_string(getpid());
+    std::ofstream file(tmpPath, std::ios::binary);
+    if(!file.is_open()){
+        std::cerr << "AeroTablesCache: can't create " << tmpPath << std::endl;
+        return -1;
+    }
+    file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+    file.close();
+    if(!file || std::rename(tmpPath.c_str(), path.c_str()) != 0){
+        std::cerr << "AeroTablesCache: can't write " << path << std::endl;
+        std::remove(tmpPath.c_str());
+        return -1;
+    }
+    return 0;
+}
+
+int8_t AeroTablesCache::load(const std::string& path, uint64_t sourceChecksum, TablesWithCoeffs& tables){
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0){
+        return -1;
+    }
+    struct stat fileStat;
+    if(fstat(fd, &fileStat) != 0 || static_cast<size_t>(fileStat.st_size) < sizeof(Header)){
+        ::close(fd);
+        return -1;
+    }
+    const size_t fileSize = fileStat.st_size;
+    void* mapped = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if(mapped == MAP_FAILED){
+        return -1;
+    }
+
+    const uint8_t* bytes = static_cast<const uint8_t*>(mapped);
+    const Header* header = static_cast<const Header*>(mapped);
+    const Block* blocks = reinterpret_cast<const Block*>(bytes + sizeof(Header));
+    bool isValid = memcmp(header->magic, MAGIC, sizeof(MAGIC)) == 0 &&
+                   header->version == VERSION &&
+                   header->fileSize == fileSize &&
+                   sizeof(Header) + header->blocksAmount * sizeof(Block) <= fileSize &&
+                   header->sourceChecksum == sourceChecksum &&
+                   header->payloadChecksum == calculateChecksum(bytes + sizeof(Header), fileSize - sizeof(Header));
+
+    auto findBlock = [&](const char* name, size_t rows, size_t cols) -> const double*{
+        for(uint32_t idx = 0; isValid && idx < header->blocksAmount; idx++){
+            const Block& block = blocks[idx];
+            if(strncmp(block.name, name, sizeof(block.name)) != 0){
+                continue;
+            }
+            if(block.rows != rows || block.cols != cols || block.offset % ALIGNMENT != 0 ||
+               block.offset + rows * cols * sizeof(double) > fileSize){
+                return nullptr;
+            }
+            return reinterpret_cast<const double*>(bytes + block.offset);
+        }
+        return nullptr;
+    };
+
+    TablesWithCoeffs loaded;
+    forEachTable(loaded, [&](const char* name, auto& table){
+        const double* data = findBlock(name, table.rows(), table.cols());
+        if(data == nullptr){
+            isValid = false;
+            return;
+        }
+        table = Eigen::Map<const RowMajorTable>(data, table.rows(), table.cols());
+    });
+    if(isValid){
+        const size_t size = loaded.actuatorTimeConstants.size();
+        const double* data = findBlock(ACTUATOR_TIME_CONSTANTS_NAME, 1, size);
+        isValid = data != nullptr;
+        if(isValid){
+            std::copy(data, data + size, loaded.actuatorTimeConstants.begin());
+        }
+    }
+    munmap(mapped, fileSize);
+
+    if(!isValid){
+        std::cerr << "AeroTablesCache: " << path << " is corrupted or outdated" << std::endl;
+        return -1;
+    }
+    tables = loaded;
+    return 0;
+}
@@ -0,0 +1,186 @@
+/**
+ * @file airframeRegistry.cpp
+ * @brief Shared airframe tables registry implementation
+ */
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <new>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "airframeRegistry.hpp"
+#include "aeroTablesCache.hpp"
+
+static_assert(ATOMIC_INT_LOCK_FREE == 2, "The ready flag requires lock-free atomics in shared memory");
+
+constexpr double AirframeRegistry::ATTACH_TIMEOUT;
+
+static constexpr uint64_t SHARED_TABLES_MAGIC = 0x454D415246524941ULL;    // "AIRFRAME"
+static constexpr uint32_t SHARED_TABLES_VERSION = 2;
+static constexpr uint32_t SHARED_TABLES_READY = 1;
+
+/**
+ * @brief The tables hold no pointers, so the same object is valid in each process that maps
+ * the segment. The creator fills it and sets the ready flag last, the others wait for it.
+ */
+struct SharedTablesSegment{
+    uint64_t magic;
+    uint32_t version;
+    uint32_t tablesSize;                            // bytes, sizeof(TablesWithCoeffs)
+    uint64_t checksum;                              // of the tables, see AeroTablesCache
+    uint64_t sourceChecksum;                        // of the source yaml, 0 if it is unknown
+    std::atomic<uint32_t> state;
+    alignas(64) TablesWithCoeffs tables;
+};
+
+AirframeRegistry& AirframeRegistry::getInstance(){
+    static AirframeRegistry registry;
+    return registry;
+}
+
+AirframeRegistry::SharedTables AirframeRegistry::get(const std::string& name, const Loader& loader){
+    std::lock_guard<std::mutex> lock(mutex_);
+    SharedTables tables = entries_[name].lock();
+    if(tables == nullptr){
+        std::shared_ptr<TablesWithCoeffs> loaded(new TablesWithCoeffs());
+        loader(*loaded);
+        loadsAmount_++;
+        tables = loaded;
+        entries_[name] = tables;
+    }
+    return tables;
+}
+
+AirframeRegistry::SharedTables AirframeRegistry::getShared(const std::string& name,
+                                                          const Loader& loader,
+                                                          uint64_t sourceChecksum){
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto entry = sharedEntries_.find(name);
+    SharedTables tables;
+    if(entry != sharedEntries_.end() &&
+            (sourceChecksum == 0 || entry->second.sourceChecksum == sourceChecksum)){
+        tables = entry->second.tables.lock();
+    }
+    SharedStatus_t status = SHARED_ATTACHED;
+    if(tables == nullptr){
+        tables = attachShared(name, sourceChecksum, status);
+    }
+    if(status == SHARED_STALE){
+        // if another process has already replaced the object, the second copy is harmless
+        unlinkShared(name);
+        status = SHARED_NOT_FOUND;
+    }
+    if(tables == nullptr && status == SHARED_NOT_FOUND){
+        std::unique_ptr<TablesWithCoeffs> loaded(new TablesWithCoeffs());
+        loader(*loaded);
+        loadsAmount_++;
+        // it fails if another process has created the object first, its tables are used then
+        createShared(name, *loaded, sourceChecksum);
+        tables = attachShared(name, sourceChecksum, status);
+    }
+    if(tables != nullptr){
+        sharedEntries_[name] = SharedEntry{tables, sourceChecksum};
+    }
+    return tables;
+}
+
+int8_t AirframeRegistry::unlinkShared(const std::string& name){
+    return (shm_unlink(name.c_str()) == 0) ? 0 : -1;
+}
+
+size_t AirframeRegistry::getLoadsAmount() const{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return loadsAmount_;
+}
+
+void AirframeRegistry::setAttachTimeout(double timeoutSec){
+    std::lock_guard<std::mutex> lock(mutex_);
+    attachTimeout_ = timeoutSec;
+}
+
+int8_t AirframeRegistry::createShared(const std::string& name, const TablesWithCoeffs& tables,
+                                      uint64_t sourceChecksum){
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+    if(fd < 0){
+        return -1;
+    }
+    if(ftruncate(fd, sizeof(SharedTablesSegment)) != 0){
+        ::close(fd);
+        shm_unlink(name.c_str());
+        return -1;
+    }
+    void* mapped = mmap(nullptr, sizeof(SharedTablesSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if(mapped == MAP_FAILED){
+        shm_unlink(name.c_str());
+        return -1;
+    }
+
+    // the padding of the tables stays zero after ftruncate, so the checksum is reproducible
+    SharedTablesSegment* segment = new (mapped) SharedTablesSegment;
+    segment->tables = tables;
+    segment->magic = SHARED_TABLES_MAGIC;
+    segment->version = SHARED_TABLES_VERSION;
+    segment->tablesSize = sizeof(TablesWithCoeffs);
+    segment->checksum = AeroTablesCache::calculateChecksum(&segment->tables, sizeof(TablesWithCoeffs));
+    segment->sourceChecksum = sourceChecksum;
+    segment->state.store(SHARED_TABLES_READY, std::memory_order_release);
+    munmap(mapped, sizeof(SharedTablesSegment));
+    return 0;
+}
+
+AirframeRegistry::SharedTables AirframeRegistry::attachShared(const std::string& name,
+                                                             uint64_t sourceChecksum,
+                                                             SharedStatus_t& status) const{
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if(fd < 0){
+        status = (errno == ENOENT) ? SHARED_NOT_FOUND : SHARED_ERROR;
+        return nullptr;
+    }
+
+    // the creator may still be sizing and filling the object, or it may have died doing it
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(attachTimeout_);
+    const SharedTablesSegment* segment = nullptr;
+    bool isReady = false;
+    while(!isReady && std::chrono::steady_clock::now() < deadline){
+        struct stat fileStat;
+        if(segment == nullptr && fstat(fd, &fileStat) == 0 &&
+                static_cast<size_t>(fileStat.st_size) >= sizeof(SharedTablesSegment)){
+            void* mapped = mmap(nullptr, sizeof(SharedTablesSegment), PROT_READ, MAP_SHARED, fd, 0);
+            if(mapped == MAP_FAILED){
+                ::close(fd);
+                status = SHARED_ERROR;
+                return nullptr;
+            }
+            segment = static_cast<const SharedTablesSegment*>(mapped);
+        }
+        isReady = segment != nullptr && segment->state.load(std::memory_order_acquire) == SHARED_TABLES_READY;
+        if(!isReady){
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    ::close(fd);
+
+    if(!isReady ||
+       segment->magic != SHARED_TABLES_MAGIC ||
+       segment->version != SHARED_TABLES_VERSION ||
+       segment->tablesSize != sizeof(TablesWithCoeffs) ||
+       (sourceChecksum != 0 && segment->sourceChecksum != sourceChecksum) ||
+       segment->checksum != AeroTablesCache::calculateChecksum(&segment->tables, sizeof(TablesWithCoeffs))){
+        std::cerr << "AirframeRegistry: " << name << " is not ready or it is of another source or layout, "
+                  << "it is created again" << std::endl;
+        if(segment != nullptr){
+            munmap(const_cast<SharedTablesSegment*>(segment), sizeof(SharedTablesSegment));
+        }
+        status = SHARED_STALE;
+        return nullptr;
+    }
+    status = SHARED_ATTACHED;
+    return SharedTables(&segment->tables, [segment](const TablesWithCoeffs*){
+        munmap(const_cast<SharedTablesSegment*>(segment), sizeof(SharedTablesSegment));
+    });
+}
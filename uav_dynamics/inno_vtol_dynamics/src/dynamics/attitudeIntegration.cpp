@@ -0,0 +1,90 @@
+/**
+ * @file attitudeIntegration.cpp
+ * @brief Geometric integrators of the attitude quaternion implementation
+ */
+#include <cmath>
+#include "attitudeIntegration.hpp"
+
+namespace AttitudeIntegration
+{
+
+/**
+ * @note Crouch-Grossman 3rd order coefficients, P.E. Crouch, R. Grossman, "Numerical
+ * integration of ordinary differential equations on manifolds", 1993
+ */
+static const double CG_A21 = 3.0 / 4.0;
+static const double CG_A31 = 119.0 / 216.0;
+static const double CG_A32 = 17.0 / 108.0;
+static const double CG_B1 = 13.0 / 51.0;
+static const double CG_B2 = -2.0 / 3.0;
+static const double CG_B3 = 24.0 / 17.0;
+
+int8_t parseMethod(const std::string& methodName, Method_t& method){
+    if(methodName == "exponential"){
+        method = EXPONENTIAL;
+    }else if(methodName == "crouch_grossman"){
+        method = CROUCH_GROSSMAN;
+    }else{
+        return -1;
+    }
+    return 0;
+}
+
+template<typename Scalar>
+Eigen::Quaternion<Scalar> expMap(const Eigen::Matrix<Scalar, 3, 1>& rotationVector){
+    Scalar halfAngle = Scalar(0.5) * rotationVector.norm();
+    Scalar sinc;
+    if(halfAngle < Scalar(1e-4)){
+        sinc = Scalar(0.5) * (Scalar(1) - halfAngle * halfAngle / Scalar(6));
+    }else{
+        sinc = Scalar(0.5) * std::sin(halfAngle) / halfAngle;
+    }
+    Eigen::Quaternion<Scalar> quaternion;
+    quaternion.w() = std::cos(halfAngle);
+    quaternion.vec() = sinc * rotationVector;
+    return quaternion;
+}
+
+template<typename Scalar>
+void integrateAttitude(Eigen::Quaternion<Scalar>& attitude,
+                       const Eigen::Matrix<Scalar, 3, 1>& angularVel,
+                       Scalar dtSecs){
+    attitude = attitude * expMap<Scalar>(angularVel * dtSecs);
+    attitude.normalize();
+}
+
+template Eigen::Quaternion<float> expMap(const Eigen::Matrix<float, 3, 1>&);
+template Eigen::Quaternion<double> expMap(const Eigen::Matrix<double, 3, 1>&);
+template void integrateAttitude(Eigen::Quaternion<float>&, const Eigen::Matrix<float, 3, 1>&, float);
+template void integrateAttitude(Eigen::Quaternion<double>&, const Eigen::Matrix<double, 3, 1>&, double);
+
+static Eigen::Vector3d calculateAngularAccel(const Eigen::Vector3d& angularVel,
+                                             const Eigen::Matrix3d& inertia,
+                                             const Eigen::Matrix3d& inertiaInverse,
+                                             const Eigen::Vector3d& moment){
+    return inertiaInverse * (moment - angularVel.cross(inertia * angularVel));
+}
+
+void integrateRigidBody(Eigen::Quaterniond& attitude,
+                        Eigen::Vector3d& angularVel,
+                        const Eigen::Matrix3d& inertia,
+                        const Eigen::Matrix3d& inertiaInverse,
+                        const Eigen::Vector3d& moment,
+                        double dtSecs){
+    const Eigen::Vector3d& w1 = angularVel;
+    Eigen::Vector3d k1 = calculateAngularAccel(w1, inertia, inertiaInverse, moment);
+
+    Eigen::Vector3d w2 = w1 + dtSecs * CG_A21 * k1;
+    Eigen::Vector3d k2 = calculateAngularAccel(w2, inertia, inertiaInverse, moment);
+
+    Eigen::Vector3d w3 = w1 + dtSecs * (CG_A31 * k1 + CG_A32 * k2);
+    Eigen::Vector3d k3 = calculateAngularAccel(w3, inertia, inertiaInverse, moment);
+
+    attitude = attitude * expMap<double>(dtSecs * CG_B1 * w1) *
+                          expMap<double>(dtSecs * CG_B2 * w2) *
+                          expMap<double>(dtSecs * CG_B3 * w3);
+    attitude.normalize();
+    angularVel += dtSecs * (CG_B1 * k1 + CG_B2 * k2 + CG_B3 * k3);
+}
+
+}  // namespace AttitudeIntegration
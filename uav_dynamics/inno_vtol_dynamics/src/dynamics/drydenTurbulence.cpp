@@ -0,0 +1,160 @@
+/**
+ * @file drydenTurbulence.cpp
+ * @brief Dryden turbulence model implementation
+ */
+#include <cmath>
+#include <algorithm>
+#include <boost/algorithm/clamp.hpp>
+#include "drydenTurbulence.hpp"
+
+constexpr double DrydenTurbulence::DEFAULT_SAMPLE_PERIOD;
+constexpr double DrydenTurbulence::AIRSPEED_BUCKET_MIN;
+constexpr double DrydenTurbulence::AIRSPEED_BUCKET_STEP;
+constexpr size_t DrydenTurbulence::AIRSPEED_BUCKETS_AMOUNT;
+constexpr double DrydenTurbulence::ALTITUDE_BUCKET_MIN;
+constexpr double DrydenTurbulence::ALTITUDE_BUCKET_STEP;
+constexpr size_t DrydenTurbulence::ALTITUDE_BUCKETS_AMOUNT;
+
+static const double FEET_TO_METERS = 0.3048;
+static const double LOW_ALTITUDE_MAX = 304.8;       // m, 1000 ft
+static const size_t MAX_TICKS_PER_PROCESS = 100;
+
+void DrydenTurbulence::init(double windSpeedAt6m, double samplePeriod){
+    windSpeedAt6m_ = std::max(windSpeedAt6m, 0.0);
+    samplePeriod_ = samplePeriod;
+    buckets_.clear();
+    if(!isEnabled()){
+        return;
+    }
+
+    buckets_.resize(AIRSPEED_BUCKETS_AMOUNT * ALTITUDE_BUCKETS_AMOUNT);
+    for(size_t altIdx = 0; altIdx < ALTITUDE_BUCKETS_AMOUNT; altIdx++){
+        double altitude = ALTITUDE_BUCKET_MIN + altIdx * ALTITUDE_BUCKET_STEP;
+        for(size_t speedIdx = 0; speedIdx < AIRSPEED_BUCKETS_AMOUNT; speedIdx++){
+            double airspeed = AIRSPEED_BUCKET_MIN + speedIdx * AIRSPEED_BUCKET_STEP;
+            calculateBucket(airspeed, altitude, buckets_[altIdx * AIRSPEED_BUCKETS_AMOUNT + speedIdx]);
+        }
+    }
+}
+
+bool DrydenTurbulence::isEnabled() const{
+    return windSpeedAt6m_ > 0 && samplePeriod_ > 0;
+}
+
+void DrydenTurbulence::seed(DrydenFilterState& state, uint32_t seed){
+    state = DrydenFilterState();
+    state.generator.seed(seed);
+}
+
+uint32_t DrydenTurbulence::randomSeed(){
+    std::random_device randomDevice;
+    return randomDevice();
+}
+
+const Eigen::Vector3d& DrydenTurbulence::process(DrydenFilterState& state,
+                                                 double dtSecs,
+                                                 double airspeed,
+                                                 double altitude) const{
+    if(!isEnabled()){
+        state.gust.setZero();
+        return state.gust;
+    }
+
+    const BucketCoeffs& coeffs = findBucket(airspeed, altitude);
+    state.timeAccumulator += dtSecs;
+    size_t ticks = 0;
+    while(state.timeAccumulator >= samplePeriod_ && ticks < MAX_TICKS_PER_PROCESS){
+        tick(coeffs, state);
+        state.timeAccumulator -= samplePeriod_;
+        ticks++;
+    }
+    if(ticks == MAX_TICKS_PER_PROCESS){
+        state.timeAccumulator = 0;
+    }
+    return state.gust;
+}
+
+void DrydenTurbulence::processBatch(DrydenFilterState* states,
+                                    const double* airspeeds,
+                                    const double* altitudes,
+                                    size_t numberOfVehicles,
+                                    double dtSecs) const{
+    for(size_t idx = 0; idx < numberOfVehicles; idx++){
+        process(states[idx], dtSecs, airspeeds[idx], altitudes[idx]);
+    }
+}
+
+/**
+ * @brief Scale lengths and intensities are taken from MIL-F-8785C low altitude model,
+ * where the formulas are given in feet
+ */
+void DrydenTurbulence::calculateBucket(double airspeed, double altitude, BucketCoeffs& coeffs) const{
+    double altitudeFt = boost::algorithm::clamp(altitude, ALTITUDE_BUCKET_MIN, LOW_ALTITUDE_MAX) / FEET_TO_METERS;
+    double denominator = 0.177 + 0.000823 * altitudeFt;
+    double Lw = altitudeFt * FEET_TO_METERS;
+    double Lu = altitudeFt / std::pow(denominator, 1.2) * FEET_TO_METERS;
+    double sigmaW = 0.1 * windSpeedAt6m_;
+    double sigmaU = sigmaW / std::pow(denominator, 0.4);
+
+    double a = std::exp(-samplePeriod_ * airspeed / Lu);
+    coeffs.uA = a;
+    coeffs.uB = sigmaU * std::sqrt(1 - a * a);
+    calculateSecondOrderFilter(Lu, sigmaU, airspeed, coeffs.vA, coeffs.vL, coeffs.vC);
+    calculateSecondOrderFilter(Lw, sigmaW, airspeed, coeffs.wA, coeffs.wL, coeffs.wC);
+}
+
+/**
+ * @brief Continuous filter is x' = [0 1; -alpha^2 -2alpha] x + [0; 1] n, y = C x with
+ * alpha = V / L. The transition matrix and the Cholesky factor of the discrete process
+ * noise covariance are exact for the sample period, so the output variance does not
+ * depend on it.
+ */
+void DrydenTurbulence::calculateSecondOrderFilter(double scaleLength,
+                                                  double sigma,
+                                                  double airspeed,
+                                                  Eigen::Matrix2d& A,
+                                                  Eigen::Matrix2d& L,
+                                                  Eigen::RowVector2d& C) const{
+    const double alpha = airspeed / scaleLength;
+    const double dt = samplePeriod_;
+    A << 1 + alpha * dt,         dt,
+         -alpha * alpha * dt,    1 - alpha * dt;
+    A *= std::exp(-alpha * dt);
+
+    Eigen::Matrix2d stationaryCov;
+    stationaryCov << 1 / (4 * alpha * alpha * alpha),   0,
+                     0,                                 1 / (4 * alpha);
+    Eigen::Matrix2d Q = stationaryCov - A * stationaryCov * A.transpose();
+
+    L.setZero();
+    L(0, 0) = std::sqrt(std::max(Q(0, 0), 0.0));
+    if(L(0, 0) > 0){
+        L(1, 0) = Q(1, 0) / L(0, 0);
+    }
+    L(1, 1) = std::sqrt(std::max(Q(1, 1) - L(1, 0) * L(1, 0), 0.0));
+
+    const double gain = sigma / std::sqrt(alpha);
+    C << gain * alpha * alpha, gain * std::sqrt(3.0) * alpha;
+}
+
+const DrydenTurbulence::BucketCoeffs& DrydenTurbulence::findBucket(double airspeed,
+                                                                   double altitude) const{
+    double speedIdx = std::round((airspeed - AIRSPEED_BUCKET_MIN) / AIRSPEED_BUCKET_STEP);
+    double altIdx = std::round((altitude - ALTITUDE_BUCKET_MIN) / ALTITUDE_BUCKET_STEP);
+    speedIdx = boost::algorithm::clamp(speedIdx, 0.0, AIRSPEED_BUCKETS_AMOUNT - 1.0);
+    altIdx = boost::algorithm::clamp(altIdx, 0.0, ALTITUDE_BUCKETS_AMOUNT - 1.0);
+    return buckets_[static_cast<size_t>(altIdx) * AIRSPEED_BUCKETS_AMOUNT + static_cast<size_t>(speedIdx)];
+}
+
+void DrydenTurbulence::tick(const BucketCoeffs& coeffs, DrydenFilterState& state) const{
+    double noise[5];
+    for(size_t idx = 0; idx < 5; idx++){
+        noise[idx] = state.distribution(state.generator);
+    }
+
+    state.u = coeffs.uA * state.u + coeffs.uB * noise[0];
+    state.v = coeffs.vA * state.v + coeffs.vL * Eigen::Vector2d(noise[1], noise[2]);
+    state.w = coeffs.wA * state.w + coeffs.wL * Eigen::Vector2d(noise[3], noise[4]);
+
+    state.gust << state.u, coeffs.vC * state.v, coeffs.wC * state.w;
+}
@@ -4,16 +4,16 @@
  */
 
 #include <iostream>
-#include <ros/ros.h>
-#include <geometry_msgs/TransformStamped.h>
+#include <algorithm>
 
 #include "flightgogglesDynamicsSim.hpp"
 
 
 static const std::string MULTICOPTER_PARAMS_NS = "/uav/multicopter_params/";
-template <class T>
-static void getParameter(std::string name, T& parameter, T default_value, std::string unit=""){
-  if (!ros::param::get(MULTICOPTER_PARAMS_NS + name, parameter)){
+constexpr uint8_t FlightgogglesDynamics::PX4_MOTORS_INDEXES[4];
+static void getParameter(const ParamsSource& source, std::string name, double& parameter,
+                         double default_value, std::string unit=""){
+  if (!source.get(MULTICOPTER_PARAMS_NS + name, parameter)){
     std::cout << "Did not get "
               << name
               << " from the params, defaulting to "
@@ -29,32 +29,32 @@ FlightgogglesDynamics::FlightgogglesDynamics(){
 
 }
 
-int8_t FlightgogglesDynamics::init(){
+int8_t FlightgogglesDynamics::init(const ParamsSource& source){
     // Vehicle parameters
     double vehicleMass, motorTimeconstant, motorRotationalInertia,
             thrustCoeff, torqueCoeff, dragCoeff;
-    getParameter("vehicle_mass",              vehicleMass,                1.,       "kg");
-    getParameter("motor_time_constant",       motorTimeconstant,          0.02,     "sec");
-    getParameter("motor_rotational_inertia",  motorRotationalInertia,     6.62e-6,  "kg m^2");
-    getParameter("thrust_coefficient",        thrustCoeff,                1.91e-6,  "N/(rad/s)^2");
-    getParameter("torque_coefficient",        torqueCoeff,                2.6e-7,   "Nm/(rad/s)^2");
-    getParameter("drag_coefficient",          dragCoeff,                  0.1,      "N/(m/s)");
+    getParameter(source, "vehicle_mass",              vehicleMass,                1.,       "kg");
+    getParameter(source, "motor_time_constant",       motorTimeconstant,          0.02,     "sec");
+    getParameter(source, "motor_rotational_inertia",  motorRotationalInertia,     6.62e-6,  "kg m^2");
+    getParameter(source, "thrust_coefficient",        thrustCoeff,                1.91e-6,  "N/(rad/s)^2");
+    getParameter(source, "torque_coefficient",        torqueCoeff,                2.6e-7,   "Nm/(rad/s)^2");
+    getParameter(source, "drag_coefficient",          dragCoeff,                  0.1,      "N/(m/s)");
 
     Eigen::Matrix3d aeroMomentCoefficient = Eigen::Matrix3d::Zero();
-    getParameter("aeromoment_coefficient_xx", aeroMomentCoefficient(0,0), 0.003,    "Nm/(rad/s)^2");
-    getParameter("aeromoment_coefficient_yy", aeroMomentCoefficient(1,1), 0.003,    "Nm/(rad/s)^2");
-    getParameter("aeromoment_coefficient_zz", aeroMomentCoefficient(2,2), 0.003,    "Nm/(rad/s)^2");
+    getParameter(source, "aeromoment_coefficient_xx", aeroMomentCoefficient(0,0), 0.003,    "Nm/(rad/s)^2");
+    getParameter(source, "aeromoment_coefficient_yy", aeroMomentCoefficient(1,1), 0.003,    "Nm/(rad/s)^2");
+    getParameter(source, "aeromoment_coefficient_zz", aeroMomentCoefficient(2,2), 0.003,    "Nm/(rad/s)^2");
 
     Eigen::Matrix3d vehicleInertia = Eigen::Matrix3d::Zero();
-    getParameter("vehicle_inertia_xx",        vehicleInertia(0,0),        0.0049,   "kg m^2");
-    getParameter("vehicle_inertia_yy",        vehicleInertia(1,1),        0.0049,   "kg m^2");
-    getParameter("vehicle_inertia_zz",        vehicleInertia(2,2),        0.0069,   "kg m^2");
+    getParameter(source, "vehicle_inertia_xx",        vehicleInertia(0,0),        0.0049,   "kg m^2");
+    getParameter(source, "vehicle_inertia_yy",        vehicleInertia(1,1),        0.0049,   "kg m^2");
+    getParameter(source, "vehicle_inertia_zz",        vehicleInertia(2,2),        0.0069,   "kg m^2");
     
     double minPropSpeed, maxPropSpeed, momentProcessNoiseAutoCorrelation, forceProcessNoiseAutoCorrelation;
     minPropSpeed = 0.0;
-    getParameter("max_prop_speed",            maxPropSpeed,               2200.0,   "rad/s");
-    getParameter("moment_process_noise",momentProcessNoiseAutoCorrelation,1.25e-7,  "(Nm)^2 s");
-    getParameter("force_process_noise", forceProcessNoiseAutoCorrelation, 0.0005,   "N^2 s");
+    getParameter(source, "max_prop_speed",            maxPropSpeed,               2200.0,   "rad/s");
+    getParameter(source, "moment_process_noise",momentProcessNoiseAutoCorrelation,1.25e-7,  "(Nm)^2 s");
+    getParameter(source, "force_process_noise", forceProcessNoiseAutoCorrelation, 0.0005,   "N^2 s");
 
 
     // Set gravity vector according to ROS reference axis system, see header file
@@ -62,7 +62,7 @@ int8_t FlightgogglesDynamics::init(){
 
 
     // Create quadcopter simulator
-    multicopterSim_ = new MulticopterDynamicsSim(4, thrustCoeff, torqueCoeff,
+    multicopterSim_ = new QuadcopterDynamics(4, thrustCoeff, torqueCoeff,
                         minPropSpeed, maxPropSpeed, motorTimeconstant, motorRotationalInertia,
                         vehicleMass, vehicleInertia,
                         aeroMomentCoefficient, dragCoeff, momentProcessNoiseAutoCorrelation,
@@ -76,25 +76,52 @@ int8_t FlightgogglesDynamics::init(){
     double accBiasProcessNoiseAutoCorrelation, gyroBiasProcessNoiseAutoCorrelation,
            accBiasInitVar, gyroBiasInitVar,
            accMeasNoiseVariance, gyroMeasNoiseVariance;
-    getParameter("accelerometer_biasprocess", accBiasProcessNoiseAutoCorrelation, 1.0e-7, "m^2/s^5");
-    getParameter("gyroscope_biasprocess",     accBiasProcessNoiseAutoCorrelation, 1.0e-7, "rad^2/s^3");
-    getParameter("accelerometer_biasinitvar", accBiasInitVar,                     0.005,  "(m/s^2)^2");
-    getParameter("gyroscope_biasinitvar",     gyroBiasInitVar,                    0.003,  "(rad/s)^2");
-    getParameter("accelerometer_variance",    accMeasNoiseVariance,               0.005,  "m^2/s^4");
-    getParameter("gyroscope_variance",        gyroMeasNoiseVariance,              0.003,  "rad^2/s^2");
+    getParameter(source, "accelerometer_biasprocess", accBiasProcessNoiseAutoCorrelation, 1.0e-7, "m^2/s^5");
+    getParameter(source, "gyroscope_biasprocess",     accBiasProcessNoiseAutoCorrelation, 1.0e-7, "rad^2/s^3");
+    getParameter(source, "accelerometer_biasinitvar", accBiasInitVar,                     0.005,  "(m/s^2)^2");
+    getParameter(source, "gyroscope_biasinitvar",     gyroBiasInitVar,                    0.003,  "(rad/s)^2");
+    getParameter(source, "accelerometer_variance",    accMeasNoiseVariance,               0.005,  "m^2/s^4");
+    getParameter(source, "gyroscope_variance",        gyroMeasNoiseVariance,              0.003,  "rad^2/s^2");
     multicopterSim_->imu_.setBias(accBiasInitVar, gyroBiasInitVar,
                                   accBiasProcessNoiseAutoCorrelation, gyroBiasProcessNoiseAutoCorrelation);
     multicopterSim_->imu_.setNoiseVariance(accMeasNoiseVariance, gyroMeasNoiseVariance);
 
-    initStaticMotorTransform();
+    initStaticMotorTransform(source);
 
+    return initIntegrationPolicy(source);
+}
+
+int8_t FlightgogglesDynamics::initIntegrationPolicy(const ParamsSource& source){
+    std::string integrationMethod;
+    if(!source.get(MULTICOPTER_PARAMS_NS + "integration_method", integrationMethod)){
+        integrationMethod = "euler";
+    }
+    double substepsAmount;
+    getParameter(source, "integration_substeps", substepsAmount, 1);
+
+    if(substepsAmount < 1){
+        std::cerr << "FlightgogglesDynamics: integration_substeps should be positive." << std::endl;
+        return -1;
+    }else if(integrationMethod == "euler"){
+        setIntegrationPolicy(INTEGRATION_EULER, substepsAmount);
+    }else if(integrationMethod == "rk4"){
+        setIntegrationPolicy(INTEGRATION_RK4, substepsAmount);
+    }else{
+        std::cerr << "FlightgogglesDynamics: unknown integration_method " << integrationMethod << std::endl;
+        return -1;
+    }
     return 0;
 }
 
-void FlightgogglesDynamics::initStaticMotorTransform(){	
+void FlightgogglesDynamics::setIntegrationPolicy(IntegrationMethod_t integrationMethod, size_t substepsAmount){
+    integrationMethod_ = integrationMethod;
+    substepsAmount_ = std::max<size_t>(substepsAmount, 1);
+}
+
+void FlightgogglesDynamics::initStaticMotorTransform(const ParamsSource& source){	
     Eigen::Isometry3d motorFrame = Eigen::Isometry3d::Identity();	
     double momentArm;	
-    getParameter("moment_arm",                momentArm,                  0.08,     "m");	
+    getParameter(source, "moment_arm",                momentArm,                  0.08,     "m");	
 
     motorFrame.translation() = Eigen::Vector3d(momentArm, momentArm, 0.);	
     multicopterSim_->setMotorFrame(motorFrame, 1, 0);	
@@ -117,8 +144,15 @@ void FlightgogglesDynamics::setInitialPosition(const Eigen::Vector3d & position,
 void FlightgogglesDynamics::process(double dt_secs,
                                     const std::vector<double> & motorSpeedCommandIn,
                                     bool isCmdPercent){
-    auto actuators = mapCmdActuator(motorSpeedCommandIn);
-    multicopterSim_->proceedState_ExplicitEuler(dt_secs, actuators, isCmdPercent);
+    mapCmdActuator(motorSpeedCommandIn, mappedCmd_);
+    double substepDt = dt_secs / substepsAmount_;
+    for(size_t substep = 0; substep < substepsAmount_; substep++){
+        if(integrationMethod_ == INTEGRATION_RK4){
+            multicopterSim_->proceedState_RK4(substepDt, mappedCmd_, isCmdPercent);
+        }else{
+            multicopterSim_->proceedState_ExplicitEuler(substepDt, mappedCmd_, isCmdPercent);
+        }
+    }
 }
 
 Eigen::Vector3d FlightgogglesDynamics::getVehiclePosition() const{
@@ -137,11 +171,8 @@ void FlightgogglesDynamics::getIMUMeasurement(Eigen::Vector3d & accOutput, Eigen
     return multicopterSim_->getIMUMeasurement(accOutput, gyroOutput);
 }
 
-std::vector<double> FlightgogglesDynamics::mapCmdActuator(std::vector<double> initialCmd) const{
-    std::vector<double> mappedCmd;
-    mappedCmd.push_back(initialCmd[2]);     // PX4: motor 3, front left
-    mappedCmd.push_back(initialCmd[1]);     // PX4: motor 2, tail left
-    mappedCmd.push_back(initialCmd[3]);     // PX4: motor 4, tail right
-    mappedCmd.push_back(initialCmd[0]);     // PX4: motor 1, front right
-    return mappedCmd;
+void FlightgogglesDynamics::mapCmdActuator(const std::vector<double>& initialCmd, Eigen::Array4d& mappedCmd){
+    for(size_t idx = 0; idx < 4; idx++){
+        mappedCmd[idx] = initialCmd[PX4_MOTORS_INDEXES[idx]];
+    }
 }
@@ -0,0 +1,157 @@
+/**
+ * @file paramsSource.cpp
+ * @brief Yaml parameters source implementation
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cstdlib>
+#include "paramsSource.hpp"
+
+static std::string trim(const std::string& str){
+    const char* WHITESPACES = " \t\r\n";
+    size_t first = str.find_first_not_of(WHITESPACES);
+    if(first == std::string::npos){
+        return "";
+    }
+    return str.substr(first, str.find_last_not_of(WHITESPACES) - first + 1);
+}
+
+static std::string removeComment(const std::string& line){
+    char quote = 0;
+    for(size_t idx = 0; idx < line.size(); idx++){
+        if(quote != 0){
+            quote = line[idx] == quote ? 0 : quote;
+        }else if(line[idx] == '"' || line[idx] == '\''){
+            quote = line[idx];
+        }else if(line[idx] == '#'){
+            return line.substr(0, idx);
+        }
+    }
+    return line;
+}
+
+static bool parseNumber(const std::string& str, double& value){
+    char* end;
+    value = std::strtod(str.c_str(), &end);
+    return !str.empty() && *end == '\0';
+}
+
+int8_t YamlParamsSource::load(const std::string& path, const std::string& ns){
+    std::ifstream file(path);
+    if(!file.is_open()){
+        std::cerr << "YamlParamsSource: can't open " << path << std::endl;
+        return -1;
+    }
+    if(configDirectory_.empty()){
+        size_t slash = path.find_last_of('/');
+        configDirectory_ = slash == std::string::npos ? "." : path.substr(0, slash);
+    }
+
+    std::string line, key, list;
+    bool isListOpened = false;
+    size_t lineNumber = 0;
+    while(std::getline(file, line)){
+        lineNumber++;
+        line = removeComment(line);
+        if(isListOpened){
+            list += " " + line;
+        }else if(!trim(line).empty()){
+            size_t colon = line.find(':');
+            if(colon == std::string::npos || line[0] == ' ' || line[0] == '\t'){
+                std::cerr << "YamlParamsSource: unsupported line " << lineNumber << " in " << path << std::endl;
+                return -1;
+            }
+            key = trim(line.substr(0, colon));
+            std::string value = trim(line.substr(colon + 1));
+            if(value.empty() || value[0] != '['){
+                double number;
+                if(value == "true" || value == "false"){
+                    numbers_[ns + key] = {value == "true" ? 1.0 : 0.0};
+                }else if(parseNumber(value, number)){
+                    numbers_[ns + key] = {number};
+                }else{
+                    bool isQuoted = value.size() >= 2 && (value[0] == '"' || value[0] == '\'') &&
+                                    value.back() == value[0];
+                    strings_[ns + key] = isQuoted ? value.substr(1, value.size() - 2) : value;
+                }
+                continue;
+            }
+            list = value;
+        }else{
+            continue;
+        }
+
+        isListOpened = list.find(']') == std::string::npos;
+        if(!isListOpened){
+            std::string items = list.substr(1, list.find(']') - 1);
+            std::replace(items.begin(), items.end(), ',', ' ');
+            std::istringstream stream(items);
+            std::vector<double> numbers;
+            std::string item;
+            double number;
+            while(stream >> item){
+                if(!parseNumber(item, number)){
+                    std::cerr << "YamlParamsSource: wrong list " << key << " in " << path << std::endl;
+                    return -1;
+                }
+                numbers.push_back(number);
+            }
+            numbers_[ns + key] = numbers;
+        }
+    }
+    if(isListOpened){
+        std::cerr << "YamlParamsSource: list " << key << " is not closed in " << path << std::endl;
+        return -1;
+    }
+    return 0;
+}
+
+int8_t YamlParamsSource::loadPackageConfigs(const std::string& configDirectory){
+    configDirectory_ = configDirectory;
+    if(load(configDirectory + "/multicopter_params.yaml", "/uav/multicopter_params/") == -1 ||
+       load(configDirectory + "/sim_params.yaml", "/uav/sim_params/") == -1 ||
+       load(configDirectory + "/vtol_params.yaml", "/uav/vtol_params/") == -1 ||
+       load(configDirectory + "/aerodynamics_coeffs.yaml", "/uav/aerodynamics_coeffs/") == -1){
+        return -1;
+    }
+    set("/uav/vtol_params/aeroTablesPath", configDirectory + "/aerodynamics_coeffs.yaml");
+    return 0;
+}
+
+void YamlParamsSource::set(const std::string& name, const std::vector<double>& value){
+    numbers_[name] = value;
+}
+
+void YamlParamsSource::set(const std::string& name, const std::string& value){
+    strings_[name] = value;
+}
+
+bool YamlParamsSource::get(const std::string& name, double& value) const{
+    auto it = numbers_.find(name);
+    if(it == numbers_.end() || it->second.size() != 1){
+        return false;
+    }
+    value = it->second.front();
+    return true;
+}
+
+bool YamlParamsSource::get(const std::string& name, std::vector<double>& value) const{
+    auto it = numbers_.find(name);
+    if(it == numbers_.end()){
+        return false;
+    }
+    value = it->second;
+    return true;
+}
+
+bool YamlParamsSource::get(const std::string& name, std::string& value) const{
+    auto it = strings_.find(name);
+    if(it == strings_.end()){
+        return false;
+    }
+    value = it->second;
+    return true;
+}
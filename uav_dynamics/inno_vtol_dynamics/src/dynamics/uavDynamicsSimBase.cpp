@@ -7,4 +7,31 @@
 
 bool UavDynamicsSimBase::getMotorsRpm(std::vector<double>& motorsRpm) {
     return false;
-}
\ No newline at end of file
+}
+constexpr size_t UavDynamicsSimBase::STATE_SIZE;
+
+void UavDynamicsSimBase::stepN(double dt_secs,
+                               const double* commands,
+                               size_t commandsSize,
+                               size_t stepsAmount,
+                               double* states,
+                               bool isCmdPercent){
+    std::vector<double> command(commandsSize);
+    for(size_t step = 0; step < stepsAmount; step++){
+        command.assign(commands + step * commandsSize, commands + (step + 1) * commandsSize);
+        process(dt_secs, command, isCmdPercent);
+        getStateVector(states + step * STATE_SIZE);
+    }
+}
+
+void UavDynamicsSimBase::getStateVector(double* state) const{
+    Eigen::Quaterniond attitude = getVehicleAttitude();
+    Eigen::Map<Eigen::Vector3d> position(state), velocity(state + 3), angularVelocity(state + 10);
+    position = getVehiclePosition();
+    velocity = getVehicleVelocity();
+    state[6] = attitude.w();
+    state[7] = attitude.x();
+    state[8] = attitude.y();
+    state[9] = attitude.z();
+    angularVelocity = getVehicleAngularVelocity();
+}
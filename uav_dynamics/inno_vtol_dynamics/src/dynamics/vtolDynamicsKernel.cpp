@@ -0,0 +1,219 @@
+/**
+ * @file vtolDynamicsKernel.cpp
+ * @brief Scalar templated math of the vtol dynamics implementation
+ */
+#include <cmath>
+#include <numeric>
+#include "vtolDynamicsKernel.hpp"
+#include "vtolDynamicsSim.hpp"
+#include "attitudeIntegration.hpp"
+#include "vtolLinearization.hpp"
+
+static const double AIRSPEED_TABLE_LIMIT = 40.0;    // m/sec
+
+template<typename Scalar>
+constexpr size_t VtolDynamicsKernel<Scalar>::MOTORS_AMOUNT;
+template<typename Scalar>
+constexpr double VtolDynamicsKernel<Scalar>::PI;
+
+template<typename Scalar>
+void VtolDynamicsKernel<Scalar>::init(const VtolParameters& params, const TablesWithCoeffs& tables){
+    init(params, SharedTables(new TablesWithCoeffsT<Scalar>(tables)));
+}
+
+template<typename Scalar>
+void VtolDynamicsKernel<Scalar>::init(const VtolParameters& params, SharedTables tables){
+    tables_ = std::move(tables);
+    mass_ = params.mass;
+    gravity_ = params.gravity;
+    atmoRho_ = params.atmoRho;
+    wingArea_ = params.wingArea;
+    characteristicLength_ = params.characteristicLength;
+    inertia_ = params.inertia.template cast<Scalar>();
+    inertiaInverse_ = params.inertia.inverse().template cast<Scalar>();
+    for(size_t idx = 0; idx < MOTORS_AMOUNT; idx++){
+        propellersLocation_[idx] = params.propellersLocation[idx].template cast<Scalar>();
+    }
+}
+
+template<typename Scalar>
+Scalar VtolDynamicsKernel<Scalar>::calculateDynamicPressure(Scalar airSpeedMod) const{
+    return atmoRho_ * airSpeedMod * airSpeedMod * wingArea_;
+}
+
+/**
+ * @return AoA
+ * it must be [0, 3.14] if angle is [0, +180]
+ * it must be [0, -3.14] if angle is [0, -180]
+ */
+template<typename Scalar>
+Scalar VtolDynamicsKernel<Scalar>::calculateAnglesOfAtack(const Vector3& airSpeed){
+    using std::sqrt;
+    using std::asin;
+    Scalar A = sqrt(airSpeed[0] * airSpeed[0] + airSpeed[2] * airSpeed[2]);
+    if(A < Scalar(0.001)){
+        return 0;
+    }
+    A = clamp(airSpeed[2] / A, -1, +1);
+    A = (airSpeed[0] > 0) ? Scalar(asin(A)) : Scalar(PI - asin(A));
+    return (A > Scalar(PI)) ? A - Scalar(2 * PI) : A;
+}
+
+template<typename Scalar>
+Scalar VtolDynamicsKernel<Scalar>::calculateAnglesOfSideslip(const Vector3& airSpeed){
+    using std::asin;
+    Scalar B = airSpeed.norm();
+    if(B < Scalar(0.001)){
+        return 0;
+    }
+    B = clamp(airSpeed[1] / B, -1, +1);
+    return asin(B);
+}
+
+template<typename Scalar>
+void VtolDynamicsKernel<Scalar>::calculateAerodynamics(const Vector3& airspeed,
+                                                       Scalar AoA,
+                                                       Scalar AoS,
+                                                       Scalar aileron_pos,
+                                                       Scalar elevator_pos,
+                                                       Scalar rudder_pos,
+                                                       Vector3& Faero,
+                                                       Vector3& Maero,
+                                                       AeroComponents* components) const{
+    calculateAerodynamicsUsingTables(*tables_, airspeed, AoA, AoS, aileron_pos, elevator_pos, rudder_pos,
+                                     Faero, Maero, components);
+}
+
+template<typename Scalar>
+void VtolDynamicsKernel<Scalar>::thruster(Scalar actuator, Scalar& thrust, Scalar& torque, Scalar& rpm) const{
+    constexpr size_t CONTROL_IDX = 0;
+    constexpr size_t THRUST_IDX = 1;
+    constexpr size_t TORQUE_IDX = 2;
+    constexpr size_t RPM_IDX = 4;
+
+    size_t prev_idx = findRow(tables_->prop, actuator);
+    size_t next_idx = prev_idx + 1;
+    if(next_idx < static_cast<size_t>(tables_->prop.rows())){
+        auto prev_row = tables_->prop.row(prev_idx);
+        auto next_row = tables_->prop.row(next_idx);
+        Scalar t = (actuator - prev_row(CONTROL_IDX)) / (next_row(CONTROL_IDX) - prev_row(CONTROL_IDX));
+        thrust = lerp(prev_row(THRUST_IDX), next_row(THRUST_IDX), t);
+        torque = lerp(prev_row(TORQUE_IDX), next_row(TORQUE_IDX), t);
+        rpm = lerp(prev_row(RPM_IDX), next_row(RPM_IDX), t);
+    }
+}
+
+template<typename Scalar>
+void VtolDynamicsKernel<Scalar>::calculateMotors(const Scalar* actuators,
+                                                 std::array<Vector3, MOTORS_AMOUNT>& forces,
+                                                 std::array<Vector3, MOTORS_AMOUNT>& moments,
+                                                 std::array<Scalar, MOTORS_AMOUNT>& rpm) const{
+    std::array<Scalar, MOTORS_AMOUNT> thrust, torque;
+    thrust.fill(Scalar(0));
+    torque.fill(Scalar(0));
+    for(size_t idx = 0; idx < MOTORS_AMOUNT; idx++){
+        thruster(actuators[idx], thrust[idx], torque[idx], rpm[idx]);
+    }
+
+    for(size_t idx = 0; idx < 4; idx++){
+        forces[idx] << 0, 0, -thrust[idx];
+    }
+    forces[4] << thrust[4], 0, 0;
+
+    std::array<Vector3, MOTORS_AMOUNT> motorTorquesInBodyCS;
+    motorTorquesInBodyCS[0] << 0, 0, torque[0];
+    motorTorquesInBodyCS[1] << 0, 0, torque[1];
+    motorTorquesInBodyCS[2] << 0, 0, -torque[2];
+    motorTorquesInBodyCS[3] << 0, 0, -torque[3];
+    motorTorquesInBodyCS[4] << -torque[4], 0, 0;
+    for(size_t idx = 0; idx < MOTORS_AMOUNT; idx++){
+        moments[idx] = motorTorquesInBodyCS[idx] + propellersLocation_[idx].cross(forces[idx]);
+    }
+}
+
+template<typename Scalar>
+void VtolDynamicsKernel<Scalar>::calculateBodyForces(const RigidBodyState& state,
+                                                     const Actuators& actuators,
+                                                     Vector3& Fbody,
+                                                     Vector3& Mbody) const{
+    Matrix3 rotationMatrix = state.attitude.toRotationMatrix().transpose();
+    Vector3 airspeed = (rotationMatrix * state.linearVel).cwiseMax(Scalar(-AIRSPEED_TABLE_LIMIT))
+                                                         .cwiseMin(Scalar(AIRSPEED_TABLE_LIMIT));
+    Vector3 Faero, Maero;
+    calculateAerodynamics(airspeed, calculateAnglesOfAtack(airspeed), calculateAnglesOfSideslip(airspeed),
+                          actuators[5], actuators[6], actuators[7], Faero, Maero);
+
+    std::array<Vector3, MOTORS_AMOUNT> forces, moments;
+    std::array<Scalar, MOTORS_AMOUNT> rpm;
+    rpm.fill(Scalar(0));
+    calculateMotors(actuators.data(), forces, moments, rpm);
+    Mbody = std::accumulate(moments.begin(), moments.end(), Maero);
+    Fbody = std::accumulate(forces.begin(), forces.end(), Faero);
+}
+
+template<typename Scalar>
+void VtolDynamicsKernel<Scalar>::calculateDerivative(const RigidBodyState& state,
+                                                     const Actuators& actuators,
+                                                     Vector3& linearAccel,
+                                                     Vector3& angularAccel) const{
+    Vector3 Fbody, Mbody;
+    calculateBodyForces(state, actuators, Fbody, Mbody);
+    angularAccel = inertiaInverse_ * (Mbody - state.angularVel.cross(inertia_ * state.angularVel));
+    linearAccel = state.attitude.toRotationMatrix() * Fbody / mass_ + Vector3(Scalar(0), Scalar(0), gravity_);
+}
+
+template<typename Scalar>
+void VtolDynamicsKernel<Scalar>::step(RigidBodyState& state, const Actuators& actuators, Scalar dtSecs) const{
+    Vector3 Fbody, Mbody;
+    calculateBodyForces(state, actuators, Fbody, Mbody);
+
+    state.angularAccel = inertiaInverse_ * (Mbody - state.angularVel.cross(inertia_ * state.angularVel));
+    state.angularVel += state.angularAccel * dtSecs;
+    AttitudeIntegration::integrateAttitude<Scalar>(state.attitude, state.angularVel, dtSecs);
+
+    Matrix3 rotationMatrix = state.attitude.toRotationMatrix().transpose();
+    Vector3 Ftotal = Fbody + rotationMatrix * Vector3(0, 0, gravity_ * mass_);
+    state.linearAccel = rotationMatrix.transpose() * Ftotal / mass_;
+    state.linearVel += state.linearAccel * dtSecs;
+    state.position += state.linearVel * dtSecs;
+
+    if(state.position[2] >= 0){
+        state.position[2] = 0;
+        state.linearVel.setZero();
+        state.angularVel.setZero();
+    }
+}
+
+template<typename Scalar>
+Scalar VtolDynamicsKernel<Scalar>::calculateCSRudder(Scalar rudder_pos, Scalar airspeed) const{
+    return calculateCSRudder(*tables_, rudder_pos, airspeed);
+}
+template<typename Scalar>
+Scalar VtolDynamicsKernel<Scalar>::calculateCSBeta(Scalar AoS_deg, Scalar airspeed) const{
+    return calculateCSBeta(*tables_, AoS_deg, airspeed);
+}
+template<typename Scalar>
+Scalar VtolDynamicsKernel<Scalar>::calculateCmxAileron(Scalar aileron_pos, Scalar airspeed) const{
+    return calculateCmxAileron(*tables_, aileron_pos, airspeed);
+}
+template<typename Scalar>
+Scalar VtolDynamicsKernel<Scalar>::calculateCmyElevator(Scalar elevator_pos, Scalar airspeed) const{
+    return calculateCmyElevator(*tables_, elevator_pos, airspeed);
+}
+template<typename Scalar>
+Scalar VtolDynamicsKernel<Scalar>::calculateCmzRudder(Scalar rudder_pos, Scalar airspeed) const{
+    return calculateCmzRudder(*tables_, rudder_pos, airspeed);
+}
+
+template class VtolDynamicsKernel<double>;
+template class VtolDynamicsKernel<float>;
+
+/**
+ * @note Only the members used by VtolLinearization are instantiated for the automatic
+ * differentiation, the step would need the attitude integration for it too
+ */
+template void VtolDynamicsKernel<VtolAutoDiff>::init(const VtolParameters&, const TablesWithCoeffs&);
+template void VtolDynamicsKernel<VtolAutoDiff>::calculateDerivative(const RigidBodyState&,
+                                                                   const Actuators&,
+                                                                   Vector3&,
+                                                                   Vector3&) const;
@@ -8,7 +8,14 @@
 #include <boost/algorithm/clamp.hpp>
 #include <algorithm>
 #include "vtolDynamicsSim.hpp"
-#include <ros/package.h>
+#include "aeroTablesCache.hpp"
+#include "attitudeIntegration.hpp"
+#include "vtolModelReloader.hpp"
+#include "airframeRegistry.hpp"
+#ifdef INNO_VTOL_GENERATED_AERO_TABLES
+#include "innoVtolAirframe.hpp"
+#include "innoVtolAeroModel.hpp"
+#endif
 #include <array>
 #include "cs_converter.hpp"
 
@@ -22,26 +29,94 @@ InnoVtolDynamicsSim::InnoVtolDynamicsSim(): distribution_(0.0, 1.0){
     state_.linearVel.setZero();
     state_.windVelocity.setZero();
     state_.windVariance = 0;
+    state_.gustVelocity.setZero();
+    state_.windFieldTime = 0;
     state_.accelBias.setZero();
     state_.gyroBias.setZero();
     state_.Fspecific << 0, 0, -params_.gravity;
-    for(size_t idx = 0; idx < 8; idx++){
-        state_.prevActuators.push_back(0);
-        state_.crntActuators.push_back(0);
+    state_.Faero.setZero();
+    state_.Maero.setZero();
+    state_.FaeroHeld.setZero();
+    state_.MaeroHeld.setZero();
+    state_.FaeroRate.setZero();
+    state_.MaeroRate.setZero();
+    state_.aeroAge = std::numeric_limits<double>::infinity();
+}
+
+int8_t InnoVtolDynamicsSim::init(const ParamsSource& source){
+    const std::string VTOL_PARAMS_PATH = "/uav/vtol_params/";
+    const std::string TABLES_PATH = "/uav/aerodynamics_coeffs/";
+
+    ///< The caches are keyed by the yaml actually loaded into TABLES_PATH, it is unknown
+    ///< when aeroTablesPath is not set and then the file cache is not used
+    uint64_t sourceChecksum = 0;
+    std::string tablesCachePath, tablesSourcePath;
+#ifndef INNO_VTOL_GENERATED_AERO_TABLES
+    source.get(VTOL_PARAMS_PATH + "aeroTablesCachePath", tablesCachePath);
+    source.get(VTOL_PARAMS_PATH + "aeroTablesPath", tablesSourcePath);
+    if(!tablesSourcePath.empty()){
+        sourceChecksum = AeroTablesCache::calculateFileChecksum(tablesSourcePath);
     }
+#endif
+
+    auto loader = [&](TablesWithCoeffs& tables){
+#ifdef INNO_VTOL_GENERATED_AERO_TABLES
+        InnoVtolAeroModel<InnoVtolAirframe>::loadTables(tables);
+#else
+        if(tablesCachePath.empty() || sourceChecksum == 0){
+            loadTables(source, TABLES_PATH, tables);
+        }else{
+            if(AeroTablesCache::load(tablesCachePath, sourceChecksum, tables) != 0){
+                loadTables(source, TABLES_PATH, tables);
+                AeroTablesCache::save(tablesCachePath, sourceChecksum, tables);
+            }
+        }
+#endif
+    };
+
+    // "/name" is a POSIX shared memory object shared by the processes, other names are in-process
+    VtolDynamicsKernel<double>::SharedTables tables;
+    std::string airframeName;
+    source.get(VTOL_PARAMS_PATH + "airframeName", airframeName);
+    if(!airframeName.empty() && airframeName[0] == '/'){
+        tables = AirframeRegistry::getInstance().getShared(airframeName, loader, sourceChecksum);
+    }else if(!airframeName.empty()){
+        tables = AirframeRegistry::getInstance().get(airframeName, loader);
+    }
+    if(tables == nullptr){
+        std::shared_ptr<TablesWithCoeffs> loaded(new TablesWithCoeffs());
+        loader(*loaded);
+        tables = loaded;
+    }
+
+    VtolParameters params = params_;
+    loadParams(source, VTOL_PARAMS_PATH, params);
+    return init(params, std::move(tables));
+}
+
+int8_t InnoVtolDynamicsSim::init(const VtolParameters& params, const TablesWithCoeffs& tables){
+    return init(params, VtolDynamicsKernel<double>::SharedTables(new TablesWithCoeffs(tables)));
 }
 
-int8_t InnoVtolDynamicsSim::init(){
-    loadTables("/uav/aerodynamics_coeffs/");
-    loadParams("/uav/vtol_params/");
+int8_t InnoVtolDynamicsSim::init(const VtolParameters& params, VtolDynamicsKernel<double>::SharedTables tables){
+    params_ = params;
+    kernel_.init(params_, std::move(tables));
+    initActuatorsDynamics();
+    turbulence_.init(params_.turbulenceWindSpeedAt6m);
+    DrydenTurbulence::seed(state_.turbulenceState, params_.turbulenceSeed);
+    windField_.close();
+    state_.windFieldTime = 0;
+    if(!params_.windFieldPath.empty() && windField_.open(params_.windFieldPath) == 0){
+        std::cout << "InnoVtolDynamicsSim: wind field " << params_.windFieldPath << " is loaded" << std::endl;
+    }
     return 0;
 }
 
 template<int ROWS, int COLS, int ORDER>
-Eigen::MatrixXd getTableNew(const std::string& path, const char* name){
+Eigen::MatrixXd getTableNew(const ParamsSource& source, const std::string& path, const char* name){
     std::vector<double> data;
 
-    if(ros::param::get(path + name, data) == false){
+    if(source.get(path + name, data) == false){
         throw std::runtime_error(std::string("Wrong parameter name: ") + name);
     }
 
@@ -49,50 +124,97 @@ Eigen::MatrixXd getTableNew(const std::string& path, const char* name){
 }
 
 
-void InnoVtolDynamicsSim::loadTables(const std::string& path){
-    tables_.CS_rudder = getTableNew<8, 20, Eigen::RowMajor>(path, "CS_rudder_table");
-    tables_.CS_beta = getTableNew<8, 90, Eigen::RowMajor>(path, "CS_beta");
-    tables_.AoA = getTableNew<1, 47, Eigen::RowMajor>(path, "AoA");
-    tables_.AoS = getTableNew<90, 1, Eigen::ColMajor>(path, "AoS");
-    tables_.actuator = getTableNew<20, 1, Eigen::ColMajor>(path, "actuator_table");
-    tables_.airspeed = getTableNew<8, 1, Eigen::ColMajor>(path, "airspeed_table");
-    tables_.CLPolynomial = getTableNew<8, 8, Eigen::RowMajor>(path, "CLPolynomial");
-    tables_.CSPolynomial = getTableNew<8, 8, Eigen::RowMajor>(path, "CSPolynomial");
-    tables_.CDPolynomial = getTableNew<8, 6, Eigen::RowMajor>(path, "CDPolynomial");
-    tables_.CmxPolynomial = getTableNew<8, 8, Eigen::RowMajor>(path, "CmxPolynomial");
-    tables_.CmyPolynomial = getTableNew<8, 8, Eigen::RowMajor>(path, "CmyPolynomial");
-    tables_.CmzPolynomial = getTableNew<8, 8, Eigen::RowMajor>(path, "CmzPolynomial");
-    tables_.CmxAileron = getTableNew<8, 20, Eigen::RowMajor>(path, "CmxAileron");
-    tables_.CmyElevator = getTableNew<8, 20, Eigen::RowMajor>(path, "CmyElevator");
-    tables_.CmzRudder = getTableNew<8, 20, Eigen::RowMajor>(path, "CmzRudder");
-    tables_.prop = getTableNew<40, 5, Eigen::RowMajor>(path, "prop");
-    if(ros::param::get(path + "actuatorTimeConstants", tables_.actuatorTimeConstants) == false){
+void InnoVtolDynamicsSim::loadTables(const ParamsSource& source,
+                                     const std::string& path,
+                                     TablesWithCoeffs& tables){
+    forEachTable(tables, [&source, &path](const char* name, auto& table){
+        std::vector<double> data;
+        if(source.get(path + name, data) == false){
+            throw std::runtime_error(std::string("Wrong parameter name: ") + name);
+        }else if(data.size() != static_cast<size_t>(table.size())){
+            throw std::runtime_error(std::string("Wrong parameter size: ") + name);
+        }
+        table = Eigen::Map<const typename std::decay<decltype(table)>::type>(data.data());
+    });
+    std::vector<double> actuatorTimeConstants;
+    if(source.get(path + "actuatorTimeConstants", actuatorTimeConstants) == false){
         throw std::runtime_error(std::string("Wrong parameter name: ") + "actuatorTimeConstants");
+    }else if(actuatorTimeConstants.size() != tables.actuatorTimeConstants.size()){
+        throw std::runtime_error(std::string("Wrong parameter size: ") + "actuatorTimeConstants");
     }
+    std::copy(actuatorTimeConstants.begin(), actuatorTimeConstants.end(), tables.actuatorTimeConstants.begin());
 }
 
-void InnoVtolDynamicsSim::loadParams(const std::string& path){
+void InnoVtolDynamicsSim::loadParams(const ParamsSource& source,
+                                     const std::string& path,
+                                     VtolParameters& params){
     double propLocX, propLocY, propLocZ;
 
-    if(!ros::param::get(path + "mass", params_.mass) ||
-        !ros::param::get(path + "gravity", params_.gravity) ||
-        !ros::param::get(path + "atmoRho", params_.atmoRho) ||
-        !ros::param::get(path + "wingArea", params_.wingArea) ||
-        !ros::param::get(path + "characteristicLength", params_.characteristicLength) ||
-        !ros::param::get(path + "propellersLocationX", propLocX) ||
-        !ros::param::get(path + "propellersLocationY", propLocY) ||
-        !ros::param::get(path + "propellersLocationZ", propLocZ) ||
-        !ros::param::get(path + "actuatorMin", params_.actuatorMin) ||
-        !ros::param::get(path + "actuatorMax", params_.actuatorMax) ||
-        !ros::param::get(path + "accVariance", params_.accVariance) ||
-        !ros::param::get(path + "gyroVariance", params_.gyroVariance));
-
-    params_.propellersLocation[0] << propLocX * sin(3.1415/4),  propLocY * sin(3.1415/4), propLocZ;
-    params_.propellersLocation[1] <<-propLocX * sin(3.1415/4), -propLocY * sin(3.1415/4), propLocZ;
-    params_.propellersLocation[2] << propLocX * sin(3.1415/4), -propLocY * sin(3.1415/4), propLocZ;
-    params_.propellersLocation[3] <<-propLocX * sin(3.1415/4),  propLocY * sin(3.1415/4), propLocZ;
-    params_.propellersLocation[4] << propLocX, 0, 0;
-    params_.inertia = getTableNew<3, 3, Eigen::RowMajor>(path, "inertia");
+    if(!source.get(path + "mass", params.mass) ||
+        !source.get(path + "gravity", params.gravity) ||
+        !source.get(path + "atmoRho", params.atmoRho) ||
+        !source.get(path + "wingArea", params.wingArea) ||
+        !source.get(path + "characteristicLength", params.characteristicLength) ||
+        !source.get(path + "propellersLocationX", propLocX) ||
+        !source.get(path + "propellersLocationY", propLocY) ||
+        !source.get(path + "propellersLocationZ", propLocZ) ||
+        !source.get(path + "actuatorMin", params.actuatorMin) ||
+        !source.get(path + "actuatorMax", params.actuatorMax) ||
+        !source.get(path + "accVariance", params.accVariance) ||
+        !source.get(path + "gyroVariance", params.gyroVariance));
+
+    if(!source.get(path + "turbulenceWindSpeedAt6m", params.turbulenceWindSpeedAt6m)){
+        params.turbulenceWindSpeedAt6m = 0;
+    }
+    double turbulenceSeed;
+    if(!source.get(path + "turbulenceSeed", turbulenceSeed) || turbulenceSeed < 0){
+        params.turbulenceSeed = DrydenTurbulence::randomSeed();
+    }else if(turbulenceSeed > std::numeric_limits<uint32_t>::max() || std::floor(turbulenceSeed) != turbulenceSeed){
+        std::cerr << "ERROR: InnoVtolDynamicsSim turbulenceSeed " << turbulenceSeed
+                  << " is not an uint32, a random one is used." << std::endl;
+        params.turbulenceSeed = DrydenTurbulence::randomSeed();
+    }else{
+        params.turbulenceSeed = static_cast<uint32_t>(turbulenceSeed);
+    }
+    if(!source.get(path + "windFieldPath", params.windFieldPath)){
+        params.windFieldPath.clear();
+    }
+
+    std::vector<double> deltaControlMax;
+    if(source.get(path + "deltaControlMax", deltaControlMax) && deltaControlMax.size() == 8){
+        params.deltaControlMax = Eigen::Map<const ActuatorsArray>(deltaControlMax.data());
+    }else{
+        params.deltaControlMax.setConstant(std::numeric_limits<double>::infinity());
+    }
+    std::string actuatorsModel;
+    if(!source.get(path + "actuatorsModel", actuatorsModel) ||
+            ActuatorsDynamics::parseModel(actuatorsModel, params.actuatorsModel) != 0){
+        params.actuatorsModel = ActuatorsDynamics::FIRST_ORDER;
+    }
+
+    double innerSubsteps;
+    if(!source.get(path + "innerSubsteps", innerSubsteps) || innerSubsteps < 1){
+        innerSubsteps = 1;
+    }
+    params.innerSubsteps = static_cast<uint32_t>(innerSubsteps);
+    if(!source.get(path + "aeroUpdatePeriod", params.aeroUpdatePeriod) || params.aeroUpdatePeriod < 0){
+        params.aeroUpdatePeriod = 0;
+    }
+    std::string aeroForcesPolicy;
+    source.get(path + "aeroForcesPolicy", aeroForcesPolicy);
+    params.aeroForcesPolicy = (aeroForcesPolicy == "extrapolate") ? AERO_FORCES_EXTRAPOLATE : AERO_FORCES_HOLD;
+    std::string attitudeIntegrationMethod;
+    if(!source.get(path + "attitudeIntegrationMethod", attitudeIntegrationMethod) ||
+            AttitudeIntegration::parseMethod(attitudeIntegrationMethod, params.attitudeIntegrationMethod) != 0){
+        params.attitudeIntegrationMethod = AttitudeIntegration::EXPONENTIAL;
+    }
+
+    params.propellersLocation[0] << propLocX * sin(3.1415/4),  propLocY * sin(3.1415/4), propLocZ;
+    params.propellersLocation[1] <<-propLocX * sin(3.1415/4), -propLocY * sin(3.1415/4), propLocZ;
+    params.propellersLocation[2] << propLocX * sin(3.1415/4), -propLocY * sin(3.1415/4), propLocZ;
+    params.propellersLocation[3] <<-propLocX * sin(3.1415/4),  propLocY * sin(3.1415/4), propLocZ;
+    params.propellersLocation[4] << propLocX, 0, 0;
+    params.inertia = getTableNew<3, 3, Eigen::RowMajor>(source, path, "inertia");
 }
 
 void InnoVtolDynamicsSim::setInitialPosition(const Eigen::Vector3d & position,
@@ -108,6 +230,40 @@ void InnoVtolDynamicsSim::setInitialVelocity(const Eigen::Vector3d & linearVeloc
     state_.angularVel = angularVelocity;
 }
 
+const State& InnoVtolDynamicsSim::getState() const{
+    return state_;
+}
+void InnoVtolDynamicsSim::setState(const State& state){
+    state_ = state;
+}
+const TablesWithCoeffs& InnoVtolDynamicsSim::getTables() const{
+    return kernel_.getTables();
+}
+const VtolDynamicsKernel<double>::SharedTables& InnoVtolDynamicsSim::getSharedTables() const{
+    return kernel_.getSharedTables();
+}
+void InnoVtolDynamicsSim::setTables(const TablesWithCoeffs& tables){
+    kernel_.init(params_, tables);
+    initActuatorsDynamics();
+}
+const VtolParameters& InnoVtolDynamicsSim::getParams() const{
+    return params_;
+}
+void InnoVtolDynamicsSim::setModelReloader(VtolModelReloader* modelReloader){
+    modelReloader_ = modelReloader;
+}
+
+void InnoVtolDynamicsSim::takeReloadedModel(){
+    // the turbulence keeps running, so the reloaded (maybe random) seed would not describe it
+    const uint32_t turbulenceSeed = params_.turbulenceSeed;
+    if(modelReloader_ != nullptr && modelReloader_->tryTake(params_, kernel_)){
+        params_.turbulenceSeed = turbulenceSeed;
+        initActuatorsDynamics();
+        state_.aeroAge = std::numeric_limits<double>::infinity();
+        modelReloads_++;
+    }
+}
+
 void InnoVtolDynamicsSim::land(){
     state_.Fspecific << 0, 0, -params_.gravity;
     state_.linearVel.setZero();
@@ -119,9 +275,7 @@ void InnoVtolDynamicsSim::land(){
     state_.angularVel.setZero();
     #elif YAW_ROTATE_ON_LAND_DEBUG == true
     state_.angularVel << 0.000, 0.000, 2*3.1415/60;
-    Eigen::Quaterniond attitudeDelta = state_.attitude * Eigen::Quaterniond(0, state_.angularVel(0), state_.angularVel(1), state_.angularVel(2));
-    state_.attitude.coeffs() += attitudeDelta.coeffs() * 0.5 * 0.001;
-    state_.attitude.normalize();
+    AttitudeIntegration::integrateAttitude(state_.attitude, state_.angularVel, 0.001);
     #endif
 }
 
@@ -202,34 +356,64 @@ int8_t InnoVtolDynamicsSim::calibrate(CalibrationType_t calType){
     }
 
     if(prevCalibrationType != calType){
-        ROS_WARN_STREAM_THROTTLE(1, "init cal " << calType + 0);
+        std::cout << "InnoVtolDynamicsSim: init calibration " << calType + 0 << std::endl;
         prevCalibrationType = calType;
-    }else{
-        ROS_WARN_STREAM_THROTTLE(1, "cal " << calType + 0);
     }
 
     constexpr float DELTA_TIME = 0.001;
 
     state_.Fspecific = calculateNormalForceWithoutMass();
-    Eigen::Quaterniond attitudeDelta = state_.attitude * Eigen::Quaterniond(0, state_.angularVel(0), state_.angularVel(1), state_.angularVel(2));
-    state_.attitude.coeffs() += attitudeDelta.coeffs() * 0.5 * DELTA_TIME;
-    state_.attitude.normalize();
+    AttitudeIntegration::integrateAttitude<double>(state_.attitude, state_.angularVel, DELTA_TIME);
     return 1;
 }
 
 void InnoVtolDynamicsSim::process(double dtSecs,
                               const std::vector<double>& motorCmd,
                               bool isCmdPercent){
+    takeReloadedModel();
+    updateWindField(dtSecs);
+    updateTurbulence(dtSecs);
+    auto cmd = isCmdPercent ? mapCmdToActuatorInnoVTOL(motorCmd) : motorCmd;
+    std::vector<double> actuators(cmd);
+
+    const uint32_t substeps = std::max<uint32_t>(params_.innerSubsteps, 1);
+    const double innerDtSecs = dtSecs / substeps;
+    for(uint32_t substep = 0; substep < substeps; substep++){
+        updateActuators(cmd, innerDtSecs, actuators);
+        state_.aeroAge += innerDtSecs;
+        if(state_.aeroAge >= params_.aeroUpdatePeriod - 0.5 * innerDtSecs){
+            updateAerodynamics(actuators);
+        }
+        state_.Faero = state_.FaeroHeld + state_.FaeroRate * state_.aeroAge;
+        state_.Maero = state_.MaeroHeld + state_.MaeroRate * state_.aeroAge;
+        calculateNewState(state_.Maero, state_.Faero, actuators, innerDtSecs);
+    }
+}
+
+/**
+ * @note Wind, airspeed and the aerodynamics tables are the most expensive part of a step,
+ * so they are evaluated at the outer rate and the forces are held or extrapolated between
+ */
+void InnoVtolDynamicsSim::updateAerodynamics(const std::vector<double>& actuators){
     Eigen::Vector3d vel_w = calculateWind();
     Eigen::Matrix3d rotationMatrix = calculateRotationMatrix();
     Eigen::Vector3d airSpeed = calculateAirSpeed(rotationMatrix, state_.linearVel, vel_w);
     double AoA = calculateAnglesOfAtack(airSpeed);
     double AoS = calculateAnglesOfSideslip(airSpeed);
-    auto actuators = isCmdPercent ? mapCmdToActuatorInnoVTOL(motorCmd) : motorCmd;
-    updateActuators(actuators, dtSecs);
-    calculateAerodynamics(airSpeed, AoA, AoS, actuators[5], actuators[6], actuators[7],
-                          state_.Faero, state_.Maero);
-    calculateNewState(state_.Maero, state_.Faero, actuators, dtSecs);
+    Eigen::Vector3d Faero, Maero;
+    calculateAerodynamics(airSpeed, AoA, AoS, actuators[5], actuators[6], actuators[7], Faero, Maero);
+
+    if(params_.aeroForcesPolicy == AERO_FORCES_EXTRAPOLATE && std::isfinite(state_.aeroAge) && state_.aeroAge > 0){
+        state_.FaeroRate = (Faero - state_.FaeroHeld) / state_.aeroAge;
+        state_.MaeroRate = (Maero - state_.MaeroHeld) / state_.aeroAge;
+    }else{
+        state_.FaeroRate.setZero();
+        state_.MaeroRate.setZero();
+    }
+    state_.FaeroHeld = Faero;
+    state_.MaeroHeld = Maero;
+    state_.aeroAge = 0;
+    aeroEvaluations_++;
 }
 
 
@@ -321,12 +505,28 @@ std::vector<double> InnoVtolDynamicsSim::mapCmdToActuatorInnoVTOL(const std::vec
     return actuators;
 }
 
-void InnoVtolDynamicsSim::updateActuators(std::vector<double>& cmd, double dtSecs){
-    state_.prevActuators = state_.crntActuators;
-    for(size_t idx = 0; idx < 8; idx++){
-        state_.crntActuators[idx] = cmd[idx] + (state_.prevActuators[idx] - cmd[idx]) * (1 - pow(2.71, -dtSecs/tables_.actuatorTimeConstants[idx]));
-        cmd[idx] = state_.crntActuators[idx];
+void InnoVtolDynamicsSim::initActuatorsDynamics(){
+    const double INF = std::numeric_limits<double>::infinity();
+    ActuatorsArray timeConstants = Eigen::Map<const ActuatorsArray>(kernel_.getTables().actuatorTimeConstants.data());
+    ActuatorsArray positionMin = ActuatorsArray::Constant(-INF);
+    ActuatorsArray positionMax = ActuatorsArray::Constant(INF);
+    if(params_.actuatorMin.size() == 8 && params_.actuatorMax.size() == 8){
+        positionMin = Eigen::Map<const ActuatorsArray>(params_.actuatorMin.data());
+        positionMax = Eigen::Map<const ActuatorsArray>(params_.actuatorMax.data());
+    }
+    actuatorsDynamics_.setModel(params_.actuatorsModel);
+    actuatorsDynamics_.setTimeConstants(timeConstants);
+    actuatorsDynamics_.setLimits(positionMin, positionMax, params_.deltaControlMax);
+}
+
+void InnoVtolDynamicsSim::updateActuators(const std::vector<double>& cmd,
+                                          double dtSecs,
+                                          std::vector<double>& actuators){
+    if(cmd.size() != 8 || actuators.size() != 8){
+        return;
     }
+    actuatorsDynamics_.process(state_.actuators, Eigen::Map<const ActuatorsArray>(cmd.data()), dtSecs);
+    Eigen::Map<ActuatorsArray>(actuators.data()) = state_.actuators.position;
 }
 
 Eigen::Vector3d InnoVtolDynamicsSim::calculateWind(){
@@ -335,14 +535,35 @@ Eigen::Vector3d InnoVtolDynamicsSim::calculateWind(){
     wind[1] = sqrt(state_.windVariance) * distribution_(generator_) + state_.windVelocity[1];
     wind[2] = sqrt(state_.windVariance) * distribution_(generator_) + state_.windVelocity[2];
 
-    /**
-     * @todo Implement own gust logic
-     * @note innopolis_vtol_indi logic doesn't suit us
-     */
-    Eigen::Vector3d gust;
-    gust.setZero();
+    return wind + state_.gustVelocity;
+}
+
+/**
+ * @brief If the wind field is loaded, it replaces the mean wind set by setWindParameter
+ */
+void InnoVtolDynamicsSim::updateWindField(double dtSecs){
+    if(!windField_.isLoaded()){
+        return;
+    }
+    state_.windFieldTime += dtSecs;
+    state_.windVelocity = windField_.sample(state_.position, state_.windFieldTime);
+}
 
-    return wind + gust;
+/**
+ * @brief Turbulence is calculated in body frame relative to the mean wind, but it is
+ * stored in NED, so calculateWind may simply add it to the mean wind
+ */
+void InnoVtolDynamicsSim::updateTurbulence(double dtSecs){
+    if(!turbulence_.isEnabled()){
+        return;
+    }
+    double airspeed = (state_.linearVel - state_.windVelocity).norm();
+    double altitude = -state_.position[2];
+    const Eigen::Vector3d& gustFrd = turbulence_.process(state_.turbulenceState,
+                                                         dtSecs,
+                                                         airspeed,
+                                                         altitude);
+    state_.gustVelocity = state_.attitude * gustFrd;
 }
 
 Eigen::Matrix3d InnoVtolDynamicsSim::calculateRotationMatrix() const{
@@ -366,33 +587,15 @@ Eigen::Vector3d InnoVtolDynamicsSim::calculateAirSpeed(const Eigen::Matrix3d& ro
 }
 
 double InnoVtolDynamicsSim::calculateDynamicPressure(double airSpeedMod){
-    return params_.atmoRho * airSpeedMod * airSpeedMod * params_.wingArea;
+    return kernel_.calculateDynamicPressure(airSpeedMod);
 }
 
-/**
- * @return AoA
- * it must be [0, 3.14] if angle is [0, +180]
- * it must be [0, -3.14] if angle is [0, -180]
- */
 double InnoVtolDynamicsSim::calculateAnglesOfAtack(const Eigen::Vector3d& airSpeed) const{
-    double A = sqrt(airSpeed[0] * airSpeed[0] + airSpeed[2] * airSpeed[2]);
-    if(A < 0.001){
-        return 0;
-    }
-    A = airSpeed[2] / A;
-    A = boost::algorithm::clamp(A, -1.0, +1.0);
-    A = (airSpeed[0] > 0) ? asin(A) : 3.1415 - asin(A);
-    return (A > 3.1415) ? A - 2 * 3.1415 : A;
+    return VtolDynamicsKernel<double>::calculateAnglesOfAtack(airSpeed);
 }
 
 double InnoVtolDynamicsSim::calculateAnglesOfSideslip(const Eigen::Vector3d& airSpeed) const{
-    double B = airSpeed.norm();
-    if(B < 0.001){
-        return 0;
-    }
-    B = airSpeed[1] / B;
-    B = boost::algorithm::clamp(B, -1.0, +1.0);
-    return asin(B);
+    return VtolDynamicsKernel<double>::calculateAnglesOfSideslip(airSpeed);
 }
 
 /**
@@ -409,86 +612,23 @@ void InnoVtolDynamicsSim::calculateAerodynamics(const Eigen::Vector3d& airspeed,
                                             double rudder_pos,
                                             Eigen::Vector3d& Faero,
                                             Eigen::Vector3d& Maero){
-    // 0. Common computation
-    double AoA_deg = boost::algorithm::clamp(AoA * 180 / 3.1415, -45.0, +45.0);
-    double AoS_deg = boost::algorithm::clamp(AoS * 180 / 3.1415, -90.0, +90.0);
-    double airspeedMod = airspeed.norm();
-    double dynamicPressure = calculateDynamicPressure(airspeedMod);
-    double airspeedModClamped = boost::algorithm::clamp(airspeed.norm(), 5, 40);
-
-    // 1. Calculate aero force
-    Eigen::VectorXd polynomialCoeffs(7);
-
-    calculateCLPolynomial(airspeedModClamped, polynomialCoeffs);
-    double CL = polyval(polynomialCoeffs, AoA_deg);
-    Eigen::Vector3d FL = (Eigen::Vector3d(0, 1, 0).cross(airspeed.normalized())) * CL;
-
-    calculateCSPolynomial(airspeedModClamped, polynomialCoeffs);
-    double CS = polyval(polynomialCoeffs, AoA_deg);
-    double CS_rudder = calculateCSRudder(rudder_pos, airspeedModClamped);
-    double CS_beta = calculateCSBeta(AoS_deg, airspeedModClamped);
-    Eigen::Vector3d FS = airspeed.cross(Eigen::Vector3d(0, 1, 0).cross(airspeed.normalized())) * (CS + CS_rudder + CS_beta);
-
-    calculateCDPolynomial(airspeedModClamped, polynomialCoeffs);
-    double CD = polyval(polynomialCoeffs.block<5, 1>(0, 0), AoA_deg);
-    Eigen::Vector3d FD = (-1 * airspeed).normalized() * CD;
-
-    Faero = 0.5 * dynamicPressure * (FL + FS + FD);
-
-    // 2. Calculate aero moment
-    calculateCmxPolynomial(airspeedModClamped, polynomialCoeffs);
-    auto Cmx = polyval(polynomialCoeffs, AoA_deg);
-
-    calculateCmyPolynomial(airspeedModClamped, polynomialCoeffs);
-    auto Cmy = polyval(polynomialCoeffs, AoA_deg);
-
-    calculateCmzPolynomial(airspeedModClamped, polynomialCoeffs);
-    auto Cmz = -polyval(polynomialCoeffs, AoA_deg);
-
-    double Cmx_aileron = calculateCmxAileron(aileron_pos, airspeedModClamped);
-    /**
-     * @note InnoDynamics from octave has some mistake in elevator logic
-     * It always generate non positive moment in both positive and negative position
-     * Temporary decision is to create positive moment in positive position and
-     * negative moment in negative position
-     */
-    double Cmy_elevator = calculateCmyElevator(abs(elevator_pos), airspeedModClamped);
-    double Cmz_rudder = calculateCmzRudder(rudder_pos, airspeedModClamped);
-
-    auto Mx = Cmx + Cmx_aileron * aileron_pos;
-    auto My = Cmy + Cmy_elevator * elevator_pos;
-    auto Mz = Cmz + Cmz_rudder * rudder_pos;
-
-    Maero = 0.5 * dynamicPressure * params_.characteristicLength * Eigen::Vector3d(Mx, My, Mz);
-
-
-    state_.Flift << 0.5 * dynamicPressure * params_.characteristicLength * FL;
-    state_.Fdrug << 0.5 * dynamicPressure * params_.characteristicLength * FD;
-    state_.Fside << 0.5 * dynamicPressure * params_.characteristicLength * FS;
-    state_.Msteer << Cmx_aileron * aileron_pos, Cmy_elevator * elevator_pos, Cmz_rudder * rudder_pos;
-    state_.Msteer *= 0.5 * dynamicPressure * params_.characteristicLength;
-    state_.Mairspeed << Cmx, Cmy, Cmz;
-    state_.Mairspeed *= 0.5 * dynamicPressure * params_.characteristicLength;
+    VtolDynamicsKernel<double>::AeroComponents components;
+    kernel_.calculateAerodynamics(airspeed, AoA, AoS, aileron_pos, elevator_pos, rudder_pos,
+                                  Faero, Maero, &components);
+    state_.Flift = components.Flift;
+    state_.Fdrug = components.Fdrug;
+    state_.Fside = components.Fside;
+    state_.Msteer = components.Msteer;
+    state_.Mairspeed = components.Mairspeed;
 
     #if AERODYNAMICS_LOG == true
     if(abs(Faero[0]) > 20 || abs(Faero[1]) > 20 || abs(Faero[2]) > 20){
-        std::cout << "in: AoA_deg=" << AoA_deg << std::endl;
-        std::cout << "in: AoS_deg=" << AoS_deg << std::endl;
+        std::cout << "in: AoA=" << AoA << ", AoS=" << AoS << std::endl;
         std::cout << "in: aileron/elevator/rudder poses=" << aileron_pos << ", " << elevator_pos << ", " << rudder_pos << std::endl;
-        std::cout << "in: airspeedMod=" << airspeedMod << std::endl;
-        // std::cout << "CL=" << CL << std::endl;
-        // std::cout << "CS=" << CS << std::endl;
-        // std::cout << "CS_rudder=" << CS_rudder << std::endl;
-        // std::cout << "CS_beta=" << CS_beta << std::endl;
-        // std::cout << "CD=" << CD << std::endl;
-        // std::cout << "FL=" << FL << std::endl;
-        // std::cout << "FS=" << FS << std::endl;
-        // std::cout << "FD=" << FD << std::endl;
-        std::cout << "aileron:"     << Cmx_aileron << ", "  << aileron_pos << ", "  << state_.Msteer[0] << ", Mairspeed=" << state_.Mairspeed[0] << std::endl;
-        std::cout << "elevator:"    << Cmy_elevator << ", " << elevator_pos << ", " << state_.Msteer[1] << ", Mairspeed=" << state_.Mairspeed[1] << std::endl;
-        std::cout << "rudder:"      << Cmz_rudder << ", "   << rudder_pos << ", "   << state_.Msteer[2] << ", Mairspeed=" << state_.Mairspeed[2] << std::endl;
-        std::cout << "out: Maero=" << Maero << std::endl;
-        std::cout << "out: Faero=" << Faero << std::endl;
+        std::cout << "in: airspeedMod=" << airspeed.norm() << std::endl;
+        std::cout << "Msteer=" << state_.Msteer.transpose() << ", Mairspeed=" << state_.Mairspeed.transpose() << std::endl;
+        std::cout << "out: Maero=" << Maero.transpose() << std::endl;
+        std::cout << "out: Faero=" << Faero.transpose() << std::endl;
         std::cout << std::endl;
     }
 
@@ -497,55 +637,25 @@ void InnoVtolDynamicsSim::calculateAerodynamics(const Eigen::Vector3d& airspeed,
 
 void InnoVtolDynamicsSim::thruster(double actuator,
                                    double& thrust, double& torque, double& rpm) const{
-    constexpr size_t CONTROL_IDX = 0;
-    constexpr size_t THRUST_IDX = 1;
-    constexpr size_t TORQUE_IDX = 2;
-    constexpr size_t RPM_IDX = 4;
-
-    size_t prev_idx = findRow(tables_.prop, actuator);
-    size_t next_idx = prev_idx + 1;
-    if(next_idx < tables_.prop.rows()){
-        auto prev_row = tables_.prop.row(prev_idx);
-        auto next_row = tables_.prop.row(next_idx);
-        auto t = (actuator - prev_row(CONTROL_IDX)) / (next_row(CONTROL_IDX) - prev_row(CONTROL_IDX));
-        thrust = lerp(prev_row(THRUST_IDX), next_row(THRUST_IDX), t);
-        torque = lerp(prev_row(TORQUE_IDX), next_row(TORQUE_IDX), t);
-        rpm = lerp(prev_row(RPM_IDX), next_row(RPM_IDX), t);
-    }
+    kernel_.thruster(actuator, thrust, torque, rpm);
 }
 
 void InnoVtolDynamicsSim::calculateNewState(const Eigen::Vector3d& Maero,
                                         const Eigen::Vector3d& Faero,
                                         const std::vector<double>& actuator,
                                         double dt_sec){
-    Eigen::VectorXd thrust(5), torque(5);
-    for(size_t idx = 0; idx < 5; idx++){
-        thruster(actuator[idx], thrust[idx], torque[idx], state_.motorsRpm[idx]);
-    }
-
-    for(size_t idx = 0; idx < 4; idx++){
-        state_.Fmotors[idx] << 0, 0, -thrust[idx];
-    }
-    state_.Fmotors[4] << thrust[4], 0, 0;
-
-    std::array<Eigen::Vector3d, 5> motorTorquesInBodyCS;
-    motorTorquesInBodyCS[0] << 0, 0, torque[0];
-    motorTorquesInBodyCS[1] << 0, 0, torque[1];
-    motorTorquesInBodyCS[2] << 0, 0, -torque[2];
-    motorTorquesInBodyCS[3] << 0, 0, -torque[3];
-    motorTorquesInBodyCS[4] << -torque[4], 0, 0;
-    std::array<Eigen::Vector3d, 5> MdueToArmOfForceInBodyCS;
-    for(size_t idx = 0; idx < 5; idx++){
-        MdueToArmOfForceInBodyCS[idx] = params_.propellersLocation[idx].cross(state_.Fmotors[idx]);
-        state_.Mmotors[idx] = motorTorquesInBodyCS[idx] + MdueToArmOfForceInBodyCS[idx];
-    }
+    kernel_.calculateMotors(actuator.data(), state_.Fmotors, state_.Mmotors, state_.motorsRpm);
 
     auto MtotalInBodyCS = std::accumulate(&state_.Mmotors[0], &state_.Mmotors[5], Maero);
-    state_.angularAccel = params_.inertia.inverse() * (MtotalInBodyCS - state_.angularVel.cross(params_.inertia * state_.angularVel));
-    state_.angularVel += state_.angularAccel * dt_sec;
-    Eigen::Quaterniond attitudeDelta = state_.attitude * Eigen::Quaterniond(0, state_.angularVel(0), state_.angularVel(1), state_.angularVel(2));
-    state_.attitude.coeffs() += attitudeDelta.coeffs() * 0.5 * dt_sec;
-    state_.attitude.normalize();
+    Eigen::Matrix3d inertiaInverse = params_.inertia.inverse();
+    state_.angularAccel = inertiaInverse * (MtotalInBodyCS - state_.angularVel.cross(params_.inertia * state_.angularVel));
+    if(params_.attitudeIntegrationMethod == AttitudeIntegration::CROUCH_GROSSMAN){
+        AttitudeIntegration::integrateRigidBody(state_.attitude, state_.angularVel, params_.inertia,
+                                                inertiaInverse, MtotalInBodyCS, dt_sec);
+    }else{
+        state_.angularVel += state_.angularAccel * dt_sec;
+        AttitudeIntegration::integrateAttitude(state_.attitude, state_.angularVel, dt_sec);
+    }
 
     Eigen::Matrix3d rotationMatrix = calculateRotationMatrix();
     Eigen::Vector3d Fspecific = std::accumulate(&state_.Fmotors[0], &state_.Fmotors[5], Faero) / params_.mass;
@@ -612,10 +722,6 @@ void InnoVtolDynamicsSim::calculateNewState(const Eigen::Vector3d& Maero,
     std::cout << "- input: Maero = "            << Maero.transpose() << std::endl;
     std::cout << "- input: state_.angularVel = "  << state_.angularVel.transpose() << std::endl;
 
-    std::cout << "- motorTorquesInBodyCS: "     << motorTorquesInBodyCS[0].transpose() << ", " << motorTorquesInBodyCS[1].transpose() << ", " << motorTorquesInBodyCS[2].transpose() << ", "
-                                                << motorTorquesInBodyCS[3].transpose() << ", " << motorTorquesInBodyCS[4].transpose() << std::endl;
-    std::cout << "- MdueToArmOfForceInBodyCS: " << MdueToArmOfForceInBodyCS[0].transpose() << ", " << MdueToArmOfForceInBodyCS[1].transpose() << ", " << MdueToArmOfForceInBodyCS[2].transpose() << ", "
-                                                << MdueToArmOfForceInBodyCS[3].transpose() << ", " << MdueToArmOfForceInBodyCS[4].transpose() << std::endl;
     std::cout << "- state_.Mmotors: "           << state_.Mmotors[0].transpose() << ", " << state_.Mmotors[1].transpose() << ", " << state_.Mmotors[2].transpose() << ", "
                                                 << state_.Mmotors[3].transpose() << ", " << state_.Mmotors[4].transpose() << std::endl;
     std::cout << "- MtotalInBodyCS: "           << MtotalInBodyCS.transpose() << std::endl;
@@ -650,99 +756,60 @@ Eigen::Vector3d InnoVtolDynamicsSim::calculateNormalForceWithoutMass(){
 
 void InnoVtolDynamicsSim::calculateCLPolynomial(double airSpeedMod,
                                                 Eigen::VectorXd& polynomialCoeffs) const{
-    calculatePolynomialUsingTable(tables_.CLPolynomial, airSpeedMod, polynomialCoeffs);
+    calculatePolynomialUsingTable(kernel_.getTables().CLPolynomial, airSpeedMod, polynomialCoeffs);
 }
 void InnoVtolDynamicsSim::calculateCSPolynomial(double airSpeedMod,
                                                 Eigen::VectorXd& polynomialCoeffs) const{
-    calculatePolynomialUsingTable(tables_.CSPolynomial, airSpeedMod, polynomialCoeffs);
+    calculatePolynomialUsingTable(kernel_.getTables().CSPolynomial, airSpeedMod, polynomialCoeffs);
 }
 void InnoVtolDynamicsSim::calculateCDPolynomial(double airSpeedMod,
                                                 Eigen::VectorXd& polynomialCoeffs) const{
-    calculatePolynomialUsingTable(tables_.CDPolynomial, airSpeedMod, polynomialCoeffs);
+    calculatePolynomialUsingTable(kernel_.getTables().CDPolynomial, airSpeedMod, polynomialCoeffs);
 }
 void InnoVtolDynamicsSim::calculateCmxPolynomial(double airSpeedMod,
                                                  Eigen::VectorXd& polynomialCoeffs) const{
-    calculatePolynomialUsingTable(tables_.CmxPolynomial, airSpeedMod, polynomialCoeffs);
+    calculatePolynomialUsingTable(kernel_.getTables().CmxPolynomial, airSpeedMod, polynomialCoeffs);
 }
 void InnoVtolDynamicsSim::calculateCmyPolynomial(double airSpeedMod,
                                                  Eigen::VectorXd& polynomialCoeffs) const{
-    calculatePolynomialUsingTable(tables_.CmyPolynomial, airSpeedMod, polynomialCoeffs);
+    calculatePolynomialUsingTable(kernel_.getTables().CmyPolynomial, airSpeedMod, polynomialCoeffs);
 }
 void InnoVtolDynamicsSim::calculateCmzPolynomial(double airSpeedMod,
                                                  Eigen::VectorXd& polynomialCoeffs) const{
-    calculatePolynomialUsingTable(tables_.CmzPolynomial, airSpeedMod, polynomialCoeffs);
+    calculatePolynomialUsingTable(kernel_.getTables().CmzPolynomial, airSpeedMod, polynomialCoeffs);
 }
 double InnoVtolDynamicsSim::calculateCSRudder(double rudder_pos, double airspeed) const{
-    return griddata(-tables_.actuator, tables_.airspeed, tables_.CS_rudder, rudder_pos, airspeed);
+    return kernel_.calculateCSRudder(rudder_pos, airspeed);
 }
 double InnoVtolDynamicsSim::calculateCSBeta(double AoS_deg, double airspeed) const{
-    return griddata(-tables_.AoS, tables_.airspeed, tables_.CS_beta, AoS_deg, airspeed);
+    return kernel_.calculateCSBeta(AoS_deg, airspeed);
 }
 double InnoVtolDynamicsSim::calculateCmxAileron(double aileron_pos, double airspeed) const{
-    return griddata(tables_.actuator, tables_.airspeed, tables_.CmxAileron, aileron_pos, airspeed);
+    return kernel_.calculateCmxAileron(aileron_pos, airspeed);
 }
 double InnoVtolDynamicsSim::calculateCmyElevator(double elevator_pos, double airspeed) const{
-    return griddata(tables_.actuator, tables_.airspeed, tables_.CmyElevator, elevator_pos, airspeed);
+    return kernel_.calculateCmyElevator(elevator_pos, airspeed);
 }
 double InnoVtolDynamicsSim::calculateCmzRudder(double rudder_pos, double airspeed) const{
-    return griddata(tables_.actuator, tables_.airspeed, tables_.CmzRudder, rudder_pos, airspeed);
+    return kernel_.calculateCmzRudder(rudder_pos, airspeed);
 }
 
 void InnoVtolDynamicsSim::calculatePolynomialUsingTable(const Eigen::MatrixXd& table,
                                                         double airSpeedMod,
                                                         Eigen::VectorXd& polynomialCoeffs) const{
-    size_t prevRowIdx = findRow(table, airSpeedMod);
-    if(prevRowIdx + 2 <= table.rows()){
-        size_t nextRowIdx = prevRowIdx + 1;
-        Eigen::MatrixXd prevRow = table.row(prevRowIdx);
-        Eigen::MatrixXd nextRow = table.row(nextRowIdx);
-        double t = (airSpeedMod - prevRow(0, 0)) / (nextRow(0, 0) - prevRow(0, 0));
-        for(size_t idx = 0; idx < 7; idx++){
-            polynomialCoeffs[idx] = lerp(prevRow(0, idx + 1), nextRow(0, idx + 1), t);
-        }
-    }else{
-        for(size_t idx = 0; idx < 7; idx++){
-            polynomialCoeffs[idx] = 0;
-        }
-    }
+    VtolDynamicsKernel<double>::calculatePolynomialUsingTable(table, airSpeedMod, polynomialCoeffs);
 }
 
-/**
- * @note size should be greater or equel than 2!
- * @todo think about binary search
- */
 size_t InnoVtolDynamicsSim::search(const Eigen::MatrixXd& matrix, double key) const{
-    size_t row_idx;
-    if(matrix(matrix.rows() - 1, 0) > matrix(0, 0)){
-        for(row_idx = 1; row_idx < matrix.rows() - 1; row_idx++){
-            if(key <= matrix(row_idx, 0)){
-                break;
-            }
-        }
-        row_idx--;
-    }else{
-        for(row_idx = 1; row_idx < matrix.rows() - 1; row_idx++){
-            if(key >= matrix(row_idx, 0)){
-                break;
-            }
-        }
-        row_idx--;
-    }
-    return row_idx;
+    return VtolDynamicsKernel<double>::search(matrix, key);
 }
 
-// first collomn of the table must be sorted!
 size_t InnoVtolDynamicsSim::findRow(const Eigen::MatrixXd& table, double value) const{
-    size_t row = 0;
-    size_t c = table.rows();
-    while(row + 2 < c && table(row + 1, 0) < value){
-        row++;
-    }
-    return row;
+    return VtolDynamicsKernel<double>::findRow(table, value);
 }
 
 double InnoVtolDynamicsSim::lerp(double a, double b, double f) const{
-    return a + f * (b - a);
+    return VtolDynamicsKernel<double>::lerp(a, b, f);
 }
 
 double InnoVtolDynamicsSim::griddata(const Eigen::MatrixXd& x,
@@ -750,26 +817,11 @@ double InnoVtolDynamicsSim::griddata(const Eigen::MatrixXd& x,
                                  const Eigen::MatrixXd& z,
                                  double x_val,
                                  double y_val) const{
-    size_t x1_idx = search(x, x_val);
-    size_t y1_idx = search(y, y_val);
-    size_t x2_idx = x1_idx + 1;
-    size_t y2_idx = y1_idx + 1;
-    double Q11 = z(y1_idx, x1_idx);
-    double Q12 = z(y2_idx, x1_idx);
-    double Q21 = z(y1_idx, x2_idx);
-    double Q22 = z(y2_idx, x2_idx);
-    double R1 = ((x(x2_idx) - x_val) * Q11 + (x_val - x(x1_idx)) * Q21) / (x(x2_idx) - x(x1_idx));
-    double R2 = ((x(x2_idx) - x_val) * Q12 + (x_val - x(x1_idx)) * Q22) / (x(x2_idx) - x(x1_idx));
-    double f =  ((y(y2_idx) - y_val) * R1  + (y_val - y(y1_idx)) * R2)  / (y(y2_idx) - y(y1_idx));
-    return f;
+    return VtolDynamicsKernel<double>::griddata(x, y, z, x_val, y_val);
 }
 
 double InnoVtolDynamicsSim::polyval(const Eigen::VectorXd& poly, double val) const{
-    double result = 0;
-    for(uint8_t idx = 0; idx < poly.rows(); idx++){
-        result += poly[idx] * std::pow(val, poly.rows() - 1 - idx);
-    }
-    return result;
+    return VtolDynamicsKernel<double>::polyval(poly, val);
 }
 
 /**
@@ -817,6 +869,25 @@ void InnoVtolDynamicsSim::setWindParameter(Eigen::Vector3d windMeanVelocity,
     state_.windVelocity = windMeanVelocity;
     state_.windVariance = windVariance;
 }
+void InnoVtolDynamicsSim::setTurbulenceParameter(double windSpeedAt6m){
+    params_.turbulenceWindSpeedAt6m = windSpeedAt6m;
+    turbulence_.init(windSpeedAt6m);
+    if(!turbulence_.isEnabled()){
+        state_.gustVelocity.setZero();
+    }
+}
+void InnoVtolDynamicsSim::setTurbulenceSeed(uint32_t seed){
+    params_.turbulenceSeed = seed;
+    DrydenTurbulence::seed(state_.turbulenceState, seed);
+}
+void InnoVtolDynamicsSim::setNoiseSeed(uint32_t seed){
+    std::seed_seq sequence{seed};
+    std::array<uint32_t, 2> seeds;
+    sequence.generate(seeds.begin(), seeds.end());
+    setTurbulenceSeed(seeds[0]);
+    generator_.seed(seeds[1]);
+    distribution_.reset();
+}
 Eigen::Vector3d InnoVtolDynamicsSim::getAngularAcceleration() const{
     return state_.angularAccel;
 }
@@ -0,0 +1,231 @@
+/**
+ * @file vtolLinearization.cpp
+ * @brief Linear models of the vtol dynamics by automatic differentiation implementation
+ */
+#include <cmath>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include "vtolLinearization.hpp"
+#include "vtolDynamicsSim.hpp"
+#include "attitudeIntegration.hpp"
+
+typedef VtolDynamicsKernel<VtolAutoDiff> AutoDiffKernel;
+
+static const size_t POSITION_IDX = 0;
+static const size_t LINEAR_VEL_IDX = 3;
+static const size_t ATTITUDE_IDX = 6;
+static const size_t ANGULAR_VEL_IDX = 9;
+static const size_t CONTROL_IDX = VtolLinearization::STATE_SIZE;
+static const size_t DERIVATIVES_AMOUNT = VtolLinearization::STATE_SIZE + VtolLinearization::CONTROL_SIZE;
+static const size_t MAX_STEP_HALVINGS = 12;
+static const double HOVER_MOTORS_GUESS = 500.0;     // rad/sec
+static const double PUSHER_GUESS = 400.0;           // rad/sec
+
+static_assert(DERIVATIVES_AMOUNT == VtolAutoDiff::DerType::RowsAtCompileTime,
+              "VtolAutoDiff must have a derivative per state and control component");
+
+constexpr size_t VtolLinearization::STATE_SIZE;
+constexpr size_t VtolLinearization::CONTROL_SIZE;
+constexpr size_t VtolLinearization::DEFAULT_MAX_ITERATIONS;
+constexpr double VtolLinearization::TOLERANCE;
+constexpr double VtolLinearization::HOVER_MAX_AIRSPEED;
+constexpr double VtolLinearization::CRUISE_MIN_AIRSPEED;
+
+static std::vector<size_t> getFreeActuators(TrimMode_t mode){
+    switch(mode){
+        case TRIM_HOVER:
+            return {0, 1, 2, 3};
+        case TRIM_TRANSITION:
+            return {0, 1, 2, 3, 4, 6};
+        case TRIM_CRUISE:
+        default:
+            return {4, 5, 6, 7};
+    }
+}
+
+void VtolLinearization::init(const VtolParameters& params, const TablesWithCoeffs& tables){
+    kernel_.init(params, tables);
+    autoDiffKernel_.init(params, tables);
+    if(params.actuatorMin.size() == CONTROL_SIZE && params.actuatorMax.size() == CONTROL_SIZE){
+        actuatorMin_ = Eigen::Map<const Actuators>(params.actuatorMin.data());
+        actuatorMax_ = Eigen::Map<const Actuators>(params.actuatorMax.data());
+    }
+}
+
+void VtolLinearization::linearize(const RigidBodyState& state,
+                                  const Actuators& actuators,
+                                  LinearModel& model) const{
+    AutoDiffKernel::RigidBodyState adState;
+    AutoDiffKernel::Vector3 attitudeError;
+    AutoDiffKernel::Actuators adActuators;
+    for(size_t idx = 0; idx < 3; idx++){
+        adState.position[idx] = VtolAutoDiff(state.position[idx], DERIVATIVES_AMOUNT, POSITION_IDX + idx);
+        adState.linearVel[idx] = VtolAutoDiff(state.linearVel[idx], DERIVATIVES_AMOUNT, LINEAR_VEL_IDX + idx);
+        attitudeError[idx] = VtolAutoDiff(0.0, DERIVATIVES_AMOUNT, ATTITUDE_IDX + idx);
+        adState.angularVel[idx] = VtolAutoDiff(state.angularVel[idx], DERIVATIVES_AMOUNT, ANGULAR_VEL_IDX + idx);
+    }
+    for(size_t idx = 0; idx < CONTROL_SIZE; idx++){
+        adActuators[idx] = VtolAutoDiff(actuators[idx], DERIVATIVES_AMOUNT, CONTROL_IDX + idx);
+    }
+
+    // exp(error) is linear in the error up to the second order, it is enough for Jacobians
+    AutoDiffKernel::Quaternion errorQuaternion(VtolAutoDiff(1.0),
+                                               VtolAutoDiff(0.5) * attitudeError[0],
+                                               VtolAutoDiff(0.5) * attitudeError[1],
+                                               VtolAutoDiff(0.5) * attitudeError[2]);
+    adState.attitude = state.attitude.cast<VtolAutoDiff>() * errorQuaternion;
+
+    AutoDiffKernel::Vector3 linearAccel, angularAccel;
+    autoDiffKernel_.calculateDerivative(adState, adActuators, linearAccel, angularAccel);
+
+    Eigen::Matrix<VtolAutoDiff, STATE_SIZE, 1> derivative;
+    derivative.segment<3>(POSITION_IDX) = adState.linearVel;
+    derivative.segment<3>(LINEAR_VEL_IDX) = linearAccel;
+    derivative.segment<3>(ATTITUDE_IDX) = adState.angularVel +
+                                          VtolAutoDiff(0.5) * attitudeError.cross(adState.angularVel);
+    derivative.segment<3>(ANGULAR_VEL_IDX) = angularAccel;
+
+    for(size_t row = 0; row < STATE_SIZE; row++){
+        model.stateDerivative[row] = derivative[row].value();
+        model.A.row(row) = derivative[row].derivatives().head<STATE_SIZE>().transpose();
+        model.B.row(row) = derivative[row].derivatives().tail<CONTROL_SIZE>().transpose();
+    }
+}
+
+int8_t VtolLinearization::trim(TrimPoint& point, size_t maxIterations) const{
+    const std::vector<size_t> freeActuators = getFreeActuators(point.mode);
+    const size_t unknownsAmount = 2 + freeActuators.size();
+    RigidBodyState state;
+    Eigen::Matrix<double, 6, 1> residual;
+    Eigen::MatrixXd jacobian(6, unknownsAmount);
+    TrimPoint candidate;
+
+    point.isConverged = false;
+    for(size_t iteration = 0; ; iteration++){
+        calculateState(point, state);
+        linearize(state, point.actuators, point.model);
+        residual << point.model.stateDerivative.segment<3>(LINEAR_VEL_IDX),
+                    point.model.stateDerivative.segment<3>(ANGULAR_VEL_IDX);
+        point.residual = residual.norm();
+        point.isConverged = point.residual < TOLERANCE;
+        if(point.isConverged || iteration >= maxIterations){
+            break;
+        }
+
+        for(size_t col = 0; col < unknownsAmount; col++){
+            Eigen::Matrix<double, STATE_SIZE, 1> source;
+            if(col < 2){
+                source = point.model.A.col(ATTITUDE_IDX + col);
+            }else{
+                source = point.model.B.col(freeActuators[col - 2]);
+            }
+            jacobian.col(col) << source.segment<3>(LINEAR_VEL_IDX), source.segment<3>(ANGULAR_VEL_IDX);
+        }
+        Eigen::VectorXd step = jacobian.completeOrthogonalDecomposition().solve(-residual);
+
+        // backtracking keeps the tables kinks and the actuators limits from a divergence
+        candidate = point;
+        double scale = 1.0;
+        for(size_t halving = 0; halving < MAX_STEP_HALVINGS; halving++, scale *= 0.5){
+            Eigen::Vector3d attitudeStep(scale * step[0], scale * step[1], 0);
+            candidate.attitude = point.attitude * AttitudeIntegration::expMap<double>(attitudeStep);
+            candidate.attitude.normalize();
+            candidate.actuators = point.actuators;
+            for(size_t idx = 0; idx < freeActuators.size(); idx++){
+                candidate.actuators[freeActuators[idx]] += scale * step[2 + idx];
+            }
+            candidate.actuators = candidate.actuators.max(actuatorMin_).min(actuatorMax_);
+            if(calculateResidual(candidate) < point.residual){
+                break;
+            }
+        }
+        point.attitude = candidate.attitude;
+        point.actuators = candidate.actuators;
+    }
+    return point.isConverged ? 0 : -1;
+}
+
+void VtolLinearization::initTrimPoint(TrimPoint& point, double airspeed, double altitude){
+    point.airspeed = airspeed;
+    point.altitude = altitude;
+    point.attitude.setIdentity();
+    point.actuators.setZero();
+    if(airspeed < HOVER_MAX_AIRSPEED){
+        point.mode = TRIM_HOVER;
+        point.actuators.head<4>().setConstant(HOVER_MOTORS_GUESS);
+    }else if(airspeed < CRUISE_MIN_AIRSPEED){
+        point.mode = TRIM_TRANSITION;
+        point.actuators.head<4>().setConstant(HOVER_MOTORS_GUESS);
+        point.actuators[4] = PUSHER_GUESS;
+    }else{
+        point.mode = TRIM_CRUISE;
+        point.actuators[4] = PUSHER_GUESS;
+    }
+}
+
+double VtolLinearization::calculateAirDensity(double seaLevelRho, double altitude){
+    return seaLevelRho * std::pow(1.0 - 2.25577e-5 * altitude, 4.2559);
+}
+
+void VtolLinearization::calculateState(const TrimPoint& point, RigidBodyState& state) const{
+    state.position << 0, 0, -point.altitude;
+    state.linearVel << point.airspeed, 0, 0;
+    state.attitude = point.attitude;
+    state.angularVel.setZero();
+}
+
+double VtolLinearization::calculateResidual(const TrimPoint& point) const{
+    RigidBodyState state;
+    calculateState(point, state);
+    Eigen::Vector3d linearAccel, angularAccel;
+    kernel_.calculateDerivative(state, point.actuators, linearAccel, angularAccel);
+    return std::sqrt(linearAccel.squaredNorm() + angularAccel.squaredNorm());
+}
+
+int8_t sweepTrimPoints(const VtolParameters& params,
+                       const TablesWithCoeffs& tables,
+                       const std::vector<double>& airspeeds,
+                       const std::vector<double>& altitudes,
+                       std::vector<TrimPoint, Eigen::aligned_allocator<TrimPoint>>& points,
+                       size_t threadsAmount){
+    points.resize(airspeeds.size() * altitudes.size());
+    if(points.empty()){
+        return 0;
+    }
+
+    std::vector<std::unique_ptr<VtolLinearization>> linearizations;
+    VtolParameters altitudeParams = params;
+    for(auto altitude : altitudes){
+        altitudeParams.atmoRho = VtolLinearization::calculateAirDensity(params.atmoRho, altitude);
+        linearizations.emplace_back(new VtolLinearization());
+        linearizations.back()->init(altitudeParams, tables);
+    }
+
+    if(threadsAmount == 0){
+        threadsAmount = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    }
+    threadsAmount = std::min(threadsAmount, points.size());
+
+    std::atomic<size_t> nextPoint{0};
+    std::atomic<size_t> failuresAmount{0};
+    auto workerLoop = [&](){
+        for(size_t idx = nextPoint++; idx < points.size(); idx = nextPoint++){
+            size_t altitudeIdx = idx / airspeeds.size();
+            VtolLinearization::initTrimPoint(points[idx], airspeeds[idx % airspeeds.size()],
+                                             altitudes[altitudeIdx]);
+            if(linearizations[altitudeIdx]->trim(points[idx]) == -1){
+                failuresAmount++;
+            }
+        }
+    };
+    std::vector<std::thread> workers;
+    for(size_t idx = 1; idx < threadsAmount; idx++){
+        workers.emplace_back(workerLoop);
+    }
+    workerLoop();
+    for(auto& worker : workers){
+        worker.join();
+    }
+    return (failuresAmount == 0) ? 0 : -1;
+}
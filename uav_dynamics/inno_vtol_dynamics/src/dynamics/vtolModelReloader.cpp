@@ -0,0 +1,183 @@
+/**
+ * @file vtolModelReloader.cpp
+ * @brief Live reload of the vtol model implementation
+ */
+#include <iostream>
+#include <cmath>
+#include <chrono>
+#include <stdexcept>
+#include "vtolModelReloader.hpp"
+#include "paramsSource.hpp"
+#include "aeroTablesCache.hpp"
+
+constexpr double VtolModelReloader::DEFAULT_PERIOD;
+
+static const char VTOL_PARAMS_FILE[] = "/vtol_params.yaml";
+static const char TABLES_FILE[] = "/aerodynamics_coeffs.yaml";
+
+/**
+ * @return true if the first column is strictly increasing or, if allowed, strictly decreasing
+ */
+template<typename Table>
+static bool isColumnSorted(const Table& table, bool isDescendingAllowed = false){
+    auto steps = (table.col(0).tail(table.rows() - 1) - table.col(0).head(table.rows() - 1)).eval();
+    return (steps.array() > 0).all() || (isDescendingAllowed && (steps.array() < 0).all());
+}
+
+VtolModelReloader::~VtolModelReloader(){
+    stop();
+}
+
+int8_t VtolModelReloader::start(const std::string& configDirectory, double periodSec){
+    if(watcher_.joinable()){
+        return -1;
+    }
+    configDirectory_ = configDirectory;
+    paramsChecksum_ = AeroTablesCache::calculateFileChecksum(configDirectory_ + VTOL_PARAMS_FILE);
+    tablesChecksum_ = AeroTablesCache::calculateFileChecksum(configDirectory_ + TABLES_FILE);
+    isStopped_ = false;
+    watcher_ = std::thread(&VtolModelReloader::watcherLoop, this, periodSec);
+    return 0;
+}
+
+void VtolModelReloader::stop(){
+    {
+        std::lock_guard<std::mutex> lock(watcherMutex_);
+        isStopped_ = true;
+    }
+    watcherCondition_.notify_all();
+    if(watcher_.joinable()){
+        watcher_.join();
+    }
+}
+
+void VtolModelReloader::requestReload(){
+    {
+        std::lock_guard<std::mutex> lock(watcherMutex_);
+        isReloadRequested_ = true;
+    }
+    watcherCondition_.notify_all();
+}
+
+int8_t VtolModelReloader::reload(const std::string& configDirectory){
+    YamlParamsSource source;
+    VtolParameters params{};
+    TablesWithCoeffs tables;
+    try{
+        if(source.load(configDirectory + VTOL_PARAMS_FILE, "/uav/vtol_params/") == -1 ||
+                source.load(configDirectory + TABLES_FILE, "/uav/aerodynamics_coeffs/") == -1){
+            throw std::runtime_error("can't read the configs in " + configDirectory);
+        }
+        InnoVtolDynamicsSim::loadParams(source, "/uav/vtol_params/", params);
+        InnoVtolDynamicsSim::loadTables(source, "/uav/aerodynamics_coeffs/", tables);
+    }catch(const std::exception& e){
+        std::cerr << "VtolModelReloader: " << e.what() << ", the model is kept." << std::endl;
+        rejectedAmount_++;
+        return -1;
+    }
+    if(validate(params, tables) == -1){
+        std::cerr << "VtolModelReloader: the model is invalid, it is kept." << std::endl;
+        rejectedAmount_++;
+        return -1;
+    }
+
+    std::unique_ptr<VtolModel> model(new VtolModel());
+    model->params = params;
+    model->kernel.init(params, tables);
+
+    // The replaced models are destroyed out of the lock, so the reader is never delayed by it
+    std::unique_ptr<VtolModel> displacedPending;
+    std::unique_ptr<VtolModel> displacedRetired;
+    {
+        std::lock_guard<std::mutex> lock(slotMutex_);
+        displacedRetired = std::move(retired_);
+        displacedPending = std::move(pending_);
+        pending_ = std::move(model);
+    }
+    publishedAmount_++;
+    return 0;
+}
+
+bool VtolModelReloader::tryTake(VtolParameters& params, VtolDynamicsKernel<double>& kernel){
+    std::unique_lock<std::mutex> lock(slotMutex_, std::try_to_lock);
+    if(!lock.owns_lock() || pending_ == nullptr){
+        return false;
+    }
+    std::swap(params, pending_->params);
+    std::swap(kernel, pending_->kernel);
+    retired_ = std::move(pending_);
+    return true;
+}
+
+int8_t VtolModelReloader::validate(const VtolParameters& params, const TablesWithCoeffs& tables){
+    const char* error = nullptr;
+    if(!(params.mass > 0) || !(params.atmoRho > 0) || !(params.wingArea > 0) ||
+            !(params.characteristicLength > 0) || !std::isfinite(params.gravity)){
+        error = "mass, atmoRho, wingArea and characteristicLength must be positive";
+    }else if(!params.inertia.allFinite() || params.inertia.llt().info() != Eigen::Success){
+        error = "inertia must be positive definite";
+    }else if(params.actuatorMin.size() != 8 || params.actuatorMax.size() != 8 ||
+            !(Eigen::Map<const ActuatorsArray>(params.actuatorMin.data()) <=
+              Eigen::Map<const ActuatorsArray>(params.actuatorMax.data())).all()){
+        error = "actuatorMin and actuatorMax must have 8 elements and min <= max";
+    }else if(!(Eigen::Map<const ActuatorsArray>(tables.actuatorTimeConstants.data()) >= 0).all()){
+        error = "actuatorTimeConstants must be non negative";
+    }
+
+    bool isFinite = true;
+    forEachTable(tables, [&isFinite](const char*, const auto& table){
+        isFinite = isFinite && table.allFinite();
+    });
+    if(error == nullptr && !isFinite){
+        error = "tables must be finite";
+    }else if(error == nullptr && (!isColumnSorted(tables.airspeed) ||
+                                  !isColumnSorted(tables.AoA.transpose()) ||
+                                  !isColumnSorted(tables.AoS, true) ||
+                                  !isColumnSorted(tables.actuator, true) ||
+                                  !isColumnSorted(tables.prop) ||
+                                  !isColumnSorted(tables.CLPolynomial) ||
+                                  !isColumnSorted(tables.CSPolynomial) ||
+                                  !isColumnSorted(tables.CDPolynomial) ||
+                                  !isColumnSorted(tables.CmxPolynomial) ||
+                                  !isColumnSorted(tables.CmyPolynomial) ||
+                                  !isColumnSorted(tables.CmzPolynomial))){
+        error = "lookup columns of the tables must be sorted";
+    }
+
+    if(error != nullptr){
+        std::cerr << "VtolModelReloader: " << error << "." << std::endl;
+        return -1;
+    }
+    return 0;
+}
+
+void VtolModelReloader::watcherLoop(double periodSec){
+    auto period = std::chrono::duration<double>((periodSec > 0) ? periodSec : 1.0);
+
+    std::unique_lock<std::mutex> lock(watcherMutex_);
+    while(!isStopped_){
+        if(periodSec > 0){
+            watcherCondition_.wait_for(lock, period, [this](){return isStopped_ || isReloadRequested_;});
+        }else{
+            watcherCondition_.wait(lock, [this](){return isStopped_ || isReloadRequested_;});
+        }
+        if(isStopped_){
+            break;
+        }
+        bool isRequested = isReloadRequested_;
+        isReloadRequested_ = false;
+        lock.unlock();
+
+        uint64_t paramsChecksum = AeroTablesCache::calculateFileChecksum(configDirectory_ + VTOL_PARAMS_FILE);
+        uint64_t tablesChecksum = AeroTablesCache::calculateFileChecksum(configDirectory_ + TABLES_FILE);
+        if(isRequested || paramsChecksum != paramsChecksum_ || tablesChecksum != tablesChecksum_){
+            paramsChecksum_ = paramsChecksum;
+            tablesChecksum_ = tablesChecksum;
+            if(reload(configDirectory_) == 0){
+                std::cout << "VtolModelReloader: the model is reloaded from " << configDirectory_ << std::endl;
+            }
+        }
+
+        lock.lock();
+    }
+}
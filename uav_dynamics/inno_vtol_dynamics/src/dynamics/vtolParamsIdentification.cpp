@@ -0,0 +1,416 @@
+/**
+ * @file vtolParamsIdentification.cpp
+ * @brief Identification of the aerodynamic tables entries implementation
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <cctype>
+#include <numeric>
+#include <algorithm>
+#include "vtolParamsIdentification.hpp"
+
+constexpr double VtolParamsIdentification::DEFAULT_SEGMENT_DURATION;
+constexpr double VtolParamsIdentification::WARMUP_DURATION;
+constexpr double VtolParamsIdentification::MAX_STEP;
+constexpr double VtolParamsIdentification::ANGULAR_VELOCITY_WEIGHT;
+constexpr size_t VtolParamsIdentification::DEFAULT_MAX_ITERATIONS;
+
+static constexpr size_t LOG_COLUMNS_AMOUNT = 22;
+static constexpr size_t ACTUATORS_AMOUNT = 8;
+
+int8_t loadFlightLog(const std::string& path, FlightLog& log){
+    std::ifstream file(path);
+    if(!file.is_open()){
+        std::cerr << "FlightLog: can't open " << path << std::endl;
+        return -1;
+    }
+
+    log.clear();
+    std::string line;
+    while(std::getline(file, line)){
+        if(line.empty() || !(std::isdigit(line[0]) || line[0] == '-' || line[0] == '.')){
+            continue;
+        }
+        std::replace(line.begin(), line.end(), ',', ' ');
+        std::istringstream stream(line);
+        std::vector<double> columns;
+        double value;
+        while(stream >> value){
+            columns.push_back(value);
+        }
+        if(columns.size() != LOG_COLUMNS_AMOUNT){
+            std::cerr << "FlightLog: wrong columns amount " << columns.size() << " in " << path << std::endl;
+            return -1;
+        }
+
+        FlightLogSample sample;
+        sample.timeSec = columns[0];
+        sample.position << columns[1], columns[2], columns[3];
+        sample.linearVel << columns[4], columns[5], columns[6];
+        sample.attitude = Eigen::Quaterniond(columns[7], columns[8], columns[9], columns[10]).normalized();
+        sample.angularVel << columns[11], columns[12], columns[13];
+        sample.actuators.assign(columns.begin() + 14, columns.end());
+        if(!log.empty() && sample.timeSec <= log.back().timeSec){
+            std::cerr << "FlightLog: time is not increasing in " << path << std::endl;
+            return -1;
+        }
+        log.push_back(sample);
+    }
+    return 0;
+}
+
+int8_t parseTableEntry(const std::string& str, TableEntry& entry){
+    std::istringstream stream(str);
+    std::string row, col;
+    if(!std::getline(stream, entry.table, '/') || !std::getline(stream, row, '/') ||
+       !std::getline(stream, col) || row.empty() || col.empty() ||
+       row.find_first_not_of("0123456789") != std::string::npos ||
+       col.find_first_not_of("0123456789") != std::string::npos){
+        return -1;
+    }
+    entry.row = std::stoul(row);
+    entry.col = std::stoul(col);
+    return 0;
+}
+
+/**
+ * @brief Call visitor with the table of given name
+ * @return false if there is no such table
+ */
+template<typename Visitor>
+static bool visitTable(TablesWithCoeffs& tables, const std::string& name, Visitor visitor){
+    bool isFound = false;
+    forEachTable(tables, [&](const char* tableName, auto& table){
+        if(name == tableName){
+            visitor(table);
+            isFound = true;
+        }
+    });
+    return isFound;
+}
+
+double* getTableEntry(TablesWithCoeffs& tables, const TableEntry& entry){
+    double* value = nullptr;
+    visitTable(tables, entry.table, [&](auto& table){
+        if(entry.row < static_cast<size_t>(table.rows()) && entry.col < static_cast<size_t>(table.cols())){
+            value = &table(entry.row, entry.col);
+        }
+    });
+    return value;
+}
+
+int8_t printTable(std::ostream& os, TablesWithCoeffs& tables, const std::string& name){
+    bool isFound = visitTable(tables, name, [&](auto& table){
+        ///< Column vectors are written in a single line as well as in the yaml
+        const Eigen::Index rows = table.cols() == 1 ? 1 : table.rows();
+        const Eigen::Index cols = table.size() / rows;
+        os.precision(10);
+        os << name << ": [";
+        for(Eigen::Index row = 0; row < rows; row++){
+            for(Eigen::Index col = 0; col < cols; col++){
+                os << (rows == 1 ? table(col) : table(row, col));
+                if(col + 1 != cols || row + 1 != rows){
+                    os << ", ";
+                }
+            }
+            if(row + 1 != rows){
+                os << std::endl << std::string(name.size() + 3, ' ');
+            }
+        }
+        os << "]" << std::endl;
+    });
+    return isFound ? 0 : -1;
+}
+
+double minimizeNelderMead(const std::function<double(const std::vector<double>&)>& cost,
+                          std::vector<double>& x,
+                          const std::vector<double>& initialStep,
+                          size_t maxIterations,
+                          double tolerance){
+    const size_t dimension = x.size();
+    std::vector<std::vector<double>> simplex(dimension + 1, x);
+    std::vector<double> costs(dimension + 1);
+    for(size_t idx = 0; idx < dimension; idx++){
+        simplex[idx + 1][idx] += initialStep[idx];
+    }
+    for(size_t idx = 0; idx <= dimension; idx++){
+        costs[idx] = cost(simplex[idx]);
+    }
+
+    std::vector<size_t> order(dimension + 1);
+    auto pointAlong = [&](const std::vector<double>& centroid, const std::vector<double>& worst, double coeff){
+        std::vector<double> point(dimension);
+        for(size_t idx = 0; idx < dimension; idx++){
+            point[idx] = centroid[idx] + coeff * (worst[idx] - centroid[idx]);
+        }
+        return point;
+    };
+
+    for(size_t iteration = 0; iteration < maxIterations; iteration++){
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b){return costs[a] < costs[b];});
+        const size_t best = order.front(), worst = order.back(), secondWorst = order[dimension - 1];
+        if(std::abs(costs[worst] - costs[best]) <= tolerance * (std::abs(costs[best]) + tolerance)){
+            break;
+        }
+
+        std::vector<double> centroid(dimension, 0.0);
+        for(size_t idx = 0; idx < dimension; idx++){
+            for(size_t dim = 0; dim < dimension; dim++){
+                centroid[dim] += simplex[order[idx]][dim] / dimension;
+            }
+        }
+
+        auto reflected = pointAlong(centroid, simplex[worst], -1.0);
+        double reflectedCost = cost(reflected);
+        if(reflectedCost < costs[best]){
+            auto expanded = pointAlong(centroid, simplex[worst], -2.0);
+            double expandedCost = cost(expanded);
+            bool isExpanded = expandedCost < reflectedCost;
+            simplex[worst] = isExpanded ? expanded : reflected;
+            costs[worst] = isExpanded ? expandedCost : reflectedCost;
+        }else if(reflectedCost < costs[secondWorst]){
+            simplex[worst] = reflected;
+            costs[worst] = reflectedCost;
+        }else{
+            auto contracted = pointAlong(centroid, simplex[worst], 0.5);
+            double contractedCost = cost(contracted);
+            if(contractedCost < costs[worst]){
+                simplex[worst] = contracted;
+                costs[worst] = contractedCost;
+            }else{
+                for(size_t idx = 1; idx <= dimension; idx++){
+                    simplex[order[idx]] = pointAlong(simplex[best], simplex[order[idx]], 0.5);
+                    costs[order[idx]] = cost(simplex[order[idx]]);
+                }
+            }
+        }
+    }
+
+    size_t best = std::min_element(costs.begin(), costs.end()) - costs.begin();
+    x = simplex[best];
+    return costs[best];
+}
+
+/**
+ * @brief Log timestamps are rounded, so a small tolerance keeps the step equal to MAX_STEP
+ * when the log period is a multiple of it
+ */
+static size_t calculateStepsAmount(double dtSecs){
+    constexpr double TOLERANCE = 1e-6;
+    return std::max<size_t>(std::ceil(dtSecs / VtolParamsIdentification::MAX_STEP - TOLERANCE), 1);
+}
+
+VtolParamsIdentification::~VtolParamsIdentification(){
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        isStopped_ = true;
+    }
+    startCondition_.notify_all();
+    for(auto& worker : workers_){
+        if(worker->thread.joinable()){
+            worker->thread.join();
+        }
+    }
+}
+
+int8_t VtolParamsIdentification::init(const ParamsSource& source,
+                                      const FlightLog& log,
+                                      const std::vector<TableEntry>& entries,
+                                      double segmentDurationSec,
+                                      size_t threadsAmount){
+    if(!workers_.empty() || log.size() < 2 || segmentDurationSec <= 0){
+        return -1;
+    }
+    log_ = log;
+    entries_ = entries;
+    for(const auto& sample : log_){
+        if(sample.actuators.size() != ACTUATORS_AMOUNT){
+            return -1;
+        }
+    }
+
+    if(threadsAmount == 0){
+        threadsAmount = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    }
+    for(size_t idx = 0; idx < threadsAmount; idx++){
+        std::unique_ptr<Worker> worker(new Worker);
+        worker->sim.reset(new InnoVtolDynamicsSim);
+        if(worker->sim->init(source) == -1){
+            return -1;
+        }
+        worker->tables.reset(new TablesWithCoeffs(worker->sim->getTables()));
+        worker->sim->init(worker->sim->getParams(), worker->tables);
+        worker->sim->setTurbulenceParameter(0);
+        workers_.push_back(std::move(worker));
+    }
+    tables_ = workers_.front()->sim->getTables();
+    for(const auto& entry : entries_){
+        if(getTableEntry(tables_, entry) == nullptr){
+            std::cerr << "VtolParamsIdentification: wrong entry " << entry.table << "/"
+                      << entry.row << "/" << entry.col << std::endl;
+            return -1;
+        }
+        for(auto& worker : workers_){
+            worker->entries.push_back(getTableEntry(*worker->tables, entry));
+        }
+        initialValues_.push_back(*getTableEntry(tables_, entry));
+    }
+
+    size_t firstSample = 0;
+    while(firstSample + 1 < log_.size() && log_[firstSample].timeSec < log_.front().timeSec + WARMUP_DURATION){
+        firstSample++;
+    }
+    while(firstSample + 1 < log_.size()){
+        Segment segment;
+        segment.firstSample = firstSample;
+        segment.lastSample = firstSample + 1;
+        while(segment.lastSample + 1 < log_.size() &&
+              log_[segment.lastSample + 1].timeSec <= log_[firstSample].timeSec + segmentDurationSec){
+            segment.lastSample++;
+        }
+        warmUp(*workers_.front()->sim, segment);
+        segments_.push_back(segment);
+        firstSample = segment.lastSample;
+    }
+
+    for(auto& worker : workers_){
+        worker->thread = std::thread(&VtolParamsIdentification::workerLoop, this, std::ref(*worker));
+    }
+    return 0;
+}
+
+std::vector<double> VtolParamsIdentification::getInitialValues() const{
+    return initialValues_;
+}
+
+double VtolParamsIdentification::evaluate(const std::vector<double>& values){
+    if(workers_.empty() || values.size() != entries_.size()){
+        return NAN;
+    }
+    for(size_t idx = 0; idx < entries_.size(); idx++){
+        *getTableEntry(tables_, entries_[idx]) = values[idx];
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    nextSegment_ = 0;
+    finishedWorkers_ = 0;
+    generation_++;
+    startCondition_.notify_all();
+    finishCondition_.wait(lock, [this]{return finishedWorkers_ == workers_.size();});
+
+    double residual = 0;
+    size_t samplesAmount = 0;
+    for(const auto& worker : workers_){
+        residual += worker->residual;
+        samplesAmount += worker->samplesAmount;
+    }
+    return samplesAmount == 0 ? 0 : residual / samplesAmount;
+}
+
+double VtolParamsIdentification::identify(std::vector<double>& values, size_t maxIterations){
+    std::vector<double> initialStep(values.size());
+    for(size_t idx = 0; idx < values.size(); idx++){
+        initialStep[idx] = values[idx] != 0 ? 0.1 * values[idx] : 1e-3;
+    }
+    auto cost = [this](const std::vector<double>& x){return evaluate(x);};
+    double residual = minimizeNelderMead(cost, values, initialStep, maxIterations, 1e-9);
+    for(size_t idx = 0; idx < entries_.size(); idx++){
+        *getTableEntry(tables_, entries_[idx]) = values[idx];
+    }
+    return residual;
+}
+
+/**
+ * @brief The wind field clock follows the log too, so a rollout doesn't depend on the
+ * history of the worker
+ */
+void VtolParamsIdentification::pinState(State& state, const FlightLogSample& sample) const{
+    state.windFieldTime = sample.timeSec - log_.front().timeSec;
+    state.position = sample.position;
+    state.linearVel = sample.linearVel;
+    state.attitude = sample.attitude;
+    state.angularVel = sample.angularVel;
+}
+
+/**
+ * @brief The kinematic state is pinned to the log during the warm up, so only the
+ * actuators dynamics converge to the logged commands
+ */
+void VtolParamsIdentification::warmUp(InnoVtolDynamicsSim& sim, Segment& segment) const{
+    size_t sampleIdx = segment.firstSample;
+    while(sampleIdx > 0 && log_[sampleIdx - 1].timeSec >= log_[segment.firstSample].timeSec - WARMUP_DURATION){
+        sampleIdx--;
+    }
+
+    State state = sim.getState();
+    for(; sampleIdx < segment.firstSample; sampleIdx++){
+        pinState(state, log_[sampleIdx]);
+        sim.setState(state);
+        double dtSecs = log_[sampleIdx + 1].timeSec - log_[sampleIdx].timeSec;
+        size_t stepsAmount = calculateStepsAmount(dtSecs);
+        for(size_t step = 0; step < stepsAmount; step++){
+            sim.process(dtSecs / stepsAmount, log_[sampleIdx].actuators, true);
+        }
+        state = sim.getState();
+    }
+    pinState(state, log_[segment.firstSample]);
+    segment.warmState = state;
+}
+
+void VtolParamsIdentification::simulateSegment(InnoVtolDynamicsSim& sim,
+                                               const Segment& segment,
+                                               double& residual,
+                                               size_t& samplesAmount) const{
+    sim.setState(segment.warmState);
+    residual = 0;
+    samplesAmount = 0;
+    for(size_t sampleIdx = segment.firstSample; sampleIdx < segment.lastSample; sampleIdx++){
+        double dtSecs = log_[sampleIdx + 1].timeSec - log_[sampleIdx].timeSec;
+        size_t stepsAmount = calculateStepsAmount(dtSecs);
+        for(size_t step = 0; step < stepsAmount; step++){
+            sim.process(dtSecs / stepsAmount, log_[sampleIdx].actuators, true);
+        }
+        const FlightLogSample& expected = log_[sampleIdx + 1];
+        residual += (sim.getVehicleVelocity() - expected.linearVel).squaredNorm() +
+                    ANGULAR_VELOCITY_WEIGHT * (sim.getVehicleAngularVelocity() - expected.angularVel).squaredNorm();
+        samplesAmount++;
+    }
+}
+
+void VtolParamsIdentification::workerLoop(Worker& worker){
+    uint64_t seenGeneration = 0;
+    while(true){
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            startCondition_.wait(lock, [&]{return isStopped_ || generation_ != seenGeneration;});
+            if(isStopped_){
+                return;
+            }
+            seenGeneration = generation_;
+        }
+
+        ///< The tables are owned by this worker only, so they are updated in place
+        for(size_t idx = 0; idx < entries_.size(); idx++){
+            *worker.entries[idx] = *getTableEntry(tables_, entries_[idx]);
+        }
+        worker.residual = 0;
+        worker.samplesAmount = 0;
+        for(size_t idx = nextSegment_++; idx < segments_.size(); idx = nextSegment_++){
+            double residual;
+            size_t samplesAmount;
+            simulateSegment(*worker.sim, segments_[idx], residual, samplesAmount);
+            worker.residual += residual;
+            worker.samplesAmount += samplesAmount;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            finishedWorkers_++;
+        }
+        finishCondition_.notify_one();
+    }
+}
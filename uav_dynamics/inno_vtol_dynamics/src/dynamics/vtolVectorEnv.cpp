@@ -0,0 +1,346 @@
+/**
+ * @file vtolVectorEnv.cpp
+ * @brief Vectorized environment for reinforcement learning implementation
+ */
+
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <new>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "vtolVectorEnv.hpp"
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "The ring requires lock-free 64-bit atomics in shared memory");
+
+constexpr uint64_t VectorEnvRing::MAGIC;
+constexpr uint32_t VectorEnvRing::VERSION;
+constexpr size_t VectorEnvRing::ALIGNMENT;
+constexpr size_t VtolVectorEnv::ACTIONS_SIZE;
+constexpr size_t VtolVectorEnv::OBSERVATIONS_SIZE;
+constexpr double VtolVectorEnv::DEFAULT_DT;
+constexpr uint32_t VtolVectorEnv::SERVE_POLL_PERIOD_MS;
+
+static size_t alignUp(size_t value, size_t alignment){
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+/**
+ * @brief Spin for the low latency first, then sleep to not burn the core while idle
+ */
+template<class Predicate>
+static bool waitFor(Predicate predicate, uint32_t timeoutMs){
+    constexpr size_t SPINS_AMOUNT = 10000;
+    for(size_t idx = 0; idx < SPINS_AMOUNT; idx++){
+        if(predicate()){
+            return true;
+        }
+    }
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while(!predicate()){
+        if(std::chrono::steady_clock::now() > deadline){
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+    return true;
+}
+
+VectorEnvRing::~VectorEnvRing(){
+    close();
+}
+
+int8_t VectorEnvRing::create(const std::string& name,
+                             uint32_t slotsAmount,
+                             uint32_t envsAmount,
+                             uint32_t actionsSize,
+                             uint32_t observationsSize){
+    if(header_ != nullptr || slotsAmount == 0 || envsAmount == 0){
+        return -1;
+    }
+    const size_t actionsOffset = 0;
+    const size_t observationsOffset = alignUp(actionsOffset + envsAmount * actionsSize * sizeof(double), ALIGNMENT);
+    const size_t resetFlagsOffset = alignUp(observationsOffset + envsAmount * observationsSize * sizeof(double), ALIGNMENT);
+    const size_t slotSize = alignUp(resetFlagsOffset + envsAmount, ALIGNMENT);
+    const size_t size = alignUp(sizeof(Header), ALIGNMENT) + slotsAmount * slotSize;
+
+    if(map(name, size, true) == -1){
+        return -1;
+    }
+    header_ = new (header_) Header;
+    header_->version = VERSION;
+    header_->slotsAmount = slotsAmount;
+    header_->envsAmount = envsAmount;
+    header_->actionsSize = actionsSize;
+    header_->observationsSize = observationsSize;
+    header_->reserved = 0;
+    header_->slotSize = slotSize;
+    header_->actionsOffset = actionsOffset;
+    header_->observationsOffset = observationsOffset;
+    header_->resetFlagsOffset = resetFlagsOffset;
+    header_->requestsAmount.store(0);
+    header_->responsesAmount.store(0);
+    std::atomic_thread_fence(std::memory_order_release);
+    header_->magic = MAGIC;
+    return 0;
+}
+
+int8_t VectorEnvRing::open(const std::string& name){
+    if(header_ != nullptr){
+        return -1;
+    }
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    if(fd < 0){
+        return -1;
+    }
+    struct stat fileStat;
+    bool isValid = fstat(fd, &fileStat) == 0 && static_cast<size_t>(fileStat.st_size) >= sizeof(Header);
+    ::close(fd);
+    if(!isValid || map(name, fileStat.st_size, false) == -1){
+        return -1;
+    }
+    if(header_->magic != MAGIC || header_->version != VERSION ||
+       alignUp(sizeof(Header), ALIGNMENT) + header_->slotsAmount * header_->slotSize > size_){
+        std::cerr << "VectorEnvRing: " << name << " is not a valid ring" << std::endl;
+        close();
+        return -1;
+    }
+    return 0;
+}
+
+int8_t VectorEnvRing::map(const std::string& name, size_t size, bool isCreated){
+    int fd = isCreated ? shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600) :
+                         shm_open(name.c_str(), O_RDWR, 0);
+    if(fd < 0){
+        std::cerr << "VectorEnvRing: can't open shared memory " << name << std::endl;
+        return -1;
+    }
+    if(isCreated && ftruncate(fd, size) != 0){
+        ::close(fd);
+        shm_unlink(name.c_str());
+        return -1;
+    }
+    void* mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if(mapped == MAP_FAILED){
+        if(isCreated){
+            shm_unlink(name.c_str());
+        }
+        return -1;
+    }
+    header_ = static_cast<Header*>(mapped);
+    size_ = size;
+    name_ = name;
+    isOwner_ = isCreated;
+    return 0;
+}
+
+void VectorEnvRing::close(){
+    if(header_ == nullptr){
+        return;
+    }
+    munmap(header_, size_);
+    if(isOwner_){
+        shm_unlink(name_.c_str());
+    }
+    header_ = nullptr;
+    size_ = 0;
+    isOwner_ = false;
+}
+
+uint8_t* VectorEnvRing::getSlot(uint64_t request){
+    return reinterpret_cast<uint8_t*>(header_) + alignUp(sizeof(Header), ALIGNMENT) +
+           (request % header_->slotsAmount) * header_->slotSize;
+}
+
+double* VectorEnvRing::getActions(uint64_t request){
+    return reinterpret_cast<double*>(getSlot(request) + header_->actionsOffset);
+}
+
+double* VectorEnvRing::getObservations(uint64_t request){
+    return reinterpret_cast<double*>(getSlot(request) + header_->observationsOffset);
+}
+
+uint8_t* VectorEnvRing::getResetFlags(uint64_t request){
+    return getSlot(request) + header_->resetFlagsOffset;
+}
+
+uint64_t VectorEnvRing::getRequestsAmount() const{
+    return header_->requestsAmount.load(std::memory_order_acquire);
+}
+
+bool VectorEnvRing::waitFreeSlot(uint64_t request, uint32_t timeoutMs){
+    return waitFor([&]{
+        return header_->responsesAmount.load(std::memory_order_acquire) + header_->slotsAmount > request;
+    }, timeoutMs);
+}
+
+void VectorEnvRing::publishRequest(){
+    header_->requestsAmount.fetch_add(1, std::memory_order_release);
+}
+
+bool VectorEnvRing::waitResponse(uint64_t request, uint32_t timeoutMs){
+    return waitFor([&]{
+        return header_->responsesAmount.load(std::memory_order_acquire) > request;
+    }, timeoutMs);
+}
+
+bool VectorEnvRing::waitRequest(uint64_t& request, uint32_t timeoutMs){
+    request = header_->responsesAmount.load(std::memory_order_relaxed);
+    return waitFor([&]{
+        return header_->requestsAmount.load(std::memory_order_acquire) > request;
+    }, timeoutMs);
+}
+
+void VectorEnvRing::publishResponse(){
+    header_->responsesAmount.fetch_add(1, std::memory_order_release);
+}
+
+
+VtolVectorEnv::~VtolVectorEnv(){
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        isStopped_ = true;
+    }
+    startCondition_.notify_all();
+    for(auto& worker : workers_){
+        if(worker->thread.joinable()){
+            worker->thread.join();
+        }
+    }
+}
+
+int8_t VtolVectorEnv::init(const ParamsSource& source,
+                           size_t envsAmount,
+                           double dtSecs,
+                           size_t substepsAmount,
+                           size_t threadsAmount){
+    if(!envs_.empty() || envsAmount == 0 || dtSecs <= 0 || substepsAmount == 0){
+        return -1;
+    }
+    substepDt_ = dtSecs / substepsAmount;
+    substepsAmount_ = substepsAmount;
+
+    std::unique_ptr<InnoVtolDynamicsSim> firstEnv(new InnoVtolDynamicsSim);
+    if(firstEnv->init(source) == -1){
+        return -1;
+    }
+    firstEnv->setInitialPosition(Eigen::Vector3d::Zero(), Eigen::Quaterniond::Identity());
+    snapshot_ = firstEnv->getState();
+    seed_ = firstEnv->getParams().turbulenceSeed;
+    envs_.push_back(std::move(firstEnv));
+    for(size_t idx = 1; idx < envsAmount; idx++){
+        std::unique_ptr<InnoVtolDynamicsSim> env(new InnoVtolDynamicsSim);
+        env->init(envs_.front()->getParams(), envs_.front()->getSharedTables());
+        envs_.push_back(std::move(env));
+    }
+    episodes_.assign(envsAmount, 0);
+    resetAll();
+
+    if(threadsAmount == 0){
+        threadsAmount = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    }
+    threadsAmount = std::min(threadsAmount, envsAmount);
+    for(size_t idx = 0; idx < threadsAmount; idx++){
+        std::unique_ptr<Worker> worker(new Worker);
+        worker->firstEnv = envsAmount * idx / threadsAmount;
+        worker->lastEnv = envsAmount * (idx + 1) / threadsAmount;
+        worker->command.resize(ACTIONS_SIZE);
+        workers_.push_back(std::move(worker));
+    }
+    for(auto& worker : workers_){
+        worker->thread = std::thread(&VtolVectorEnv::workerLoop, this, std::ref(*worker));
+    }
+    return 0;
+}
+
+void VtolVectorEnv::setSnapshot(const State& snapshot){
+    snapshot_ = snapshot;
+}
+
+void VtolVectorEnv::reset(size_t envIdx){
+    std::seed_seq sequence{seed_, static_cast<uint32_t>(envIdx), episodes_[envIdx]++};
+    uint32_t seed;
+    sequence.generate(&seed, &seed + 1);
+    envs_[envIdx]->setState(snapshot_);
+    envs_[envIdx]->setNoiseSeed(seed);
+}
+
+void VtolVectorEnv::resetAll(){
+    for(size_t idx = 0; idx < envs_.size(); idx++){
+        reset(idx);
+    }
+}
+
+void VtolVectorEnv::step(const double* actions, double* observations, const uint8_t* resetFlags){
+    std::unique_lock<std::mutex> lock(mutex_);
+    actions_ = actions;
+    observations_ = observations;
+    resetFlags_ = resetFlags;
+    finishedWorkers_ = 0;
+    generation_++;
+    startCondition_.notify_all();
+    finishCondition_.wait(lock, [this]{return finishedWorkers_ == workers_.size();});
+}
+
+void VtolVectorEnv::getObservations(double* observations) const{
+    for(size_t idx = 0; idx < envs_.size(); idx++){
+        envs_[idx]->getStateVector(observations + idx * OBSERVATIONS_SIZE);
+    }
+}
+
+int8_t VtolVectorEnv::serve(VectorEnvRing& ring, const std::atomic<bool>& isRunning){
+    if(ring.getEnvsAmount() != envs_.size() ||
+       ring.getActionsSize() != ACTIONS_SIZE ||
+       ring.getObservationsSize() != OBSERVATIONS_SIZE){
+        return -1;
+    }
+    while(isRunning){
+        uint64_t request;
+        if(!ring.waitRequest(request, SERVE_POLL_PERIOD_MS)){
+            continue;
+        }
+        step(ring.getActions(request), ring.getObservations(request), ring.getResetFlags(request));
+        ring.publishResponse();
+    }
+    return 0;
+}
+
+void VtolVectorEnv::stepChunk(Worker& worker){
+    for(size_t envIdx = worker.firstEnv; envIdx < worker.lastEnv; envIdx++){
+        InnoVtolDynamicsSim& env = *envs_[envIdx];
+        if(resetFlags_ != nullptr && resetFlags_[envIdx] != 0){
+            reset(envIdx);
+        }
+        const double* action = actions_ + envIdx * ACTIONS_SIZE;
+        worker.command.assign(action, action + ACTIONS_SIZE);
+        for(size_t substep = 0; substep < substepsAmount_; substep++){
+            env.process(substepDt_, worker.command, false);
+        }
+        env.getStateVector(observations_ + envIdx * OBSERVATIONS_SIZE);
+    }
+}
+
+void VtolVectorEnv::workerLoop(Worker& worker){
+    uint64_t seenGeneration = 0;
+    while(true){
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            startCondition_.wait(lock, [&]{return isStopped_ || generation_ != seenGeneration;});
+            if(isStopped_){
+                return;
+            }
+            seenGeneration = generation_;
+        }
+
+        stepChunk(worker);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            finishedWorkers_++;
+        }
+        finishCondition_.notify_one();
+    }
+}
@@ -0,0 +1,198 @@
+/**
+ * @file windField.cpp
+ * @brief Precomputed wind field implementation
+ */
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+#include <boost/algorithm/clamp.hpp>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "windField.hpp"
+
+constexpr uint32_t WindField::VERSION;
+constexpr uint32_t WindField::BRICK_SIZE;
+
+static const char MAGIC[4] = {'W', 'F', 'L', 'D'};
+static const size_t NODES_PER_BRICK = 64;
+static const size_t COMPONENTS = 3;
+
+/**
+ * @brief Spread 2 lower bits of value, so they occupy bits 0 and 3
+ */
+static inline size_t spreadBits(uint32_t value){
+    return (value & 1) | ((value & 2) << 2);
+}
+
+WindField::~WindField(){
+    close();
+}
+
+int8_t WindField::open(const std::string& path){
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0){
+        std::cerr << "WindField: can't open " << path << std::endl;
+        return -1;
+    }
+    struct stat fileStat;
+    if(fstat(fd, &fileStat) != 0 || static_cast<size_t>(fileStat.st_size) < sizeof(Header)){
+        std::cerr << "WindField: " << path << " is too small" << std::endl;
+        ::close(fd);
+        return -1;
+    }
+    void* mapped = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if(mapped == MAP_FAILED){
+        std::cerr << "WindField: mmap of " << path << " failed" << std::endl;
+        return -1;
+    }
+
+    const Header* header = static_cast<const Header*>(mapped);
+    const WindFieldGrid& grid = header->grid;
+    bool isHeaderValid = memcmp(header->magic, MAGIC, sizeof(MAGIC)) == 0 &&
+                         header->version == VERSION &&
+                         grid.size[0] >= 2 && grid.size[1] >= 2 && grid.size[2] >= 2 &&
+                         grid.timeFrames >= 1 &&
+                         grid.spacing[0] > 0 && grid.spacing[1] > 0 && grid.spacing[2] > 0 &&
+                         (grid.timeFrames == 1 || grid.timeStep > 0);
+    size_t expectedSize = isHeaderValid ?
+        sizeof(Header) + calculateFrameSize(grid) * grid.timeFrames * sizeof(float) : 0;
+    if(!isHeaderValid || static_cast<size_t>(fileStat.st_size) != expectedSize){
+        std::cerr << "WindField: " << path << " has wrong format or version" << std::endl;
+        munmap(mapped, fileStat.st_size);
+        return -1;
+    }
+
+    grid_ = grid;
+    mapped_ = mapped;
+    mappedSize_ = fileStat.st_size;
+    data_ = reinterpret_cast<const float*>(static_cast<const uint8_t*>(mapped) + sizeof(Header));
+    frameSize_ = calculateFrameSize(grid_);
+    return 0;
+}
+
+void WindField::close(){
+    if(mapped_ != nullptr){
+        munmap(mapped_, mappedSize_);
+    }
+    mapped_ = nullptr;
+    mappedSize_ = 0;
+    data_ = nullptr;
+    frameSize_ = 0;
+}
+
+bool WindField::isLoaded() const{
+    return data_ != nullptr;
+}
+
+const WindFieldGrid& WindField::getGrid() const{
+    return grid_;
+}
+
+Eigen::Vector3d WindField::sample(const Eigen::Vector3d& position, double timeSec) const{
+    if(!isLoaded()){
+        return Eigen::Vector3d::Zero();
+    }
+
+    uint32_t idx[3];
+    double t[3];
+    for(size_t axis = 0; axis < 3; axis++){
+        double maxCoord = grid_.size[axis] - 1.0;
+        double coord = (position[axis] - grid_.origin[axis]) / grid_.spacing[axis];
+        coord = boost::algorithm::clamp(coord, 0.0, maxCoord);
+        double cell = std::min(std::floor(coord), maxCoord - 1.0);
+        idx[axis] = static_cast<uint32_t>(cell);
+        t[axis] = coord - cell;
+    }
+
+    if(grid_.timeFrames == 1){
+        return sampleFrame(data_, idx, t);
+    }
+    double maxFrame = grid_.timeFrames - 1.0;
+    double frame = boost::algorithm::clamp(timeSec / grid_.timeStep, 0.0, maxFrame);
+    double frameIdx = std::min(std::floor(frame), maxFrame - 1.0);
+    double frameT = frame - frameIdx;
+    const float* first = data_ + static_cast<size_t>(frameIdx) * frameSize_;
+    Eigen::Vector3d wind = sampleFrame(first, idx, t) * (1 - frameT);
+    if(frameT > 0){
+        wind += sampleFrame(first + frameSize_, idx, t) * frameT;
+    }
+    return wind;
+}
+
+Eigen::Vector3d WindField::sampleFrame(const float* frame, const uint32_t idx[3], const double t[3]) const{
+    Eigen::Vector3d result = Eigen::Vector3d::Zero();
+    for(uint32_t corner = 0; corner < 8; corner++){
+        uint32_t dx = corner & 1, dy = (corner >> 1) & 1, dz = (corner >> 2) & 1;
+        double weight = (dx ? t[0] : 1 - t[0]) * (dy ? t[1] : 1 - t[1]) * (dz ? t[2] : 1 - t[2]);
+        const float* node = frame + calculateNodeOffset(grid_, idx[0] + dx, idx[1] + dy, idx[2] + dz);
+        result[0] += weight * node[0];
+        result[1] += weight * node[1];
+        result[2] += weight * node[2];
+    }
+    return result;
+}
+
+size_t WindField::calculateFrameSize(const WindFieldGrid& grid){
+    size_t bricks = 1;
+    for(size_t axis = 0; axis < 3; axis++){
+        bricks *= (grid.size[axis] + BRICK_SIZE - 1) / BRICK_SIZE;
+    }
+    return bricks * NODES_PER_BRICK * COMPONENTS;
+}
+
+size_t WindField::calculateNodeOffset(const WindFieldGrid& grid, uint32_t x, uint32_t y, uint32_t z){
+    size_t bricksX = (grid.size[0] + BRICK_SIZE - 1) / BRICK_SIZE;
+    size_t bricksY = (grid.size[1] + BRICK_SIZE - 1) / BRICK_SIZE;
+    size_t brick = (z / BRICK_SIZE * bricksY + y / BRICK_SIZE) * bricksX + x / BRICK_SIZE;
+    size_t morton = spreadBits(x % BRICK_SIZE) |
+                    (spreadBits(y % BRICK_SIZE) << 1) |
+                    (spreadBits(z % BRICK_SIZE) << 2);
+    return (brick * NODES_PER_BRICK + morton) * COMPONENTS;
+}
+
+int8_t WindField::generate(const std::string& path,
+                           const WindFieldGrid& grid,
+                           const std::function<Eigen::Vector3d(const Eigen::Vector3d&, double)>& windAt){
+    Header header;
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.grid = grid;
+
+    size_t frameSize = calculateFrameSize(grid);
+    std::vector<float> frame(frameSize);
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if(!file){
+        std::cerr << "WindField: can't create " << path << std::endl;
+        return -1;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    for(uint32_t frameIdx = 0; frameIdx < grid.timeFrames; frameIdx++){
+        std::fill(frame.begin(), frame.end(), 0.0f);
+        double time = frameIdx * grid.timeStep;
+        for(uint32_t z = 0; z < grid.size[2]; z++){
+            for(uint32_t y = 0; y < grid.size[1]; y++){
+                for(uint32_t x = 0; x < grid.size[0]; x++){
+                    Eigen::Vector3d position(grid.origin[0] + x * grid.spacing[0],
+                                             grid.origin[1] + y * grid.spacing[1],
+                                             grid.origin[2] + z * grid.spacing[2]);
+                    Eigen::Vector3d wind = windAt(position, time);
+                    float* node = &frame[calculateNodeOffset(grid, x, y, z)];
+                    node[0] = wind[0];
+                    node[1] = wind[1];
+                    node[2] = wind[2];
+                }
+            }
+        }
+        file.write(reinterpret_cast<const char*>(frame.data()), frameSize * sizeof(float));
+    }
+    return file ? 0 : -1;
+}
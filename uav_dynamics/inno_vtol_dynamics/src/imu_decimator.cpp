@@ -0,0 +1,103 @@
+/**
+ * @file imu_decimator.cpp
+ * @brief IMU oversampling and decimation implementation
+ */
+
+#include <cmath>
+#include <numeric>
+#include <algorithm>
+#include "imu_decimator.hpp"
+
+constexpr size_t ImuDecimator::DEFAULT_CIC_ORDER;
+constexpr size_t ImuDecimator::CHANNELS;
+
+int8_t ImuDecimator::init(double inputRate, double outputRate, size_t cicOrder){
+    if(inputRate <= 0 || outputRate <= 0){
+        return -1;
+    }
+    size_t ratio = std::max<long>(std::lround(inputRate / outputRate), 1);
+
+    std::vector<double> impulseResponse(1, 1.0);
+    for(size_t stage = 0; stage < cicOrder; stage++){
+        std::vector<double> convolved(impulseResponse.size() + ratio - 1, 0.0);
+        for(size_t idx = 0; idx < impulseResponse.size(); idx++){
+            for(size_t boxIdx = 0; boxIdx < ratio; boxIdx++){
+                convolved[idx + boxIdx] += impulseResponse[idx];
+            }
+        }
+        impulseResponse = std::move(convolved);
+    }
+    double gain = std::accumulate(impulseResponse.begin(), impulseResponse.end(), 0.0);
+
+    taps_.resize(impulseResponse.size());
+    for(size_t idx = 0; idx < taps_.size(); idx++){
+        taps_[taps_.size() - 1 - idx] = impulseResponse[idx] / gain;
+    }
+    for(auto& channel : history_){
+        channel.assign(2 * taps_.size(), 0.0f);
+    }
+    head_ = 0;
+    isEmpty_ = true;
+    deltaVelocity_.setZero();
+    deltaAngle_.setZero();
+    deltaTime_ = 0;
+    return 0;
+}
+
+void ImuDecimator::push(const Eigen::Vector3d& accFrd, const Eigen::Vector3d& gyroFrd, double dtSecs){
+    if(taps_.empty()){
+        return;
+    }
+    const float sample[CHANNELS] = {static_cast<float>(accFrd[0]),
+                                    static_cast<float>(accFrd[1]),
+                                    static_cast<float>(accFrd[2]),
+                                    static_cast<float>(gyroFrd[0]),
+                                    static_cast<float>(gyroFrd[1]),
+                                    static_cast<float>(gyroFrd[2])};
+    const size_t length = taps_.size();
+
+    ///< The filter starts from the steady state instead of a ramp from zero
+    if(isEmpty_){
+        for(size_t channel = 0; channel < CHANNELS; channel++){
+            std::fill(history_[channel].begin(), history_[channel].end(), sample[channel]);
+        }
+        isEmpty_ = false;
+    }
+
+    ///< Each sample is stored twice, so the window [head, head + length) is always contiguous
+    for(size_t channel = 0; channel < CHANNELS; channel++){
+        history_[channel][head_] = sample[channel];
+        history_[channel][head_ + length] = sample[channel];
+    }
+    head_ = (head_ + 1) % length;
+
+    deltaVelocity_ += accFrd * dtSecs;
+    deltaAngle_ += gyroFrd * dtSecs;
+    deltaTime_ += dtSecs;
+}
+
+void ImuDecimator::getFiltered(Eigen::Vector3d& accFrd, Eigen::Vector3d& gyroFrd) const{
+    const size_t length = taps_.size();
+    float output[CHANNELS] = {0};
+    if(length != 0){
+        for(size_t channel = 0; channel < CHANNELS; channel++){
+            const float* window = &history_[channel][head_];
+            float sum = 0;
+            for(size_t idx = 0; idx < length; idx++){
+                sum += taps_[idx] * window[idx];
+            }
+            output[channel] = sum;
+        }
+    }
+    accFrd << output[0], output[1], output[2];
+    gyroFrd << output[3], output[4], output[5];
+}
+
+void ImuDecimator::popDeltas(Eigen::Vector3d& deltaVelocity, Eigen::Vector3d& deltaAngle, double& dtSecs){
+    deltaVelocity = deltaVelocity_;
+    deltaAngle = deltaAngle_;
+    dtSecs = deltaTime_;
+    deltaVelocity_.setZero();
+    deltaAngle_.setZero();
+    deltaTime_ = 0;
+}
@@ -8,8 +8,9 @@
  * @brief Implementation of UAV dynamics, IMU, and angular rate control simulation node
  */
 
+#include <algorithm>
 #include <rosgraph_msgs/Clock.h>
-#include <visualization_msgs/Marker.h>
+#include <visualization_msgs/MarkerArray.h>
 #include <geometry_msgs/TransformStamped.h>
 #include <geometry_msgs/TwistStamped.h>
 #include <geometry_msgs/Twist.h>
@@ -28,6 +29,7 @@
 #include "vtolDynamicsSim.hpp"
 #include "cs_converter.hpp"
 #include "sensors_isa_model.hpp"
+#include "ros_params_source.hpp"
 
 
 static char GLOBAL_FRAME_ID[] = "world";
@@ -45,6 +47,38 @@ const std::string MOTOR_NAMES[5] = {"motor0",
                                     "motor3",
                                     "ICE"};
 
+/**
+ * @brief Markers in ForceMarker_t order, the forces are scaled down to fit the vehicle size
+ */
+struct ForceMarkerDescription{
+    const char* name;
+    const char* frameId;
+    double scale;
+    float color[3];
+};
+static const ForceMarkerDescription FORCE_MARKERS[] = {
+    {"Ftotal",              UAV_FRAME_ID,   1.0,    {0.0, 1.0, 1.0}},
+    {"Faero",               UAV_FRAME_ID,   0.1,    {0.0, 0.5, 0.5}},
+    {"Fmotor0",             "motor0",       0.1,    {0.0, 0.5, 0.5}},
+    {"Fmotor1",             "motor1",       0.1,    {0.0, 0.5, 0.5}},
+    {"Fmotor2",             "motor2",       0.1,    {0.0, 0.5, 0.5}},
+    {"Fmotor3",             "motor3",       0.1,    {0.0, 0.5, 0.5}},
+    {"Fmotor4",             "ICE",          0.1,    {0.0, 0.5, 0.5}},
+    {"liftForce",           UAV_FRAME_ID,   0.1,    {0.8, 0.2, 0.3}},
+    {"drugForce",           UAV_FRAME_ID,   0.1,    {0.2, 0.8, 0.3}},
+    {"sideForce",           UAV_FRAME_ID,   0.1,    {0.2, 0.3, 0.8}},
+    {"Mtotal",              UAV_FRAME_ID,   1.0,    {0.5, 0.5, 0.0}},
+    {"Maero",               UAV_FRAME_ID,   1.0,    {0.5, 0.5, 0.0}},
+    {"McontrolSurfaces",    UAV_FRAME_ID,   1.0,    {0.5, 0.5, 0.0}},
+    {"Maoa",                UAV_FRAME_ID,   1.0,    {0.5, 0.5, 0.0}},
+    {"Mmotor0",             "motor0",       1.0,    {0.5, 0.5, 0.0}},
+    {"Mmotor1",             "motor1",       1.0,    {0.5, 0.5, 0.0}},
+    {"Mmotor2",             "motor2",       1.0,    {0.5, 0.5, 0.0}},
+    {"Mmotor3",             "motor3",       1.0,    {0.5, 0.5, 0.0}},
+    {"Mmotor4",             "ICE",          1.0,    {0.5, 0.5, 0.0}},
+    {"linearVelocity",      UAV_FRAME_ID,   1.0,    {0.7, 0.5, 1.3}},
+};
+
 int main(int argc, char **argv){
     ros::init(argc, argv, "innopolis_vtol_dynamics_node");
     if( ros::console::set_logger_level(ROSCONSOLE_DEFAULT_NAME, ros::console::levels::Info) ) {
@@ -116,6 +150,12 @@ int8_t Uav_Dynamics::getParamsFromRos(){
         ROS_ERROR("Dynamics: There is no at least one of required simulator parameters.");
         return -1;
     }
+    ros::param::get(SIM_PARAMS_PATH + "imu_oversampling",       isImuOversamplingEnabled_);
+    ros::param::get(SIM_PARAMS_PATH + "imu_cic_order",          imuCicOrder_);
+    ros::param::get(SIM_PARAMS_PATH + "state_export_shm_name",  stateExportShmName_);
+    ros::param::get(SIM_PARAMS_PATH + "markers_rate",           markersRate_);
+    ros::param::get(SIM_PARAMS_PATH + "markers_disabled",       disabledMarkers_);
+    ros::param::get(SIM_PARAMS_PATH + "model_reload_period",    modelReloadPeriod_);
     return 0;
 }
 
@@ -146,22 +186,39 @@ int8_t Uav_Dynamics::initDynamicsSimulator(){
         return -1;
     }
 
-    if(uavDynamicsSim_ == nullptr || uavDynamicsSim_->init() == -1){
+    if(uavDynamicsSim_ == nullptr || uavDynamicsSim_->init(RosParamsSource()) == -1){
         ROS_ERROR("Can't init uav dynamics sim. Shutdown.");
         return -1;
     }
     geodeticConverter_.initialiseReference(latRef_, lonRef_, altRef_);
+    magFieldCache_.init(latRef_, lonRef_, altRef_);
 
     Eigen::Vector3d initPosition(initPose_.at(0), initPose_.at(1), initPose_.at(2));
     Eigen::Quaterniond initAttitude(initPose_.at(6), initPose_.at(3), initPose_.at(4), initPose_.at(5));
     initAttitude.normalize();
     uavDynamicsSim_->setInitialPosition(initPosition, initAttitude);
 
+    if(dynamicsType_ == DYNAMICS_INNO_VTOL && modelReloadPeriod_ >= 0){
+        static_cast<InnoVtolDynamicsSim*>(uavDynamicsSim_)->setModelReloader(&modelReloader_);
+        modelReloader_.start(RosParamsSource().getConfigDirectory(), modelReloadPeriod_);
+        modelReloadSub_ = node_.subscribe("/uav/reload_model", 1, &Uav_Dynamics::modelReloadCallback, this);
+        ROS_INFO_STREAM("Dynamics: the vtol model is reloaded on the configs change or /uav/reload_model");
+    }
+
+    if(!stateExportShmName_.empty()){
+        if(stateExport_.create(stateExportShmName_) == -1){
+            ROS_ERROR_STREAM("Dynamics: can't export state into " << stateExportShmName_);
+            return -1;
+        }
+        ROS_INFO_STREAM("Dynamics: state is exported into /dev/shm" << stateExportShmName_);
+    }
+
     return 0;
 }
 
 int8_t Uav_Dynamics::initMainCommunicatorSensors(){
     static constexpr char IMU_TOPIC_NAME[]                 = "/uav/imu";
+    static constexpr char IMU_DELTA_TOPIC_NAME[]           = "/uav/imu_delta";
     static constexpr char MAG_TOPIC_NAME[]                 = "/uav/mag";
     static constexpr char GPS_POSE_TOPIC_NAME[]            = "/uav/gps_position";
     static constexpr char ATTITUDE_TOPIC_NAME[]            = "/uav/attitude";
@@ -176,15 +233,30 @@ int8_t Uav_Dynamics::initMainCommunicatorSensors(){
     actuatorsSub_ = node_.subscribe(ACTUATOR_TOPIC_NAME, 1, &Uav_Dynamics::actuatorsCallback, this);
     armSub_ = node_.subscribe(ARM_TOPIC_NAME, 1, &Uav_Dynamics::armCallback, this);
 
-    imuPub_ = node_.advertise<sensor_msgs::Imu>(IMU_TOPIC_NAME, 96);
-    gpsPositionPub_ = node_.advertise<uavcan_msgs::Fix>(GPS_POSE_TOPIC_NAME, 1);
-    attitudePub_ = node_.advertise<geometry_msgs::QuaternionStamped>(ATTITUDE_TOPIC_NAME, 1);
-    speedPub_ = node_.advertise<geometry_msgs::Twist>(VELOCITY_TOPIC_NAME, 1);
-    magPub_ = node_.advertise<sensor_msgs::MagneticField>(MAG_TOPIC_NAME, 1);
+    imuPub_.advertise<sensor_msgs::Imu>(node_, IMU_TOPIC_NAME, 96);
+    gpsPositionPub_.advertise<uavcan_msgs::Fix>(node_, GPS_POSE_TOPIC_NAME, 1);
+    attitudePub_.advertise<geometry_msgs::QuaternionStamped>(node_, ATTITUDE_TOPIC_NAME, 1);
+    speedPub_.advertise<geometry_msgs::Twist>(node_, VELOCITY_TOPIC_NAME, 1);
+    magPub_.advertise<sensor_msgs::MagneticField>(node_, MAG_TOPIC_NAME, 1);
+
+    rawAirDataPub_.advertise<uavcan_msgs::RawAirData>(node_, RAW_AIR_DATA_TOPIC_NAME, 1);
+    staticTemperaturePub_.advertise<uavcan_msgs::StaticTemperature>(node_, STATIC_TEMPERATURE_TOPIC_NAME, 1);
+    staticPressurePub_.advertise<uavcan_msgs::StaticPressure>(node_, STATIC_PRESSURE_TOPIC_NAME, 1);
+
+    for(size_t sensorType = 0; sensorType <= SENSOR_STATIC_TEMPERATURE; sensorType++){
+        sensorScheduler_.addSensor(sensorType, periodicSensors_[sensorType].period);
+    }
 
-    rawAirDataPub_ = node_.advertise<uavcan_msgs::RawAirData>(RAW_AIR_DATA_TOPIC_NAME, 1);
-    staticTemperaturePub_ = node_.advertise<uavcan_msgs::StaticTemperature>(STATIC_TEMPERATURE_TOPIC_NAME, 1);
-    staticPressurePub_ = node_.advertise<uavcan_msgs::StaticPressure>(STATIC_PRESSURE_TOPIC_NAME, 1);
+    if(isImuOversamplingEnabled_){
+        if(imuCicOrder_ < 0 || imuDecimator_.init(1.0 / dt_secs_,
+                                                  1.0 / periodicSensors_[SENSOR_IMU].period,
+                                                  imuCicOrder_) == -1){
+            ROS_ERROR("Dynamics: wrong IMU decimation parameters.");
+            return -1;
+        }
+        imuDeltaPub_.advertise<geometry_msgs::TwistStamped>(node_, IMU_DELTA_TOPIC_NAME, 96);
+        ROS_INFO_STREAM("Dynamics: IMU oversampling with " << imuDecimator_.getTapsAmount() << " taps.");
+    }
 
     return 0;
 }
@@ -203,6 +275,26 @@ int8_t Uav_Dynamics::initAuxilliaryCommunicatorSensors(){
         batteryInfoStatusSensor_.enable();
     }
 
+    ///< Esc status sensor publishes a single esc per sample
+    std::vector<double> motorsRpm;
+    uavDynamicsSim_->getMotorsRpm(motorsRpm);
+    size_t escAmount = std::max<size_t>(motorsRpm.size(), 1);
+    periodicSensors_[SENSOR_ESC_STATUS].period = escStatusSensor_.getPeriod() / escAmount;
+    periodicSensors_[SENSOR_ICE_STATUS].period = iceStatusSensor_.getPeriod();
+    periodicSensors_[SENSOR_FUEL_TANK_STATUS].period = fuelTankStatusSensor_.getPeriod();
+    periodicSensors_[SENSOR_BATTERY_STATUS].period = batteryInfoStatusSensor_.getPeriod();
+
+    const std::array<const BaseSensor*, 4> auxilliarySensors{{&escStatusSensor_,
+                                                             &iceStatusSensor_,
+                                                             &fuelTankStatusSensor_,
+                                                             &batteryInfoStatusSensor_}};
+    for(size_t idx = 0; idx < auxilliarySensors.size(); idx++){
+        if(auxilliarySensors[idx]->isEnabled()){
+            size_t sensorType = SENSOR_ESC_STATUS + idx;
+            sensorScheduler_.addSensor(sensorType, periodicSensors_[sensorType].period);
+        }
+    }
+
     return 0;
 }
 
@@ -212,30 +304,20 @@ int8_t Uav_Dynamics::initCalibration(){
 }
 
 int8_t Uav_Dynamics::initRvizVisualizationMarkers(){
-    initMarkers();
-    totalForcePub_ = node_.advertise<visualization_msgs::Marker>("/uav/Ftotal", 1);
-    aeroForcePub_ = node_.advertise<visualization_msgs::Marker>("/uav/Faero", 1);
-    motorsForcesPub_[0] = node_.advertise<visualization_msgs::Marker>("/uav/Fmotor0", 1);
-    motorsForcesPub_[1] = node_.advertise<visualization_msgs::Marker>("/uav/Fmotor1", 1);
-    motorsForcesPub_[2] = node_.advertise<visualization_msgs::Marker>("/uav/Fmotor2", 1);
-    motorsForcesPub_[3] = node_.advertise<visualization_msgs::Marker>("/uav/Fmotor3", 1);
-    motorsForcesPub_[4] = node_.advertise<visualization_msgs::Marker>("/uav/Fmotor4", 1);
-    liftForcePub_ = node_.advertise<visualization_msgs::Marker>("/uav/liftForce", 1);
-    drugForcePub_ = node_.advertise<visualization_msgs::Marker>("/uav/drugForce", 1);
-    sideForcePub_ = node_.advertise<visualization_msgs::Marker>("/uav/sideForce", 1);
-
-    totalMomentPub_ = node_.advertise<visualization_msgs::Marker>("/uav/Mtotal", 1);
-    aeroMomentPub_ = node_.advertise<visualization_msgs::Marker>("/uav/Maero", 1);
-    controlSurfacesMomentPub_ = node_.advertise<visualization_msgs::Marker>("/uav/McontrolSurfaces", 1);
-    aoaMomentPub_ = node_.advertise<visualization_msgs::Marker>("/uav/Maoa", 1);
-    motorsMomentsPub_[0] = node_.advertise<visualization_msgs::Marker>("/uav/Mmotor0", 1);
-    motorsMomentsPub_[1] = node_.advertise<visualization_msgs::Marker>("/uav/Mmotor1", 1);
-    motorsMomentsPub_[2] = node_.advertise<visualization_msgs::Marker>("/uav/Mmotor2", 1);
-    motorsMomentsPub_[3] = node_.advertise<visualization_msgs::Marker>("/uav/Mmotor3", 1);
-    motorsMomentsPub_[4] = node_.advertise<visualization_msgs::Marker>("/uav/Mmotor4", 1);
-
-    velocityPub_ = node_.advertise<visualization_msgs::Marker>("/uav/linearVelocity", 1);
-
+    static_assert(sizeof(FORCE_MARKERS) / sizeof(FORCE_MARKERS[0]) == MARKERS_AMOUNT,
+                  "Each marker type should be described");
+    tfMsg_.transforms.resize(2);
+    tfMsg_.transforms[0].header.frame_id = GLOBAL_FRAME_ID;
+    tfMsg_.transforms[0].child_frame_id = UAV_FRAME_ID;
+    tfMsg_.transforms[1].header.frame_id = GLOBAL_FRAME_ID;
+    tfMsg_.transforms[1].child_frame_id = UAV_FIXED_FRAME_ID;
+    tfMsg_.transforms[1].transform.rotation.w = 1;
+    tfPub_.advertise<tf2_msgs::TFMessage>(node_, "/tf", 100);
+
+    if(markersRate_ > 0 && dynamicsType_ == DYNAMICS_INNO_VTOL){
+        initMarkers();
+        markersPub_.advertise<visualization_msgs::MarkerArray>(node_, "/uav/markers", 1);
+    }
     return 0;
 }
 
@@ -381,6 +463,7 @@ void Uav_Dynamics::proceedDynamics(double period){
         }
 
         publishStateToCommunicator();
+        exportState();
 
         std::this_thread::sleep_until(time_point);
     }
@@ -391,100 +474,257 @@ void Uav_Dynamics::proceedDynamics(double period){
  * But we must publish only in PX4 notation
  */
 void Uav_Dynamics::publishStateToCommunicator(){
+    uint64_t crntTimeNsec = currentTime_.toNSec();
+    updateVehicleState(crntTimeNsec);
+
+    size_t sensorType;
+    uint64_t sampleTimeNsec;
+    while(sensorScheduler_.popDue(crntTimeNsec, sensorType, sampleTimeNsec)){
+        if(!isSensorSubscribed(sensorType)){
+            continue;
+        }
+        SensorsInputs in;
+        calculateSensorsInputs(periodicSensors_[sensorType].inputs, sampleTimeNsec, in);
+        publishSensor(sensorType, sampleTimeNsec, in);
+    }
+}
 
-    // 1. Get data from simulator
-    Eigen::Vector3d position, linVel, acc, gyro, angVel;
-    Eigen::Quaterniond attitude;
-    position = uavDynamicsSim_->getVehiclePosition();
-    linVel = uavDynamicsSim_->getVehicleVelocity();
-    uavDynamicsSim_->getIMUMeasurement(acc, gyro);
-    angVel = uavDynamicsSim_->getVehicleAngularVelocity();
-    attitude = uavDynamicsSim_->getVehicleAttitude();
-
-    // 2. Convert them to appropriate CS
-    Eigen::Vector3d gpsPosition, enuPosition, linVelNed, accFrd, gyroFrd, angVelFrd;
-    Eigen::Quaterniond attitudeFrdToNed;
-    if(dynamicsNotation_ == PX4_NED_FRD){
-        enuPosition = Converter::nedToEnu(position);
-        linVelNed = linVel;
-        accFrd = acc;
-        gyroFrd = gyro;
-        angVelFrd = angVel;
-        attitudeFrdToNed = attitude;
-    }else{
-        enuPosition = position;
-        linVelNed =  Converter::enuToNed(linVel);
-        accFrd = Converter::fluToFrd(acc);
-        gyroFrd = Converter::fluToFrd(gyro);
-        angVelFrd = Converter::fluToFrd(angVel);
-        attitudeFrdToNed = Converter::fluEnuToFrdNed(attitude);
+/**
+ * @brief Cache the vehicle state of the last two physics ticks. It costs only a few
+ * copies, the expensive conversions are performed only for the emitted samples.
+ */
+void Uav_Dynamics::updateVehicleState(uint64_t crntTimeNsec){
+    if(crntTimeNsec == crntVehicleState_.timeNsec){
+        return;
+    }
+    prevVehicleState_ = crntVehicleState_;
+    crntVehicleState_.timeNsec = crntTimeNsec;
+    crntVehicleState_.position = uavDynamicsSim_->getVehiclePosition();
+    crntVehicleState_.linVel = uavDynamicsSim_->getVehicleVelocity();
+    crntVehicleState_.angVel = uavDynamicsSim_->getVehicleAngularVelocity();
+    crntVehicleState_.attitude = uavDynamicsSim_->getVehicleAttitude();
+    if(prevVehicleState_.timeNsec == 0){
+        prevVehicleState_ = crntVehicleState_;
     }
-    geodeticConverter_.enu2Geodetic(enuPosition[0], enuPosition[1], enuPosition[2],
-                                    &gpsPosition[0], &gpsPosition[1], &gpsPosition[2]);
 
-    // 3. Calculate temperature, abs pressure and diff pressure using ISA model
-    float temperatureKelvin, absPressureHpa, diffPressureHpa;
-    SensorModelISA::EstimateAtmosphere(gpsPosition, linVelNed,
-                                       temperatureKelvin, absPressureHpa, diffPressureHpa);
+    if(isImuOversamplingEnabled_){
+        bool isNed = dynamicsNotation_ == PX4_NED_FRD;
+        Eigen::Vector3d acc, gyro;
+        uavDynamicsSim_->getIMUMeasurement(acc, gyro);
+        double tickDurationSec = (crntVehicleState_.timeNsec - prevVehicleState_.timeNsec) * 1e-9;
+        imuDecimator_.push(isNed ? acc : Converter::fluToFrd(acc),
+                           isNed ? gyro : Converter::fluToFrd(gyro),
+                           tickDurationSec);
+    }
+}
+
+/**
+ * @brief Write the last physics tick into the shared memory in PX4 notation. The forces
+ * and accelerations are available only for the inno vtol dynamics.
+ */
+void Uav_Dynamics::exportState(){
+    if(!stateExport_.isOpened()){
+        return;
+    }
+    auto copyVector = [](const Eigen::Vector3d& vector, double* output){
+        Eigen::Map<Eigen::Vector3d>(output, 3) = vector;
+    };
+    const bool isNed = dynamicsNotation_ == PX4_NED_FRD;
+    const VehicleState& state = crntVehicleState_;
+    Eigen::Quaterniond attitude = isNed ? state.attitude : Converter::fluEnuToFrdNed(state.attitude);
+
+    exportedState_.timeNsec = state.timeNsec;
+    copyVector(isNed ? state.position : Converter::enuToNed(state.position), exportedState_.position);
+    exportedState_.attitude[0] = attitude.w();
+    exportedState_.attitude[1] = attitude.x();
+    exportedState_.attitude[2] = attitude.y();
+    exportedState_.attitude[3] = attitude.z();
+    copyVector(isNed ? state.linVel : Converter::enuToNed(state.linVel), exportedState_.linearVelocity);
+    copyVector(isNed ? state.angVel : Converter::fluToFrd(state.angVel), exportedState_.angularVelocity);
+
+    if(dynamicsType_ == DYNAMICS_INNO_VTOL){
+        auto vtolDynamicsSim = static_cast<InnoVtolDynamicsSim*>(uavDynamicsSim_);
+        copyVector(vtolDynamicsSim->getLinearAcceleration(), exportedState_.linearAcceleration);
+        copyVector(vtolDynamicsSim->getAngularAcceleration(), exportedState_.angularAcceleration);
+        copyVector(vtolDynamicsSim->getFaero(), exportedState_.Faero);
+        copyVector(vtolDynamicsSim->getMaero(), exportedState_.Maero);
+        copyVector(vtolDynamicsSim->getFtotal(), exportedState_.Ftotal);
+        copyVector(vtolDynamicsSim->getMtotal(), exportedState_.Mtotal);
+    }
+
+    exportedState_.actuatorsAmount = std::min(actuators_.size(), SharedVehicleState::MAX_ACTUATORS);
+    std::copy_n(actuators_.begin(), exportedState_.actuatorsAmount, exportedState_.actuators);
+    exportedMotorsRpm_.clear();
+    uavDynamicsSim_->getMotorsRpm(exportedMotorsRpm_);
+    exportedState_.motorsAmount = std::min(exportedMotorsRpm_.size(), SharedVehicleState::MAX_MOTORS);
+    std::copy_n(exportedMotorsRpm_.begin(), exportedState_.motorsAmount, exportedState_.motorsRpm);
+
+    stateExport_.write(exportedState_);
+}
+
+/**
+ * @brief Interpolate the state at the sample timestamp and convert it to PX4 notation
+ * (NED and FRD), but only the data which is marked in requiredInputs mask and the data it
+ * depends on. IMU and motors rpm are taken from the last physics tick.
+ */
+void Uav_Dynamics::calculateSensorsInputs(uint16_t requiredInputs,
+                                          uint64_t sampleTimeNsec,
+                                          SensorsInputs& in){
+    if(requiredInputs & INPUT_ATMOSPHERE){
+        requiredInputs |= INPUT_GEODETIC | INPUT_VELOCITY;
+    }
+    if(requiredInputs & INPUT_GEODETIC){
+        requiredInputs |= INPUT_POSITION;
+    }
+    bool isNed = dynamicsNotation_ == PX4_NED_FRD;
+
+    double ratio = 1.0;
+    uint64_t tickDurationNsec = crntVehicleState_.timeNsec - prevVehicleState_.timeNsec;
+    if(tickDurationNsec > 0 && sampleTimeNsec < crntVehicleState_.timeNsec){
+        uint64_t sinceTickNsec = sampleTimeNsec > prevVehicleState_.timeNsec ?
+                                 sampleTimeNsec - prevVehicleState_.timeNsec : 0;
+        ratio = static_cast<double>(sinceTickNsec) / tickDurationNsec;
+    }
+    const VehicleState& prev = prevVehicleState_;
+    const VehicleState& crnt = crntVehicleState_;
 
-    // Publish state to communicator
-    auto crntTimeSec = currentTime_.toSec();
-    if(gpsLastPubTimeSec_ + GPS_POSITION_PERIOD < crntTimeSec){
-        publishUavGpsPosition(gpsPosition, linVelNed);
-        gpsLastPubTimeSec_ = crntTimeSec;
+    if(requiredInputs & INPUT_POSITION){
+        Eigen::Vector3d position = prev.position + ratio * (crnt.position - prev.position);
+        in.enuPosition = isNed ? Converter::nedToEnu(position) : position;
     }
-    if(attitudeLastPubTimeSec_ + ATTITUDE_PERIOD < crntTimeSec){
-        publishUavAttitude(attitudeFrdToNed);
-        attitudeLastPubTimeSec_ = crntTimeSec;
+    if(requiredInputs & INPUT_GEODETIC){
+        geodeticConverter_.enu2Geodetic(in.enuPosition, in.gpsPosition);
     }
-    if(velocityLastPubTimeSec_ + VELOCITY_PERIOD < crntTimeSec){
-        publishUavVelocity(linVelNed, angVelFrd);
-        velocityLastPubTimeSec_ = crntTimeSec;
+    if(requiredInputs & INPUT_VELOCITY){
+        Eigen::Vector3d linVel = prev.linVel + ratio * (crnt.linVel - prev.linVel);
+        in.linVelNed = isNed ? linVel : Converter::enuToNed(linVel);
     }
-    if(imuLastPubTimeSec_ + IMU_PERIOD < crntTimeSec){
-        publishIMUMeasurement(accFrd, gyroFrd);
-        imuLastPubTimeSec_ = crntTimeSec;
+    if(requiredInputs & INPUT_ATMOSPHERE){
+        SensorModelISA::EstimateAtmosphere(in.gpsPosition, in.linVelNed,
+                                           in.temperatureKelvin, in.absPressureHpa, in.diffPressureHpa);
     }
-    if(magLastPubTimeSec_ + MAG_PERIOD < crntTimeSec){
-        publishUavMag(gpsPosition, attitudeFrdToNed);
-        magLastPubTimeSec_ = crntTimeSec;
+    if((requiredInputs & INPUT_IMU) && isImuOversamplingEnabled_){
+        imuDecimator_.getFiltered(in.accFrd, in.gyroFrd);
+    }else if(requiredInputs & INPUT_IMU){
+        Eigen::Vector3d acc, gyro;
+        uavDynamicsSim_->getIMUMeasurement(acc, gyro);
+        in.accFrd = isNed ? acc : Converter::fluToFrd(acc);
+        in.gyroFrd = isNed ? gyro : Converter::fluToFrd(gyro);
     }
-    if(rawAirDataLastPubTimeSec_ + RAW_AIR_DATA_PERIOD < crntTimeSec){
-        publishUavAirData(absPressureHpa, diffPressureHpa, temperatureKelvin);
-        rawAirDataLastPubTimeSec_ = crntTimeSec;
+    if(requiredInputs & INPUT_ANGULAR_VELOCITY){
+        Eigen::Vector3d angVel = prev.angVel + ratio * (crnt.angVel - prev.angVel);
+        in.angVelFrd = isNed ? angVel : Converter::fluToFrd(angVel);
     }
-    if(staticPressureLastPubTimeSec_ + STATIC_PRESSURE_PERIOD < crntTimeSec){
-        publishUavStaticPressure(absPressureHpa);
-        staticPressureLastPubTimeSec_ = crntTimeSec;
+    if(requiredInputs & INPUT_ATTITUDE){
+        Eigen::Quaterniond attitude = prev.attitude.slerp(ratio, crnt.attitude);
+        in.attitudeFrdToNed = isNed ? attitude : Converter::fluEnuToFrdNed(attitude);
     }
-    if(staticTemperatureLastPubTimeSec_ + STATIC_TEMPERATURE_PERIOD < crntTimeSec){
-        publishUavStaticTemperature(temperatureKelvin);
-        staticTemperatureLastPubTimeSec_ = crntTimeSec;
+    if(requiredInputs & INPUT_MOTORS_RPM){
+        uavDynamicsSim_->getMotorsRpm(in.motorsRpm);
     }
+}
 
-    std::vector<double> motorsRpm;
-    if(uavDynamicsSim_->getMotorsRpm(motorsRpm)){
-        escStatusSensor_.publish(motorsRpm);
-        if(motorsRpm.size() == 5){
-            iceStatusSensor_.publish(motorsRpm[4]);
-        }
+/**
+ * @brief The inputs of a sample are not even calculated if nobody listens to the sensor.
+ * Fuel tank is the exception, because its model is updated only on publication.
+ */
+bool Uav_Dynamics::isSensorSubscribed(size_t sensorType) const{
+    switch(sensorType){
+        case SENSOR_GPS_POSITION:
+            return gpsPositionPub_.hasSubscribers();
+        case SENSOR_ATTITUDE:
+            return attitudePub_.hasSubscribers();
+        case SENSOR_VELOCITY:
+            return speedPub_.hasSubscribers();
+        case SENSOR_IMU:
+            return imuPub_.hasSubscribers() || imuDeltaPub_.hasSubscribers();
+        case SENSOR_MAG:
+            return magPub_.hasSubscribers();
+        case SENSOR_RAW_AIR_DATA:
+            return rawAirDataPub_.hasSubscribers();
+        case SENSOR_STATIC_PRESSURE:
+            return staticPressurePub_.hasSubscribers();
+        case SENSOR_STATIC_TEMPERATURE:
+            return staticTemperaturePub_.hasSubscribers();
+        case SENSOR_ESC_STATUS:
+            return escStatusSensor_.hasSubscribers();
+        case SENSOR_ICE_STATUS:
+            return iceStatusSensor_.hasSubscribers();
+        case SENSOR_BATTERY_STATUS:
+            return batteryInfoStatusSensor_.hasSubscribers();
+        default:
+            return true;
     }
+}
 
-    ///< Simplified Fuel tank model
-    ///< todo: refactor it
-    static double fuelLevelPercentage = 100.0;
-    if(motorsRpm.size() == 5 && motorsRpm[4] >= 1) {
-        fuelLevelPercentage -= 0.002;
-        if(fuelLevelPercentage < 0) {
-            fuelLevelPercentage = 0;
+void Uav_Dynamics::publishSensor(size_t sensorType, uint64_t sampleTimeNsec, const SensorsInputs& in){
+    ros::Time stamp;
+    stamp.fromNSec(sampleTimeNsec);
+
+    switch(sensorType){
+        case SENSOR_GPS_POSITION:
+            publishUavGpsPosition(in.gpsPosition, in.linVelNed, stamp);
+            break;
+        case SENSOR_ATTITUDE:
+            publishUavAttitude(in.attitudeFrdToNed, stamp);
+            break;
+        case SENSOR_VELOCITY:
+            publishUavVelocity(in.linVelNed, in.angVelFrd);
+            break;
+        case SENSOR_IMU:
+            publishIMUMeasurement(in.accFrd, in.gyroFrd, stamp);
+            if(isImuOversamplingEnabled_){
+                publishIMUDelta(stamp);
+            }
+            break;
+        case SENSOR_MAG:
+            publishUavMag(in.gpsPosition, in.attitudeFrdToNed);
+            break;
+        case SENSOR_RAW_AIR_DATA:
+            publishUavAirData(in.absPressureHpa, in.diffPressureHpa, in.temperatureKelvin);
+            break;
+        case SENSOR_STATIC_PRESSURE:
+            publishUavStaticPressure(in.absPressureHpa);
+            break;
+        case SENSOR_STATIC_TEMPERATURE:
+            publishUavStaticTemperature(in.temperatureKelvin);
+            break;
+        case SENSOR_ESC_STATUS:
+            escStatusSensor_.publish(in.motorsRpm);
+            break;
+        case SENSOR_ICE_STATUS:
+            if(in.motorsRpm.size() == 5){
+                iceStatusSensor_.publish(in.motorsRpm[4]);
+            }
+            break;
+        case SENSOR_FUEL_TANK_STATUS:
+        {
+            ///< Simplified Fuel tank model, it is updated only when the fuel tank status is published
+            ///< todo: refactor it
+            const double FUEL_CONSUMPTION_PERCENT_PER_SEC = 1.92;
+            double sampleTimeSec = stamp.toSec();
+            bool isFirstSample = fuelLastUpdateTimeSec_ < 0;
+            if(!isFirstSample && in.motorsRpm.size() == 5 && in.motorsRpm[4] >= 1) {
+                fuelLevelPercentage_ -= FUEL_CONSUMPTION_PERCENT_PER_SEC * (sampleTimeSec - fuelLastUpdateTimeSec_);
+                if(fuelLevelPercentage_ < 0) {
+                    fuelLevelPercentage_ = 0;
+                }
+            }
+            fuelLastUpdateTimeSec_ = sampleTimeSec;
+            fuelTankStatusSensor_.publish(fuelLevelPercentage_);
+            break;
+        }
+        case SENSOR_BATTERY_STATUS:
+        {
+            ///< Battery is just constant
+            ///< todo: add model
+            const double BATTERY_PERCENTAGE = 90.0;
+            batteryInfoStatusSensor_.publish(BATTERY_PERCENTAGE);
+            break;
         }
+        default:
+            break;
     }
-    fuelTankStatusSensor_.publish(fuelLevelPercentage);
-
-    ///< Battery is just constant
-    ///< todo: add model
-    static double batteryPercentage = 90.0;
-    batteryInfoStatusSensor_.publish(batteryPercentage);
 }
 
 void Uav_Dynamics::publishToRos(double period){
@@ -497,9 +737,9 @@ void Uav_Dynamics::publishToRos(double period){
         publishState();
 
         static auto next_time = std::chrono::system_clock::now();
-        if(crnt_time > next_time){
+        if(markersRate_ > 0 && crnt_time > next_time){
             publishMarkers();
-            next_time += std::chrono::milliseconds(int(50));
+            next_time += std::chrono::microseconds(int(1000000 / markersRate_));
         }
 
         std::this_thread::sleep_until(time_point);
@@ -537,13 +777,18 @@ void Uav_Dynamics::calibrationCallback(std_msgs::UInt8 msg){
     calibrationType_ = static_cast<UavDynamicsSimBase::CalibrationType_t>(msg.data);
 }
 
+void Uav_Dynamics::modelReloadCallback(std_msgs::Empty msg){
+    modelReloader_.requestReload();
+}
+
 /**
- * @brief Perform TF transform between GLOBAL_FRAME -> UAV_FRAME in ROS (enu/flu) format
+ * @brief Perform TF transform between GLOBAL_FRAME -> UAV_FRAME in ROS (enu/flu) format.
+ * Both transforms are sent as a single preallocated message and only if /tf has listeners.
  */
 void Uav_Dynamics::publishState(void){
-    geometry_msgs::TransformStamped transform;
-    transform.header.stamp = ros::Time::now();
-    transform.header.frame_id = GLOBAL_FRAME_ID;
+    if(!tfPub_.hasSubscribers()){
+        return;
+    }
 
     auto position = uavDynamicsSim_->getVehiclePosition();
     auto attitude = uavDynamicsSim_->getVehicleAttitude();
@@ -557,38 +802,39 @@ void Uav_Dynamics::publishState(void){
         fluAttitude = attitude;
     }
 
-    transform.transform.translation.x = enuPosition[0];
-    transform.transform.translation.y = enuPosition[1];
-    transform.transform.translation.z = enuPosition[2];
-    transform.transform.rotation.x = fluAttitude.x();
-    transform.transform.rotation.y = fluAttitude.y();
-    transform.transform.rotation.z = fluAttitude.z();
-    transform.transform.rotation.w = fluAttitude.w();
-    transform.child_frame_id = UAV_FRAME_ID;
-    tfPub_.sendTransform(transform);
+    auto stamp = ros::Time::now();
+    for(auto& transform : tfMsg_.transforms){
+        transform.header.stamp = stamp;
+        transform.transform.translation.x = enuPosition[0];
+        transform.transform.translation.y = enuPosition[1];
+        transform.transform.translation.z = enuPosition[2];
+    }
+
+    auto& uavTransform = tfMsg_.transforms[0];
+    uavTransform.transform.rotation.x = fluAttitude.x();
+    uavTransform.transform.rotation.y = fluAttitude.y();
+    uavTransform.transform.rotation.z = fluAttitude.z();
+    uavTransform.transform.rotation.w = fluAttitude.w();
 
-    transform.transform.rotation.x = 0;
-    transform.transform.rotation.y = 0;
-    transform.transform.rotation.z = 0;
-    transform.transform.rotation.w = 1;
-    transform.child_frame_id = UAV_FIXED_FRAME_ID;
-    tfPub_.sendTransform(transform);
+    tfPub_.publish(tfMsg_);
 }
 
-void Uav_Dynamics::publishUavAttitude(Eigen::Quaterniond attitudeFrdToNed){
+void Uav_Dynamics::publishUavAttitude(Eigen::Quaterniond attitudeFrdToNed, const ros::Time& stamp){
     geometry_msgs::QuaternionStamped msg;
     msg.quaternion.x = attitudeFrdToNed.x();
     msg.quaternion.y = attitudeFrdToNed.y();
     msg.quaternion.z = attitudeFrdToNed.z();
     msg.quaternion.w = attitudeFrdToNed.w();
-    msg.header.stamp = currentTime_;
+    msg.header.stamp = stamp;
     attitudePub_.publish(msg);
 }
 
-void Uav_Dynamics::publishUavGpsPosition(Eigen::Vector3d geoPosition, Eigen::Vector3d nedVelocity){
+void Uav_Dynamics::publishUavGpsPosition(Eigen::Vector3d geoPosition,
+                                         Eigen::Vector3d nedVelocity,
+                                         const ros::Time& stamp){
     uavcan_msgs::Fix msg;
 
-    msg.header.stamp = currentTime_;
+    msg.header.stamp = stamp;
 
     msg.latitude_deg_1e8 = geoPosition[0] * 1e+8;
     msg.longitude_deg_1e8 = geoPosition[1] * 1e+8;
@@ -605,9 +851,11 @@ void Uav_Dynamics::publishUavGpsPosition(Eigen::Vector3d geoPosition, Eigen::Vec
     gpsPositionPub_.publish(msg);
 }
 
-void Uav_Dynamics::publishIMUMeasurement(Eigen::Vector3d accFrd, Eigen::Vector3d gyroFrd){
+void Uav_Dynamics::publishIMUMeasurement(Eigen::Vector3d accFrd,
+                                         Eigen::Vector3d gyroFrd,
+                                         const ros::Time& stamp){
     sensor_msgs::Imu msg;
-    msg.header.stamp = currentTime_;
+    msg.header.stamp = stamp;
 
     msg.angular_velocity.x = gyroFrd[0];
     msg.angular_velocity.y = gyroFrd[1];
@@ -620,6 +868,27 @@ void Uav_Dynamics::publishIMUMeasurement(Eigen::Vector3d accFrd, Eigen::Vector3d
     imuPub_.publish(msg);
 }
 
+/**
+ * @brief Delta velocity (linear, m/sec) and delta angle (angular, rad) in FRD integrated at
+ * the physics rate since the previous IMU sample
+ */
+void Uav_Dynamics::publishIMUDelta(const ros::Time& stamp){
+    Eigen::Vector3d deltaVelocity, deltaAngle;
+    double integrationTimeSec;
+    imuDecimator_.popDeltas(deltaVelocity, deltaAngle, integrationTimeSec);
+
+    geometry_msgs::TwistStamped msg;
+    msg.header.stamp = stamp;
+    msg.twist.linear.x = deltaVelocity[0];
+    msg.twist.linear.y = deltaVelocity[1];
+    msg.twist.linear.z = deltaVelocity[2];
+    msg.twist.angular.x = deltaAngle[0];
+    msg.twist.angular.y = deltaAngle[1];
+    msg.twist.angular.z = deltaAngle[2];
+
+    imuDeltaPub_.publish(msg);
+}
+
 void Uav_Dynamics::publishUavVelocity(Eigen::Vector3d linVelNed, Eigen::Vector3d angVelFrd){
     geometry_msgs::Twist speed;
     speed.linear.x = linVelNed[0];
@@ -632,12 +901,8 @@ void Uav_Dynamics::publishUavVelocity(Eigen::Vector3d linVelNed, Eigen::Vector3d
 }
 
 void Uav_Dynamics::publishUavMag(Eigen::Vector3d geoPosition, Eigen::Quaterniond attitudeFrdToNed){
-    Eigen::Vector3d magEnu;
-    geographiclib_conversions::MagneticField(
-        geoPosition.x(), geoPosition.y(), geoPosition.z(),
-        magEnu.x(), magEnu.y(), magEnu.z());
-
-    Eigen::Vector3d magFrd = attitudeFrdToNed.inverse() * Converter::enuToNed(magEnu);
+    Eigen::Vector3d magNed = magFieldCache_.getNed(geoPosition.x(), geoPosition.y(), geoPosition.z());
+    Eigen::Vector3d magFrd = attitudeFrdToNed.inverse() * magNed;
 
     sensor_msgs::MagneticField mag;
     mag.header.stamp = ros::Time();
@@ -680,101 +945,80 @@ void Uav_Dynamics::publishUavStaticPressure(float staticPressureHpa){
     staticPressurePub_.publish(msg);
 }
 
-visualization_msgs::Marker& Uav_Dynamics::makeArrow(const Eigen::Vector3d& vector3D,
-                                                    const Eigen::Vector3d& rgbColor,
-                                                    const char* frameId=UAV_FRAME_ID){
-    auto fluVector = Converter::frdToFlu(vector3D);
-    arrowMarkers_.header.frame_id = frameId;
-    arrowMarkers_.points[1].x = fluVector[0];
-    arrowMarkers_.points[1].y = fluVector[1];
-    arrowMarkers_.points[1].z = fluVector[2];
-    arrowMarkers_.color.r = rgbColor[0];
-    arrowMarkers_.color.g = rgbColor[1];
-    arrowMarkers_.color.b = rgbColor[2];
-    return arrowMarkers_;
+void Uav_Dynamics::initMarkers(){
+    markers_.markers.clear();
+    for(int32_t markerType = 0; markerType < MARKERS_AMOUNT; markerType++){
+        const ForceMarkerDescription& description = FORCE_MARKERS[markerType];
+        if(std::find(disabledMarkers_.begin(), disabledMarkers_.end(), description.name) != disabledMarkers_.end()){
+            continue;
+        }
+        visualization_msgs::Marker marker;
+        marker.header.frame_id = description.frameId;
+        marker.ns = description.name;
+        marker.id = markerType;
+        marker.type = visualization_msgs::Marker::ARROW;
+        marker.action = visualization_msgs::Marker::ADD;
+        marker.pose.orientation.w = 1;
+        marker.scale.x = 0.05;   // radius of cylinder
+        marker.scale.y = 0.1;
+        marker.scale.z = 0.03;   // scale of hat
+        marker.lifetime = ros::Duration();
+        marker.color.r = description.color[0];
+        marker.color.g = description.color[1];
+        marker.color.b = description.color[2];
+        marker.color.a = 1.0;
+        marker.points.resize(2);
+        markers_.markers.push_back(marker);
+    }
 }
 
-void Uav_Dynamics::initMarkers(){
-    arrowMarkers_.id = 0;
-    arrowMarkers_.type = visualization_msgs::Marker::ARROW;
-    arrowMarkers_.action = visualization_msgs::Marker::ADD;
-    arrowMarkers_.pose.orientation.w = 1;
-    arrowMarkers_.scale.x = 0.05;   // radius of cylinder
-    arrowMarkers_.scale.y = 0.1;
-    arrowMarkers_.scale.z = 0.03;   // scale of hat
-    arrowMarkers_.lifetime = ros::Duration();
-    arrowMarkers_.color.a = 1.0;
-
-    geometry_msgs::Point startPoint, endPoint;
-    startPoint.x = 0;
-    startPoint.y = 0;
-    startPoint.z = 0;
-    endPoint.x = 0;
-    endPoint.y = 0;
-    endPoint.z = 0;
-
-    arrowMarkers_.points.push_back(startPoint);
-    arrowMarkers_.points.push_back(endPoint);
+Eigen::Vector3d Uav_Dynamics::calculateMarkerVector(int32_t markerType) const{
+    auto vtolDynamicsSim = static_cast<const InnoVtolDynamicsSim*>(uavDynamicsSim_);
+    if(markerType >= MARKER_FMOTOR_0 && markerType <= MARKER_FMOTOR_4){
+        return vtolDynamicsSim->getFmotors()[markerType - MARKER_FMOTOR_0];
+    }else if(markerType >= MARKER_MMOTOR_0 && markerType <= MARKER_MMOTOR_4){
+        return vtolDynamicsSim->getMmotors()[markerType - MARKER_MMOTOR_0];
+    }
+    switch(markerType){
+        case MARKER_FTOTAL:
+            return vtolDynamicsSim->getFtotal();
+        case MARKER_FAERO:
+            return vtolDynamicsSim->getFaero();
+        case MARKER_FLIFT:
+            return vtolDynamicsSim->getFlift();
+        case MARKER_FDRUG:
+            return vtolDynamicsSim->getFdrug();
+        case MARKER_FSIDE:
+            return vtolDynamicsSim->getFside();
+        case MARKER_MTOTAL:
+            return vtolDynamicsSim->getMtotal();
+        case MARKER_MAERO:
+            return vtolDynamicsSim->getMaero();
+        case MARKER_MSTEER:
+            return vtolDynamicsSim->getMsteer();
+        case MARKER_MAIRSPEED:
+            return vtolDynamicsSim->getMairspeed();
+        case MARKER_LINEAR_VELOCITY:
+            return vtolDynamicsSim->getBodyLinearVelocity();
+        default:
+            return Eigen::Vector3d::Zero();
+    }
 }
 
 /**
- * @brief Publish forces and moments of vehicle
+ * @brief Publish forces and moments of vehicle. Only the arrow ends are updated in the
+ * preallocated array and nothing is done if nobody listens.
  */
 void Uav_Dynamics::publishMarkers(void){
-    if(dynamicsType_ == DYNAMICS_INNO_VTOL){
-        arrowMarkers_.header.stamp = ros::Time();
-        Eigen::Vector3d MOMENT_COLOR(0.5, 0.5, 0.0),
-                        MOTORS_FORCES_COLOR(0.0, 0.5, 0.5),
-                        SPEED_COLOR(0.7, 0.5, 1.3),
-                        LIFT_FORCE(0.8, 0.2, 0.3),
-                        DRAG_FORCE(0.2, 0.8, 0.3),
-                        SIDE_FORCE(0.2, 0.3, 0.8);
-
-        // publish moments
-        auto Maero = static_cast<InnoVtolDynamicsSim*>(uavDynamicsSim_)->getMaero();
-        aeroMomentPub_.publish(makeArrow(Maero, MOMENT_COLOR));
-
-        auto Mmotors = static_cast<InnoVtolDynamicsSim*>(uavDynamicsSim_)->getMmotors();
-        for(size_t motorIdx = 0; motorIdx < 5; motorIdx++){
-            motorsMomentsPub_[motorIdx].publish(makeArrow(Mmotors[motorIdx],
-                                                          MOMENT_COLOR,
-                                                          MOTOR_NAMES[motorIdx].c_str()));
-        }
-
-        auto Mtotal = static_cast<InnoVtolDynamicsSim*>(uavDynamicsSim_)->getMtotal();
-        totalMomentPub_.publish(makeArrow(Mtotal, MOMENT_COLOR));
-
-        auto Msteer = static_cast<InnoVtolDynamicsSim*>(uavDynamicsSim_)->getMsteer();
-        controlSurfacesMomentPub_.publish(makeArrow(Msteer, MOMENT_COLOR));
-
-        auto Mairspeed = static_cast<InnoVtolDynamicsSim*>(uavDynamicsSim_)->getMairspeed();
-        aoaMomentPub_.publish(makeArrow(Mairspeed, MOMENT_COLOR));
-
-
-        // publish forces
-        auto Faero = static_cast<InnoVtolDynamicsSim*>(uavDynamicsSim_)->getFaero();
-        aeroForcePub_.publish(makeArrow(Faero / 10, MOTORS_FORCES_COLOR));
-
-        auto Fmotors = static_cast<InnoVtolDynamicsSim*>(uavDynamicsSim_)->getFmotors();
-        for(size_t motorIdx = 0; motorIdx < 5; motorIdx++){
-            motorsForcesPub_[motorIdx].publish(makeArrow(Fmotors[motorIdx] / 10,
-                                                         MOTORS_FORCES_COLOR,
-                                                         MOTOR_NAMES[motorIdx].c_str()));
-        }
-
-        auto Ftotal = static_cast<InnoVtolDynamicsSim*>(uavDynamicsSim_)->getFtotal();
-        totalForcePub_.publish(makeArrow(Ftotal, Eigen::Vector3d(0.0, 1.0, 1.0)));
-
-        auto velocity = static_cast<InnoVtolDynamicsSim*>(uavDynamicsSim_)->getBodyLinearVelocity();
-        velocityPub_.publish(makeArrow(velocity, SPEED_COLOR));
-
-        auto Flift = static_cast<InnoVtolDynamicsSim*>(uavDynamicsSim_)->getFlift();
-        liftForcePub_.publish(makeArrow(Flift / 10, LIFT_FORCE));
-
-        auto Fdrug = static_cast<InnoVtolDynamicsSim*>(uavDynamicsSim_)->getFdrug();
-        drugForcePub_.publish(makeArrow(Fdrug / 10, DRAG_FORCE));
-
-        auto Fside = static_cast<InnoVtolDynamicsSim*>(uavDynamicsSim_)->getFside();
-        sideForcePub_.publish(makeArrow(Fside / 10, SIDE_FORCE));
+    if(markers_.markers.empty() || !markersPub_.hasSubscribers()){
+        return;
+    }
+    for(auto& marker : markers_.markers){
+        auto fluVector = Converter::frdToFlu(calculateMarkerVector(marker.id) * FORCE_MARKERS[marker.id].scale);
+        marker.header.stamp = ros::Time();
+        marker.points[1].x = fluVector[0];
+        marker.points[1].y = fluVector[1];
+        marker.points[1].z = fluVector[2];
     }
+    markersPub_.publish(markers_);
 }
@@ -0,0 +1,73 @@
+/**
+ * @file local_geodetic_converter.cpp
+ * @brief Fast ENU to geodetic conversion implementation
+ */
+
+#include <cmath>
+#include "local_geodetic_converter.hpp"
+
+constexpr double LocalGeodeticConverter::DEFAULT_VALID_RADIUS;
+
+static const double SEMIMAJOR_AXIS = 6378137.0;                     // m, WGS84
+static const double FIRST_ECCENTRICITY_SQUARED = 6.69437999014e-3;  // WGS84
+static const double DEG_TO_RAD = M_PI / 180.0;
+static const double RAD_TO_DEG = 180.0 / M_PI;
+
+void LocalGeodeticConverter::initialiseReference(double latitude, double longitude, double altitude,
+                                                 double validRadius){
+    exactConverter_.initialiseReference(latitude, longitude, altitude);
+    referenceEnuToEcef_ = calculateEcefToEnu(latitude * DEG_TO_RAD, longitude * DEG_TO_RAD).transpose();
+    validRadiusSquared_ = validRadius * validRadius;
+    anchorsAmount_ = 0;
+    moveAnchor(Eigen::Vector3d::Zero());
+}
+
+void LocalGeodeticConverter::enu2Geodetic(const Eigen::Vector3d& enu, Eigen::Vector3d& geodetic){
+    if((enu - anchorEnu_).squaredNorm() > validRadiusSquared_){
+        moveAnchor(enu);
+    }
+    Eigen::Vector3d local = referenceEnuToAnchorEnu_ * (enu - anchorEnu_);
+    const double east = local[0], north = local[1], up = local[2];
+
+    double deltaLat = north / (meridianRadius_ + up) -
+                      anchorTanLat_ * east * east / (2 * meridianRadius_ * primeVerticalRadius_);
+    double distanceToAxis = (primeVerticalRadius_ + up) * anchorCosLat_ - north * anchorSinLat_;
+    double deltaLon = east / distanceToAxis;
+    double deltaAlt = up + north * north / (2 * meridianRadius_) + east * east / (2 * primeVerticalRadius_);
+
+    geodetic[0] = (anchorLat_ + deltaLat) * RAD_TO_DEG;
+    geodetic[1] = (anchorLon_ + deltaLon) * RAD_TO_DEG;
+    geodetic[2] = anchorAlt_ + deltaAlt;
+}
+
+void LocalGeodeticConverter::moveAnchor(const Eigen::Vector3d& enu){
+    double lat, lon, alt;
+    exactConverter_.enu2Geodetic(enu[0], enu[1], enu[2], &lat, &lon, &alt);
+
+    anchorEnu_ = enu;
+    anchorLat_ = lat * DEG_TO_RAD;
+    anchorLon_ = lon * DEG_TO_RAD;
+    anchorAlt_ = alt;
+    anchorSinLat_ = std::sin(anchorLat_);
+    anchorCosLat_ = std::cos(anchorLat_);
+    anchorTanLat_ = anchorSinLat_ / anchorCosLat_;
+
+    double denominator = 1 - FIRST_ECCENTRICITY_SQUARED * anchorSinLat_ * anchorSinLat_;
+    double primeVertical = SEMIMAJOR_AXIS / std::sqrt(denominator);
+    double meridian = primeVertical * (1 - FIRST_ECCENTRICITY_SQUARED) / denominator;
+    meridianRadius_ = meridian + anchorAlt_;
+    primeVerticalRadius_ = primeVertical + anchorAlt_;
+
+    referenceEnuToAnchorEnu_ = calculateEcefToEnu(anchorLat_, anchorLon_) * referenceEnuToEcef_;
+    anchorsAmount_++;
+}
+
+Eigen::Matrix3d LocalGeodeticConverter::calculateEcefToEnu(double latRad, double lonRad){
+    const double sLat = std::sin(latRad), cLat = std::cos(latRad);
+    const double sLon = std::sin(lonRad), cLon = std::cos(lonRad);
+    Eigen::Matrix3d ecefToEnu;
+    ecefToEnu << -sLon,         cLon,           0,
+                 -sLat * cLon,  -sLat * sLon,   cLat,
+                 cLat * cLon,   cLat * sLon,    sLat;
+    return ecefToEnu;
+}
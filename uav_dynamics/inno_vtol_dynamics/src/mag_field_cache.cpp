@@ -0,0 +1,90 @@
+/**
+ * @file mag_field_cache.cpp
+ * @brief Cache of the geomagnetic model implementation
+ */
+
+#include <cmath>
+#include <geographiclib_conversions/geodetic_conv.hpp>
+#include "mag_field_cache.hpp"
+
+constexpr double MagFieldCache::DEFAULT_TOLERANCE;
+constexpr double MagFieldCache::DEFAULT_CELL_SIZE_DEG;
+constexpr double MagFieldCache::DEFAULT_CELL_ALTITUDE;
+constexpr size_t MagFieldCache::MAX_SPLITS;
+
+void MagFieldCache::init(double latRef, double lonRef, double altRef,
+                         double tolerance, double cellSizeDeg, double cellAltitude){
+    latRef_ = latRef;
+    lonRef_ = lonRef;
+    altRef_ = altRef;
+    tolerance_ = tolerance;
+    maxCellSizeDeg_ = cellSizeDeg;
+    cellAltitude_ = cellAltitude;
+    isCellValid_ = false;
+    refreshesAmount_ = 0;
+}
+
+Eigen::Vector3d MagFieldCache::getNed(double lat, double lon, double alt){
+    if(!isInsideCell(lat, lon, alt)){
+        refreshCell(lat, lon, alt);
+    }
+    return interpolate(lat, lon, alt);
+}
+
+/**
+ * @note geographiclib_conversions::MagneticField returns the field in ENU
+ */
+Eigen::Vector3d MagFieldCache::calculateNed(double lat, double lon, double alt){
+    Eigen::Vector3d magEnu;
+    geographiclib_conversions::MagneticField(lat, lon, alt, magEnu.x(), magEnu.y(), magEnu.z());
+    return Eigen::Vector3d(magEnu.y(), magEnu.x(), -magEnu.z());
+}
+
+bool MagFieldCache::isInsideCell(double lat, double lon, double alt) const{
+    return isCellValid_ &&
+           lat >= cellMin_[0] && lat <= cellMin_[0] + cellSizeDeg_ &&
+           lon >= cellMin_[1] && lon <= cellMin_[1] + cellSizeDeg_ &&
+           alt >= cellMin_[2] && alt <= cellMin_[2] + cellAltitude_;
+}
+
+void MagFieldCache::refreshCell(double lat, double lon, double alt){
+    double cellSizeDeg = maxCellSizeDeg_;
+    for(size_t split = 0; split <= MAX_SPLITS; split++){
+        buildCell(lat, lon, alt, cellSizeDeg);
+        Eigen::Vector3d center = cellMin_ + 0.5 * Eigen::Vector3d(cellSizeDeg, cellSizeDeg, cellAltitude_);
+        double error = (interpolate(center[0], center[1], center[2]) -
+                        calculateNed(center[0], center[1], center[2])).norm();
+        if(error <= tolerance_){
+            break;
+        }
+        cellSizeDeg *= 0.5;
+    }
+    refreshesAmount_++;
+}
+
+void MagFieldCache::buildCell(double lat, double lon, double alt, double cellSizeDeg){
+    cellSizeDeg_ = cellSizeDeg;
+    cellMin_[0] = latRef_ + std::floor((lat - latRef_) / cellSizeDeg) * cellSizeDeg;
+    cellMin_[1] = lonRef_ + std::floor((lon - lonRef_) / cellSizeDeg) * cellSizeDeg;
+    cellMin_[2] = altRef_ + std::floor((alt - altRef_) / cellAltitude_) * cellAltitude_;
+    for(size_t corner = 0; corner < 8; corner++){
+        corners_[corner] = calculateNed(cellMin_[0] + (corner & 1) * cellSizeDeg,
+                                        cellMin_[1] + ((corner >> 1) & 1) * cellSizeDeg,
+                                        cellMin_[2] + ((corner >> 2) & 1) * cellAltitude_);
+    }
+    isCellValid_ = true;
+}
+
+Eigen::Vector3d MagFieldCache::interpolate(double lat, double lon, double alt) const{
+    double t[3] = {(lat - cellMin_[0]) / cellSizeDeg_,
+                   (lon - cellMin_[1]) / cellSizeDeg_,
+                   (alt - cellMin_[2]) / cellAltitude_};
+    Eigen::Vector3d result = Eigen::Vector3d::Zero();
+    for(size_t corner = 0; corner < 8; corner++){
+        double weight = ((corner & 1) ? t[0] : 1 - t[0]) *
+                        (((corner >> 1) & 1) ? t[1] : 1 - t[1]) *
+                        (((corner >> 2) & 1) ? t[2] : 1 - t[2]);
+        result += weight * corners_[corner];
+    }
+    return result;
+}
@@ -173,19 +173,21 @@ void MavlinkCommunicatorROS::communicate(){
     }
 
     /**
+     * @note Sensors rates are defined by the dynamics node scheduler, so here we just
+     * forward each new sample once.
      * @note For some reasons sometimes PX4 ignores GPS all messages after first if we
      * send it too soon. So, just ignoring first few messages is ok.
      * @todo Understand why and may be develop a better approach
      */
-    if (gpsMsgCounter_ >= 5 && gpsTimeUsec >= lastGpsTimeUsec_ + GPS_PERIOD_US){
-        lastGpsTimeUsec_ = gpsTimeUsec;
+    if (gpsMsgCounter_ >= 5 && isGpsUpdated_){
+        isGpsUpdated_ = false;
 
         if(mavlinkCommunicator_.SendHilGps(gpsTimeUsec, linearVelocityNed_, gpsPosition_) == -1){
             ROS_ERROR_STREAM_THROTTLE(1, NODE_NAME << ": GPS failed." << strerror(errno));
         }
     }
-    if (imuTimeUsec >= lastImuTimeUsec_ + IMU_PERIOD_US){
-        lastImuTimeUsec_ = imuTimeUsec;
+    if (isImuUpdated_){
+        isImuUpdated_ = false;
 
         int status = mavlinkCommunicator_.SendHilSensor(imuTimeUsec,
                                                         gpsPosition_.z(),
@@ -194,7 +196,11 @@ void MavlinkCommunicatorROS::communicate(){
                                                         gyroFrd_,
                                                         staticPressure_,
                                                         staticTemperature_,
-                                                        diffPressure_);
+                                                        diffPressure_,
+                                                        isMagUpdated_,
+                                                        isBaroUpdated_);
+        isMagUpdated_ = false;
+        isBaroUpdated_ = false;
 
         if(status == -1){
             ROS_ERROR_STREAM_THROTTLE(1, NODE_NAME << "Imu failed." << strerror(errno));
@@ -226,6 +232,7 @@ void MavlinkCommunicatorROS::staticTemperatureCallback(uavcan_msgs::StaticTemper
 void MavlinkCommunicatorROS::staticPressureCallback(uavcan_msgs::StaticPressure::Ptr msg){
     staticPressureMsg_ = *msg;
     staticPressure_ = msg->static_pressure / 100;
+    isBaroUpdated_ = true;
 }
 
 void MavlinkCommunicatorROS::rawAirDataCallback(uavcan_msgs::RawAirData::Ptr msg){
@@ -236,6 +243,7 @@ void MavlinkCommunicatorROS::rawAirDataCallback(uavcan_msgs::RawAirData::Ptr msg
 void MavlinkCommunicatorROS::gpsCallback(uavcan_msgs::Fix::Ptr msg){
     gpsPositionMsg_ = *msg;
     gpsMsgCounter_++;
+    isGpsUpdated_ = true;
     gpsPosition_[0] = msg->latitude_deg_1e8 * 1e-8;
     gpsPosition_[1] = msg->longitude_deg_1e8 * 1e-8;
     gpsPosition_[2] = msg->height_msl_mm * 1e-3;
@@ -253,6 +261,7 @@ void MavlinkCommunicatorROS::imuCallback(sensor_msgs::Imu::Ptr imu){
     gyroFrd_[0] = imu->angular_velocity.x;
     gyroFrd_[1] = imu->angular_velocity.y;
     gyroFrd_[2] = imu->angular_velocity.z;
+    isImuUpdated_ = true;
 }
 
 void MavlinkCommunicatorROS::magCallback(sensor_msgs::MagneticField::Ptr mag){
@@ -260,6 +269,7 @@ void MavlinkCommunicatorROS::magCallback(sensor_msgs::MagneticField::Ptr mag){
     magFrd_[0] = mag->magnetic_field.x;
     magFrd_[1] = mag->magnetic_field.y;
     magFrd_[2] = mag->magnetic_field.z;
+    isMagUpdated_ = true;
 }
 
 
@@ -366,7 +376,9 @@ int MavlinkCommunicator::SendHilSensor(unsigned int time_usec,
                                        Eigen::Vector3d gyroFrd,
                                        float staticPressure,
                                        float staticTemperature,
-                                       float diffPressure){
+                                       float diffPressure,
+                                       bool isMagUpdated,
+                                       bool isBaroUpdated){
     // Output data
     mavlink_hil_sensor_t sensor_msg;
     sensor_msg.time_usec = time_usec;
@@ -381,16 +393,15 @@ int MavlinkCommunicator::SendHilSensor(unsigned int time_usec,
     sensor_msg.fields_updated = SENS_ACCEL | SENS_GYRO;
 
     // 2. Fill Magnetc field with noise
-    if (time_usec - lastMagTimeUsec_ > MAG_PERIOD_US){
+    if (isMagUpdated){
         sensor_msg.xmag = magFrd[0];
         sensor_msg.ymag = magFrd[1];
         sensor_msg.zmag = magFrd[2];
         sensor_msg.fields_updated |= SENS_MAG;
-        lastMagTimeUsec_ = time_usec;
     }
 
     // 3. Fill Barometr and diff pressure
-    if (time_usec - lastBaroTimeUsec_ > BARO_PERIOD_US){
+    if (isBaroUpdated){
         sensor_msg.temperature = staticTemperature;
         sensor_msg.abs_pressure = staticPressure;
         sensor_msg.pressure_alt = gpsAltitude;
@@ -398,7 +409,6 @@ int MavlinkCommunicator::SendHilSensor(unsigned int time_usec,
         sensor_msg.diff_pressure = diffPressure;
 
         sensor_msg.fields_updated |= SENS_BARO | SENS_DIFF_PRESS;
-        lastBaroTimeUsec_ = time_usec;
     }
 
 
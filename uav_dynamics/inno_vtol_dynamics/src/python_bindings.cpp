@@ -0,0 +1,134 @@
+/**
+ * @file python_bindings.cpp
+ * @brief Python module with the ROS-free simulators
+ *
+ * The state rows have UavDynamicsSimBase::STATE_SIZE elements: position, linear velocity,
+ * attitude (w, x, y, z) and angular velocity, all in NED.
+ */
+
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
+#include <pybind11/eigen.h>
+#include <stdexcept>
+#include <string>
+#include "paramsSource.hpp"
+#include "vtolDynamicsSim.hpp"
+#include "flightgogglesDynamicsSim.hpp"
+
+namespace py = pybind11;
+
+typedef py::array_t<double, py::array::c_style | py::array::forcecast> InputArray;
+typedef py::array_t<double, py::array::c_style> OutputArray;
+
+static Eigen::Vector4d quaternionToArray(const Eigen::Quaterniond& quaternion){
+    return Eigen::Vector4d(quaternion.w(), quaternion.x(), quaternion.y(), quaternion.z());
+}
+
+/**
+ * @brief Commands are converted to a contiguous float64 array only if they are not one
+ * already, the states are written directly into the caller's buffer when it is given
+ */
+static OutputArray stepN(UavDynamicsSimBase& sim,
+                         size_t actuatorsAmount,
+                         InputArray commands,
+                         double dtSecs,
+                         py::object states,
+                         bool isCmdPercent){
+    if(commands.ndim() != 2 || static_cast<size_t>(commands.shape(1)) != actuatorsAmount){
+        throw std::invalid_argument("commands should have shape (T, " + std::to_string(actuatorsAmount) + ")");
+    }
+    const size_t stepsAmount = commands.shape(0);
+
+    OutputArray output;
+    if(states.is_none()){
+        output = OutputArray(std::vector<size_t>{stepsAmount, UavDynamicsSimBase::STATE_SIZE});
+    }else{
+        if(!py::isinstance<OutputArray>(states)){
+            throw std::invalid_argument("states should be a C-contiguous float64 array");
+        }
+        output = py::reinterpret_borrow<OutputArray>(states);
+    }
+    if(output.ndim() != 2 ||
+       static_cast<size_t>(output.shape(0)) != stepsAmount ||
+       static_cast<size_t>(output.shape(1)) != UavDynamicsSimBase::STATE_SIZE){
+        throw std::invalid_argument("states should have shape (T, " +
+                                    std::to_string(UavDynamicsSimBase::STATE_SIZE) + ")");
+    }
+
+    const double* commandsData = commands.data();
+    double* statesData = output.mutable_data();
+    {
+        py::gil_scoped_release release;
+        sim.stepN(dtSecs, commandsData, actuatorsAmount, stepsAmount, statesData, isCmdPercent);
+    }
+    return output;
+}
+
+template<class Sim>
+static py::class_<Sim> bindSim(py::module& m, const char* name, size_t actuatorsAmount){
+    return py::class_<Sim>(m, name)
+        .def(py::init<>())
+        .def("init", [](Sim& sim, const ParamsSource& source){return sim.init(source);}, py::arg("source"))
+        .def("set_initial_position",
+             [](Sim& sim, const Eigen::Vector3d& position, const Eigen::Vector4d& attitude){
+                sim.setInitialPosition(position,
+                                       Eigen::Quaterniond(attitude[0], attitude[1], attitude[2], attitude[3]));
+             },
+             py::arg("position"), py::arg("attitude_wxyz"))
+        .def("land", &Sim::land)
+        .def("process", &Sim::process, py::arg("dt_secs"), py::arg("commands"), py::arg("is_cmd_percent"),
+             py::call_guard<py::gil_scoped_release>())
+        .def("get_position", &Sim::getVehiclePosition)
+        .def("get_attitude", [](const Sim& sim){return quaternionToArray(sim.getVehicleAttitude());})
+        .def("get_velocity", &Sim::getVehicleVelocity)
+        .def("get_angular_velocity", &Sim::getVehicleAngularVelocity)
+        .def("get_state", [](const Sim& sim){
+            OutputArray state(UavDynamicsSimBase::STATE_SIZE);
+            sim.getStateVector(state.mutable_data());
+            return state;
+        })
+        .def("get_imu_measurement", [](Sim& sim){
+            Eigen::Vector3d acc, gyro;
+            sim.getIMUMeasurement(acc, gyro);
+            return py::make_tuple(acc, gyro);
+        })
+        .def("get_motors_rpm", [](Sim& sim){
+            std::vector<double> motorsRpm;
+            sim.getMotorsRpm(motorsRpm);
+            return motorsRpm;
+        })
+        .def("step_n",
+             [actuatorsAmount](Sim& sim, InputArray commands, double dtSecs, py::object states, bool isCmdPercent){
+                return stepN(sim, actuatorsAmount, commands, dtSecs, states, isCmdPercent);
+             },
+             py::arg("commands"), py::arg("dt_secs"), py::arg("states") = py::none(),
+             py::arg("is_cmd_percent") = false)
+        .def_property_readonly_static("ACTUATORS_AMOUNT", [actuatorsAmount](py::object){return actuatorsAmount;});
+}
+
+PYBIND11_MODULE(inno_vtol_dynamics, m){
+    m.doc() = "ROS-free UAV dynamics simulators";
+    m.attr("STATE_SIZE") = UavDynamicsSimBase::STATE_SIZE;
+
+    py::class_<ParamsSource>(m, "ParamsSource");
+    py::class_<YamlParamsSource, ParamsSource>(m, "YamlParamsSource")
+        .def(py::init<>())
+        .def("load", &YamlParamsSource::load, py::arg("path"), py::arg("ns"))
+        .def("load_package_configs", &YamlParamsSource::loadPackageConfigs, py::arg("config_directory"))
+        .def("set", py::overload_cast<const std::string&, const std::vector<double>&>(&YamlParamsSource::set),
+             py::arg("name"), py::arg("value"))
+        .def("set", py::overload_cast<const std::string&, const std::string&>(&YamlParamsSource::set),
+             py::arg("name"), py::arg("value"));
+
+    bindSim<InnoVtolDynamicsSim>(m, "InnoVtolDynamicsSim", 8)
+        .def("set_wind_parameter", &InnoVtolDynamicsSim::setWindParameter,
+             py::arg("wind_mean_velocity"), py::arg("wind_variance"))
+        .def("set_turbulence_parameter", &InnoVtolDynamicsSim::setTurbulenceParameter,
+             py::arg("wind_speed_at_6m"))
+        .def("set_turbulence_seed", &InnoVtolDynamicsSim::setTurbulenceSeed,
+             py::arg("seed"));
+
+    // Flightgoggles wrapper of MulticopterDynamicsSim, the commands are in PX4 order
+    bindSim<FlightgogglesDynamics>(m, "FlightgogglesDynamics", 4);
+}
@@ -0,0 +1,24 @@
+/**
+ * @file ros_params_source.cpp
+ * @brief Simulator parameters from the ROS parameter server implementation
+ */
+
+#include <ros/ros.h>
+#include <ros/package.h>
+#include "ros_params_source.hpp"
+
+bool RosParamsSource::get(const std::string& name, double& value) const{
+    return ros::param::get(name, value);
+}
+
+bool RosParamsSource::get(const std::string& name, std::vector<double>& value) const{
+    return ros::param::get(name, value);
+}
+
+bool RosParamsSource::get(const std::string& name, std::string& value) const{
+    return ros::param::get(name, value);
+}
+
+std::string RosParamsSource::getConfigDirectory() const{
+    return ros::package::getPath("innopolis_vtol_dynamics") + "/config";
+}
@@ -0,0 +1,50 @@
+/**
+ * @file sensor_scheduler.cpp
+ * @brief Multi-rate scheduler of sensor samples implementation
+ */
+
+#include <cmath>
+#include <algorithm>
+#include "sensor_scheduler.hpp"
+
+constexpr uint64_t SensorScheduler::MAX_CATCH_UP_PERIODS;
+
+void SensorScheduler::addSensor(size_t sensorId, double periodSec){
+    uint64_t periodNsec = std::max<uint64_t>(std::llround(periodSec * 1e9), 1);
+    sensors_.push_back({0, sensorId, periodNsec});
+    isStarted_ = false;
+}
+
+void SensorScheduler::clear(){
+    sensors_.clear();
+    queue_ = decltype(queue_)();
+    isStarted_ = false;
+}
+
+bool SensorScheduler::popDue(uint64_t crntTimeNsec, size_t& sensorId, uint64_t& sampleTimeNsec){
+    if(!isStarted_){
+        queue_ = decltype(queue_)();
+        for(auto sensor : sensors_){
+            sensor.dueTimeNsec = crntTimeNsec;
+            queue_.push(sensor);
+        }
+        isStarted_ = true;
+    }
+    if(queue_.empty() || queue_.top().dueTimeNsec > crntTimeNsec){
+        return false;
+    }
+
+    Sample sample = queue_.top();
+    queue_.pop();
+    uint64_t lateness = crntTimeNsec - sample.dueTimeNsec;
+    if(lateness > MAX_CATCH_UP_PERIODS * sample.periodNsec){
+        sample.dueTimeNsec = crntTimeNsec - lateness % sample.periodNsec -
+                             MAX_CATCH_UP_PERIODS * sample.periodNsec;
+    }
+
+    sensorId = sample.sensorId;
+    sampleTimeNsec = sample.dueTimeNsec;
+    sample.dueTimeNsec += sample.periodNsec;
+    queue_.push(sample);
+    return true;
+}
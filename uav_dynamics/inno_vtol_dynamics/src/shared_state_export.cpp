@@ -0,0 +1,142 @@
+/**
+ * @file shared_state_export.cpp
+ * @brief Export of the latest vehicle state into POSIX shared memory implementation
+ */
+
+#include <iostream>
+#include <new>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "shared_state_export.hpp"
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "The seqlock requires lock-free 64-bit atomics in shared memory");
+
+constexpr size_t SharedVehicleState::MAX_ACTUATORS;
+constexpr size_t SharedVehicleState::MAX_MOTORS;
+constexpr size_t SharedStateReader::DEFAULT_MAX_ATTEMPTS;
+
+static constexpr size_t SEGMENT_SIZE = sizeof(SharedStateHeader) + sizeof(SharedVehicleState);
+
+SharedStateWriter::~SharedStateWriter(){
+    close();
+}
+
+int8_t SharedStateWriter::create(const std::string& name){
+    if(header_ != nullptr){
+        return -1;
+    }
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0){
+        std::cerr << "SharedStateWriter: can't open shared memory " << name << std::endl;
+        return -1;
+    }
+    if(ftruncate(fd, SEGMENT_SIZE) != 0){
+        ::close(fd);
+        return -1;
+    }
+    void* mapped = mmap(nullptr, SEGMENT_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if(mapped == MAP_FAILED){
+        return -1;
+    }
+    header_ = new (mapped) SharedStateHeader;
+    state_ = reinterpret_cast<SharedVehicleState*>(static_cast<uint8_t*>(mapped) + sizeof(SharedStateHeader));
+    header_->version = SHARED_STATE_VERSION;
+    header_->stateSize = sizeof(SharedVehicleState);
+    header_->sequence.store(0);
+    std::atomic_thread_fence(std::memory_order_release);
+    header_->magic = SHARED_STATE_MAGIC;
+    name_ = name;
+    return 0;
+}
+
+void SharedStateWriter::write(const SharedVehicleState& state){
+    if(header_ == nullptr){
+        return;
+    }
+    uint64_t sequence = header_->sequence.load(std::memory_order_relaxed);
+    header_->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    *state_ = state;
+    header_->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+void SharedStateWriter::close(){
+    if(header_ == nullptr){
+        return;
+    }
+    munmap(header_, SEGMENT_SIZE);
+    shm_unlink(name_.c_str());
+    header_ = nullptr;
+    state_ = nullptr;
+}
+
+SharedStateReader::~SharedStateReader(){
+    close();
+}
+
+int8_t SharedStateReader::open(const std::string& name){
+    if(header_ != nullptr){
+        return -1;
+    }
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if(fd < 0){
+        return -1;
+    }
+    struct stat fileStat;
+    if(fstat(fd, &fileStat) != 0 || static_cast<size_t>(fileStat.st_size) < SEGMENT_SIZE){
+        ::close(fd);
+        return -1;
+    }
+    void* mapped = mmap(nullptr, SEGMENT_SIZE, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if(mapped == MAP_FAILED){
+        return -1;
+    }
+    header_ = static_cast<const SharedStateHeader*>(mapped);
+    state_ = reinterpret_cast<const SharedVehicleState*>(static_cast<const uint8_t*>(mapped) +
+                                                         sizeof(SharedStateHeader));
+    if(header_->magic != SHARED_STATE_MAGIC ||
+       header_->version != SHARED_STATE_VERSION ||
+       header_->stateSize != sizeof(SharedVehicleState)){
+        std::cerr << "SharedStateReader: " << name << " has unsupported layout" << std::endl;
+        close();
+        return -1;
+    }
+    return 0;
+}
+
+void SharedStateReader::close(){
+    if(header_ == nullptr){
+        return;
+    }
+    munmap(const_cast<SharedStateHeader*>(header_), SEGMENT_SIZE);
+    header_ = nullptr;
+    state_ = nullptr;
+}
+
+bool SharedStateReader::read(SharedVehicleState& state, size_t maxAttempts) const{
+    if(header_ == nullptr){
+        return false;
+    }
+    for(size_t attempt = 0; attempt < maxAttempts; attempt++){
+        uint64_t sequence = header_->sequence.load(std::memory_order_acquire);
+        if(sequence == 0){
+            return false;
+        }else if(sequence & 1){
+            continue;
+        }
+        state = *state_;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if(header_->sequence.load(std::memory_order_relaxed) == sequence){
+            return true;
+        }
+    }
+    return false;
+}
+
+uint64_t SharedStateReader::getSequence() const{
+    return header_ == nullptr ? 0 : header_->sequence.load(std::memory_order_acquire);
+}
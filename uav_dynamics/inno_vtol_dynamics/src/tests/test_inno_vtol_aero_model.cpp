@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+#include <ros/ros.h>
+#include <Eigen/Geometry>
+#include "vtolDynamicsSim.hpp"
+#include "ros_params_source.hpp"
+#include "innoVtolAirframe.hpp"
+#include "innoVtolAeroModel.hpp"
+
+typedef InnoVtolAeroModel<InnoVtolAirframe> AeroModel;
+
+static_assert(AeroModel::TABLES.CLPolynomial.rows() == 8 && AeroModel::TABLES.CLPolynomial.cols() == 8,
+              "the views have the shape of TablesWithCoeffs");
+static_assert(AeroModel::TABLES.airspeed(7) == InnoVtolAirframe::airspeed[7],
+              "the views are read at compile time");
+static_assert(-AeroModel::TABLES.actuator(0) == -InnoVtolAirframe::actuator[0],
+              "the negated view is read at compile time");
+
+TEST(InnoVtolAeroModel, generatedTablesMatchYaml){
+    TablesWithCoeffs generated, loaded;
+    AeroModel::loadTables(generated);
+    InnoVtolDynamicsSim::loadTables(RosParamsSource(), "/uav/aerodynamics_coeffs/", loaded);
+    EXPECT_TRUE(generated.CS_rudder == loaded.CS_rudder);
+    EXPECT_TRUE(generated.CS_beta == loaded.CS_beta);
+    EXPECT_TRUE(generated.AoA == loaded.AoA);
+    EXPECT_TRUE(generated.AoS == loaded.AoS);
+    EXPECT_TRUE(generated.actuator == loaded.actuator);
+    EXPECT_TRUE(generated.airspeed == loaded.airspeed);
+    EXPECT_TRUE(generated.CLPolynomial == loaded.CLPolynomial);
+    EXPECT_TRUE(generated.CSPolynomial == loaded.CSPolynomial);
+    EXPECT_TRUE(generated.CDPolynomial == loaded.CDPolynomial);
+    EXPECT_TRUE(generated.CmxPolynomial == loaded.CmxPolynomial);
+    EXPECT_TRUE(generated.CmyPolynomial == loaded.CmyPolynomial);
+    EXPECT_TRUE(generated.CmzPolynomial == loaded.CmzPolynomial);
+    EXPECT_TRUE(generated.CmxAileron == loaded.CmxAileron);
+    EXPECT_TRUE(generated.CmyElevator == loaded.CmyElevator);
+    EXPECT_TRUE(generated.CmzRudder == loaded.CmzRudder);
+    EXPECT_TRUE(generated.prop == loaded.prop);
+    EXPECT_EQ(generated.actuatorTimeConstants, loaded.actuatorTimeConstants);
+}
+
+TEST(InnoVtolAeroModel, compileTimeTablesMatchKernel){
+    TablesWithCoeffs loaded;
+    InnoVtolDynamicsSim::loadTables(RosParamsSource(), "/uav/aerodynamics_coeffs/", loaded);
+    VtolParameters params{};
+    InnoVtolDynamicsSim::loadParams(RosParamsSource(), "/uav/vtol_params/", params);
+    AeroModel model(params);
+    VtolDynamicsKernel<double> kernel;
+    kernel.init(params, loaded);
+
+    for(double airspeedMod : {3.0, 9.5, 15.0, 27.0, 45.0}){
+        for(double surface : {-20.0, -7.5, 0.0, 4.0, 20.0}){
+            Eigen::Vector3d airspeed = airspeedMod * Eigen::Vector3d(0.95, 0.1, 0.3).normalized();
+            double AoA = kernel.calculateAnglesOfAtack(airspeed);
+            double AoS = kernel.calculateAnglesOfSideslip(airspeed);
+            Eigen::Vector3d modelForce, modelMoment, kernelForce, kernelMoment;
+            model.calculateAerodynamics(airspeed, AoA, AoS, surface, -surface, 0.5 * surface,
+                                        modelForce, modelMoment);
+            kernel.calculateAerodynamics(airspeed, AoA, AoS, surface, -surface, 0.5 * surface,
+                                         kernelForce, kernelMoment);
+            EXPECT_TRUE(modelForce == kernelForce);
+            EXPECT_TRUE(modelMoment == kernelMoment);
+        }
+    }
+}
+
+int main(int argc, char *argv[]){
+    testing::InitGoogleTest(&argc, argv);
+    ros::init(argc, argv, "tester");
+    return RUN_ALL_TESTS();
+}
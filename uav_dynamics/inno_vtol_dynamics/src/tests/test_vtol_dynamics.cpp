@@ -1,10 +1,35 @@
 #include <gtest/gtest.h>
+#include <ros/ros.h>
 #include <iostream>
+#include <fstream>
 #include <Eigen/Geometry>
 #include <random>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
 #include <geographiclib_conversions/geodetic_conv.hpp>
 #include "sensors_isa_model.hpp"
 #include "vtolDynamicsSim.hpp"
+#include "drydenTurbulence.hpp"
+#include "windField.hpp"
+#include "aeroTablesCache.hpp"
+#include "vtolParamsIdentification.hpp"
+#include "mag_field_cache.hpp"
+#include "local_geodetic_converter.hpp"
+#include "sensor_scheduler.hpp"
+#include "imu_decimator.hpp"
+#include "paramsSource.hpp"
+#include "ros_params_source.hpp"
+#include "vtolVectorEnv.hpp"
+#include "shared_state_export.hpp"
+#include "flightgogglesDynamicsSim.hpp"
+#include "actuatorsDynamics.hpp"
+#include "attitudeIntegration.hpp"
+#include "vtolDynamicsKernel.hpp"
+#include "vtolLinearization.hpp"
+#include "vtolModelReloader.hpp"
+#include "airframeRegistry.hpp"
+#include "../../libs/multicopterDynamicsSim/multicopterDynamicsSim.hpp"
 
 TEST(InnoVtolDynamicsSim, calculateWind){
     InnoVtolDynamicsSim vtolDynamicsSim;
@@ -99,7 +124,7 @@ TEST(InnoVtolDynamicsSim, findRow){
 
 TEST(InnoVtolDynamicsSim, calculateCLPolynomial){
     InnoVtolDynamicsSim vtolDynamicsSim;
-    vtolDynamicsSim.init();
+    vtolDynamicsSim.init(RosParamsSource());
     Eigen::VectorXd calculatedpolynomialCoeffs(7);
     Eigen::VectorXd expectedPolynomialCoeffs(7);
     Eigen::VectorXd diff(7);
@@ -132,7 +157,7 @@ TEST(InnoVtolDynamicsSim, calculateCLPolynomial){
 
 TEST(InnoVtolDynamicsSim, DISABLED_calculateLiftForce){
     InnoVtolDynamicsSim vtolDynamicsSim;
-    vtolDynamicsSim.init();
+    vtolDynamicsSim.init(RosParamsSource());
     auto isZeroComparator = [](double a) { return abs(a) < 0.00001;};
 
     Eigen::VectorXd polynomialCoeffs(7);
@@ -153,7 +178,7 @@ TEST(InnoVtolDynamicsSim, DISABLED_calculateLiftForce){
 
 TEST(InnoVtolDynamicsSim, DISABLED_estimate_atmosphere){
     InnoVtolDynamicsSim vtolDynamicsSim;
-    vtolDynamicsSim.init();
+    vtolDynamicsSim.init(RosParamsSource());
 
     Eigen::Vector3d gpsPosition, linVelNed, enuPosition;
     float temperatureKelvin, absPressureHpa, diffPressureHpa;
@@ -185,7 +210,7 @@ TEST(InnoVtolDynamicsSim, polyval){
 
 TEST(InnoVtolDynamicsSim, griddata){
     InnoVtolDynamicsSim vtolDynamicsSim;
-    vtolDynamicsSim.init();
+    vtolDynamicsSim.init(RosParamsSource());
     Eigen::MatrixXd x(1, 3);
     Eigen::MatrixXd y(1, 4);
     Eigen::MatrixXd f(4, 3);
@@ -212,7 +237,7 @@ TEST(InnoVtolDynamicsSim, griddata){
 
 TEST(InnoVtolDynamicsSim, calculateCSRudder){
     InnoVtolDynamicsSim vtolDynamicsSim;
-    vtolDynamicsSim.init();
+    vtolDynamicsSim.init(RosParamsSource());
 
     struct DataSet{
         double rudder_position;
@@ -241,7 +266,7 @@ TEST(InnoVtolDynamicsSim, calculateCSRudder){
 
 TEST(InnoVtolDynamicsSim, calculateCSBeta){
     InnoVtolDynamicsSim vtolDynamicsSim;
-    vtolDynamicsSim.init();
+    vtolDynamicsSim.init(RosParamsSource());
 
     struct DataSet{
         double aos_degree;
@@ -265,7 +290,7 @@ TEST(InnoVtolDynamicsSim, calculateCSBeta){
 
 TEST(InnoVtolDynamicsSim, DISABLED_calculateCmxAileron){
     InnoVtolDynamicsSim vtolDynamicsSim;
-    vtolDynamicsSim.init();
+    vtolDynamicsSim.init(RosParamsSource());
     double Cmx_aileron, airspeedNorm, aileron_pos, dynamicPressure;
     double characteristicLength = 1.5;
 
@@ -280,7 +305,7 @@ TEST(InnoVtolDynamicsSim, DISABLED_calculateCmxAileron){
 
 TEST(InnoVtolDynamicsSim, calculateAerodynamics){
     InnoVtolDynamicsSim vtolDynamicsSim;
-    vtolDynamicsSim.init();
+    vtolDynamicsSim.init(RosParamsSource());
     Eigen::Vector3d diff, expectedResult, Faero, Maero;
     double Cmx_a, Cmy_e, Cmz_r;
     auto isZeroComparator = [](double a) {return abs(a) < 0.001;};
@@ -305,7 +330,7 @@ TEST(InnoVtolDynamicsSim, calculateAerodynamics){
 
 TEST(InnoVtolDynamicsSim, calculateAerodynamicsCaseAileron){
     InnoVtolDynamicsSim vtolDynamicsSim;
-    vtolDynamicsSim.init();
+    vtolDynamicsSim.init(RosParamsSource());
     Eigen::Vector3d diff, expectedResult, Faero, Maero;
     double Cmx_a, Cmy_e, Cmz_r;
     auto isZeroComparator = [](double a) {return abs(a) < 0.02;};
@@ -330,7 +355,7 @@ TEST(InnoVtolDynamicsSim, calculateAerodynamicsCaseAileron){
 
 TEST(InnoVtolDynamicsSim, calculateAerodynamicsCaseElevator){
     InnoVtolDynamicsSim vtolDynamicsSim;
-    vtolDynamicsSim.init();
+    vtolDynamicsSim.init(RosParamsSource());
     Eigen::Vector3d diff, expectedResult, Faero, Maero;
     double Cmx_a, Cmy_e, Cmz_r;
     auto isZeroComparator = [](double a) {return abs(a) < 0.02;};
@@ -355,7 +380,7 @@ TEST(InnoVtolDynamicsSim, calculateAerodynamicsCaseElevator){
 
 TEST(InnoVtolDynamicsSim, calculateAerodynamicsAoA){
     InnoVtolDynamicsSim vtolDynamicsSim;
-    vtolDynamicsSim.init();
+    vtolDynamicsSim.init(RosParamsSource());
     Eigen::Vector3d diff, expectedResult, Faero, Maero;
     double Cmx_a, Cmy_e, Cmz_r;
     auto isZeroComparator = [](double a) {return abs(a) < 0.04;};
@@ -380,7 +405,7 @@ TEST(InnoVtolDynamicsSim, calculateAerodynamicsAoA){
 
 TEST(InnoVtolDynamicsSim, calculateAerodynamicsRealCase){
     InnoVtolDynamicsSim vtolDynamicsSim;
-    vtolDynamicsSim.init();
+    vtolDynamicsSim.init(RosParamsSource());
     Eigen::Vector3d diff, expectedResult, Faero, Maero;
     double Cmx_a, Cmy_e, Cmz_r;
     auto isZeroComparator = [](double a) {return abs(a) < 0.02;};
@@ -405,7 +430,7 @@ TEST(InnoVtolDynamicsSim, calculateAerodynamicsRealCase){
 
 TEST(thruster, thrusterFirstZeroCmd){
     InnoVtolDynamicsSim vtolDynamicsSim;
-    vtolDynamicsSim.init();
+    vtolDynamicsSim.init(RosParamsSource());
     double control,
            actualThrust, actualTorque, actualRpm,
            expectedThrust, expectedTorque, expectedRpm;
@@ -421,7 +446,7 @@ TEST(thruster, thrusterFirstZeroCmd){
 }
 TEST(thruster, thrusterSecond){
     InnoVtolDynamicsSim vtolDynamicsSim;
-    vtolDynamicsSim.init();
+    vtolDynamicsSim.init(RosParamsSource());
     double control,
            actualThrust, actualTorque, actualRpm,
            expectedThrust, expectedTorque, expectedRpm;
@@ -437,7 +462,7 @@ TEST(thruster, thrusterSecond){
 }
 TEST(thruster, thrusterThird){
     InnoVtolDynamicsSim vtolDynamicsSim;
-    vtolDynamicsSim.init();
+    vtolDynamicsSim.init(RosParamsSource());
     double control,
            actualThrust, actualTorque, actualRpm,
            expectedThrust, expectedTorque, expectedRpm;
@@ -469,7 +494,7 @@ void calculateNewState(double dt,
                     Eigen::Vector3d& angularAcceleration,
                     Eigen::Vector3d& linearAcceleration){
     InnoVtolDynamicsSim vtolDynamicsSim;
-    vtolDynamicsSim.init();
+    vtolDynamicsSim.init(RosParamsSource());
     vtolDynamicsSim.setInitialVelocity(initialLinearVelocity, initialAngularVelocity);
     vtolDynamicsSim.setInitialPosition(initialPosition, initialAttitude);
 
@@ -711,6 +736,1183 @@ TEST(InnoVtolDynamicsSim, calculateNewStateEightComplexFull){
     ASSERT_TRUE(std::all_of(&diff[0], &diff[3], isZeroComparator));
 }
 
+TEST(DrydenTurbulence, disabled){
+    DrydenTurbulence turbulence;
+    DrydenFilterState state;
+    turbulence.init(0.0);
+    ASSERT_FALSE(turbulence.isEnabled());
+    for(size_t idx = 0; idx < 100; idx++){
+        ASSERT_TRUE(turbulence.process(state, 0.01, 20.0, 100.0) == Eigen::Vector3d::Zero());
+    }
+}
+
+TEST(DrydenTurbulence, stationaryDeviation){
+    const double W20 = 15.4;
+    const double ALTITUDE = 303.0;
+    const double AIRSPEED = 21.0;
+    const size_t SAMPLES = 400000;
+    const double ALTITUDE_FT = ALTITUDE / 0.3048;
+    const double EXPECTED_SIGMA_W = 0.1 * W20;
+    const double EXPECTED_SIGMA_U = EXPECTED_SIGMA_W / std::pow(0.177 + 0.000823 * ALTITUDE_FT, 0.4);
+
+    DrydenTurbulence turbulence;
+    DrydenFilterState state;
+    turbulence.init(W20);
+    Eigen::Vector3d sumOfSquares = Eigen::Vector3d::Zero();
+    for(size_t idx = 0; idx < SAMPLES; idx++){
+        const Eigen::Vector3d& gust = turbulence.process(state, 0.01, AIRSPEED, ALTITUDE);
+        sumOfSquares += gust.cwiseProduct(gust);
+    }
+    Eigen::Vector3d sigma = (sumOfSquares / SAMPLES).cwiseSqrt();
+
+    ASSERT_NEAR(sigma[0], EXPECTED_SIGMA_U, 0.1 * EXPECTED_SIGMA_U);
+    ASSERT_NEAR(sigma[1], EXPECTED_SIGMA_U, 0.1 * EXPECTED_SIGMA_U);
+    ASSERT_NEAR(sigma[2], EXPECTED_SIGMA_W, 0.1 * EXPECTED_SIGMA_W);
+}
+
+TEST(DrydenTurbulence, seedSelectsGustSequence){
+    DrydenTurbulence turbulence;
+    turbulence.init(15.4);
+    std::array<DrydenFilterState, 3> states;
+    DrydenTurbulence::seed(states[0], 1);
+    DrydenTurbulence::seed(states[1], 1);
+    DrydenTurbulence::seed(states[2], 2);
+
+    double maxSameSeedDiff = 0;
+    double maxOtherSeedDiff = 0;
+    for(size_t idx = 0; idx < 1000; idx++){
+        std::array<Eigen::Vector3d, 3> gusts;
+        for(size_t vehicle = 0; vehicle < states.size(); vehicle++){
+            gusts[vehicle] = turbulence.process(states[vehicle], 0.01, 20.0, 100.0);
+        }
+        maxSameSeedDiff = std::max(maxSameSeedDiff, (gusts[0] - gusts[1]).norm());
+        maxOtherSeedDiff = std::max(maxOtherSeedDiff, (gusts[0] - gusts[2]).norm());
+    }
+    ASSERT_EQ(maxSameSeedDiff, 0.0);
+    ASSERT_GT(maxOtherSeedDiff, 0.1);
+}
+
+TEST(InnoVtolDynamicsSim, turbulenceSeedParameter){
+    YamlParamsSource source;
+    ASSERT_EQ(source.loadPackageConfigs(RosParamsSource().getConfigDirectory()), 0);
+    VtolParameters params{};
+    EXPECT_EQ(params.turbulenceSeed, 0);
+
+    source.set("/uav/vtol_params/turbulenceSeed", std::vector<double>{4294967295.0});
+    InnoVtolDynamicsSim::loadParams(source, "/uav/vtol_params/", params);
+    EXPECT_EQ(params.turbulenceSeed, 4294967295u);
+
+    // out of uint32 or fractional seeds are rejected instead of being truncated
+    for(double seed : {4294967296.0 + 7.0, 7.5}){
+        source.set("/uav/vtol_params/turbulenceSeed", std::vector<double>{seed});
+        InnoVtolDynamicsSim::loadParams(source, "/uav/vtol_params/", params);
+        EXPECT_NE(params.turbulenceSeed, 7);
+    }
+}
+
+TEST(WindField, trilinearInterpolationOfLinearField){
+    auto linearWind = [](const Eigen::Vector3d& position, double time){
+        return Eigen::Vector3d(0.1 * position[0] + 2.0,
+                               -0.05 * position[1] + 0.2 * time,
+                               0.02 * position[2] - 0.01 * position[0]);
+    };
+    WindFieldGrid grid = {{11, 7, 6}, 3, {-50.0, -30.0, -100.0}, {10.0, 10.0, 20.0}, 5.0};
+    std::string path = testing::TempDir() + "wind_field_test.bin";
+    ASSERT_EQ(WindField::generate(path, grid, linearWind), 0);
+
+    WindField windField;
+    ASSERT_EQ(windField.open(path), 0);
+    std::default_random_engine generator;
+    std::uniform_real_distribution<double> distribution(0.0, 1.0);
+    for(size_t idx = 0; idx < 1000; idx++){
+        Eigen::Vector3d position(-50.0 + 100.0 * distribution(generator),
+                                 -30.0 + 60.0 * distribution(generator),
+                                 -100.0 + 100.0 * distribution(generator));
+        double time = 10.0 * distribution(generator);
+        Eigen::Vector3d diff = windField.sample(position, time) - linearWind(position, time);
+        ASSERT_LT(diff.norm(), 1e-04);
+    }
+
+    // outside of the grid the nearest boundary value is used
+    Eigen::Vector3d diff = windField.sample(Eigen::Vector3d(1000, 0, 0), 100.0) -
+                           linearWind(Eigen::Vector3d(50, 0, 0), 10.0);
+    ASSERT_LT(diff.norm(), 1e-04);
+    windField.close();
+    std::remove(path.c_str());
+}
+
+TEST(WindField, snapshotRestoresFieldClock){
+    auto changingWind = [](const Eigen::Vector3d& position, double time){
+        return Eigen::Vector3d(0.5 * time, 0.0, 0.0);
+    };
+    WindFieldGrid grid = {{2, 2, 2}, 11, {-100.0, -100.0, -100.0}, {200.0, 200.0, 200.0}, 1.0};
+    std::string path = testing::TempDir() + "wind_field_snapshot_test.bin";
+    ASSERT_EQ(WindField::generate(path, grid, changingWind), 0);
+
+    InnoVtolDynamicsSim sim;
+    VtolParameters params;
+    TablesWithCoeffs tables;
+    InnoVtolDynamicsSim::loadParams(RosParamsSource(), "/uav/vtol_params/", params);
+    InnoVtolDynamicsSim::loadTables(RosParamsSource(), "/uav/aerodynamics_coeffs/", tables);
+    params.turbulenceWindSpeedAt6m = 0;
+    params.windFieldPath = path;
+    ASSERT_EQ(sim.init(params, tables), 0);
+    sim.setInitialPosition(Eigen::Vector3d(0, 0, -50), Eigen::Quaterniond(1, 0, 0, 0));
+    const std::vector<double> cmd(8, 0.0);
+
+    for(size_t step = 0; step < 200; step++){
+        sim.process(0.01, cmd, false);
+    }
+    const State snapshot = sim.getState();
+    for(size_t step = 0; step < 300; step++){
+        sim.process(0.01, cmd, false);
+    }
+    const Eigen::Vector3d firstRun = sim.getState().windVelocity;
+
+    sim.setState(snapshot);
+    for(size_t step = 0; step < 300; step++){
+        sim.process(0.01, cmd, false);
+    }
+    EXPECT_NEAR(firstRun[0], 2.5, 1e-3);
+    EXPECT_EQ(sim.getState().windVelocity, firstRun);
+    std::remove(path.c_str());
+}
+
+TEST(MagFieldCache, toleranceAndRefreshes){
+    const double LAT_REF = 55.7544426, LON_REF = 48.742684, ALT_REF = -6.4;
+    const double TOLERANCE = 0.0005;
+    MagFieldCache magFieldCache;
+    magFieldCache.init(LAT_REF, LON_REF, ALT_REF, TOLERANCE);
+
+    // 2 km flight to the north-east, a point per 1 meter
+    for(size_t idx = 0; idx < 2000; idx++){
+        double lat = LAT_REF + idx * 0.00001;
+        double lon = LON_REF + idx * 0.00001;
+        double alt = ALT_REF + idx * 0.1;
+        Eigen::Vector3d diff = magFieldCache.getNed(lat, lon, alt) - MagFieldCache::calculateNed(lat, lon, alt);
+        ASSERT_LT(diff.norm(), 2 * TOLERANCE);
+    }
+    ASSERT_LT(magFieldCache.getRefreshesAmount(), 10);
+}
+
+TEST(LocalGeodeticConverter, errorBoundedByExactConverter){
+    const double LAT_REF = 55.7544426, LON_REF = 48.742684, ALT_REF = -6.4;
+    const double METERS_PER_DEGREE = 111320.0;
+    geodetic_converter::GeodeticConverter exactConverter;
+    exactConverter.initialiseReference(LAT_REF, LON_REF, ALT_REF);
+    LocalGeodeticConverter localConverter;
+    localConverter.initialiseReference(LAT_REF, LON_REF, ALT_REF);
+
+    // 30 km straight flight with climbing, so the anchor is moved several times
+    Eigen::Vector3d enu, exact, local;
+    for(double distance = 0; distance < 30000; distance += 0.5){
+        enu << 0.6 * distance, -0.8 * distance + 200 * sin(distance * 0.001), 0.02 * distance;
+        exactConverter.enu2Geodetic(enu[0], enu[1], enu[2], &exact[0], &exact[1], &exact[2]);
+        localConverter.enu2Geodetic(enu, local);
+        ASSERT_LT(std::abs(local[0] - exact[0]) * METERS_PER_DEGREE, 0.001);
+        ASSERT_LT(std::abs(local[1] - exact[1]) * METERS_PER_DEGREE * cos(LAT_REF * M_PI / 180), 0.001);
+        ASSERT_LT(std::abs(local[2] - exact[2]), 0.001);
+    }
+    ASSERT_GT(localConverter.getAnchorsAmount(), 25);
+    ASSERT_LT(localConverter.getAnchorsAmount(), 40);
+
+    // the bound holds at the valid radius in any direction at any latitude
+    const double UP = 100.0;
+    const double HORIZONTAL = std::sqrt(std::pow(LocalGeodeticConverter::DEFAULT_VALID_RADIUS, 2) - UP * UP);
+    for(double latitude = -80.0; latitude <= 80.0; latitude += 5.0){
+        exactConverter.initialiseReference(latitude, LON_REF, ALT_REF);
+        for(double azimuth = 0; azimuth < 2 * M_PI; azimuth += M_PI / 36){
+            localConverter.initialiseReference(latitude, LON_REF, ALT_REF);
+            enu << 0.999 * HORIZONTAL * sin(azimuth), 0.999 * HORIZONTAL * cos(azimuth), UP;
+            exactConverter.enu2Geodetic(enu[0], enu[1], enu[2], &exact[0], &exact[1], &exact[2]);
+            localConverter.enu2Geodetic(enu, local);
+            ASSERT_EQ(localConverter.getAnchorsAmount(), 1);
+            ASSERT_LT(std::abs(local[0] - exact[0]) * METERS_PER_DEGREE, 0.001);
+            ASSERT_LT(std::abs(local[1] - exact[1]) * METERS_PER_DEGREE * cos(latitude * M_PI / 180), 0.001);
+            ASSERT_LT(std::abs(local[2] - exact[2]), 0.001);
+        }
+    }
+}
+
+TEST(SensorScheduler, exactRatesWithIrregularTicks){
+    const uint64_t START_NSEC = 1000000000;
+    const size_t IMU = 0, GPS = 1, MAG = 2;
+    SensorScheduler scheduler;
+    scheduler.addSensor(IMU, 0.005);
+    scheduler.addSensor(GPS, 0.1);
+    scheduler.addSensor(MAG, 0.03);
+
+    std::default_random_engine generator;
+    std::uniform_int_distribution<uint64_t> tickDistribution(200000, 3000000);
+    std::array<std::vector<uint64_t>, 3> samples;
+    const uint64_t END_NSEC = START_NSEC + 10000000000;
+    uint64_t crntTimeNsec = START_NSEC;
+    uint64_t prevSampleTimeNsec = 0;
+    while(crntTimeNsec <= END_NSEC){
+        size_t sensorId;
+        uint64_t sampleTimeNsec;
+        while(scheduler.popDue(crntTimeNsec, sensorId, sampleTimeNsec)){
+            ASSERT_LE(sampleTimeNsec, crntTimeNsec);
+            ASSERT_GE(sampleTimeNsec, prevSampleTimeNsec);
+            prevSampleTimeNsec = sampleTimeNsec;
+            samples[sensorId].push_back(sampleTimeNsec);
+        }
+        crntTimeNsec = (crntTimeNsec == END_NSEC) ? END_NSEC + 1 :
+                       std::min(crntTimeNsec + tickDistribution(generator), END_NSEC);
+    }
+
+    // 10 seconds + the sample at the start time
+    ASSERT_EQ(samples[IMU].size(), 2001);
+    ASSERT_EQ(samples[GPS].size(), 101);
+    ASSERT_EQ(samples[MAG].size(), 334);
+    for(size_t idx = 0; idx < samples[IMU].size(); idx++){
+        ASSERT_EQ(samples[IMU][idx], START_NSEC + idx * 5000000);
+    }
+}
+
+TEST(SensorScheduler, skipTooOldSamples){
+    SensorScheduler scheduler;
+    scheduler.addSensor(0, 0.01);
+    size_t sensorId;
+    uint64_t sampleTimeNsec;
+    ASSERT_TRUE(scheduler.popDue(0, sensorId, sampleTimeNsec));
+    ASSERT_FALSE(scheduler.popDue(0, sensorId, sampleTimeNsec));
+
+    // after a 1 second stall only the last MAX_CATCH_UP_PERIODS samples are emitted
+    size_t emitted = 0;
+    while(scheduler.popDue(1000000000, sensorId, sampleTimeNsec)){
+        emitted++;
+    }
+    ASSERT_EQ(emitted, SensorScheduler::MAX_CATCH_UP_PERIODS + 1);
+    ASSERT_EQ(sampleTimeNsec, 1000000000);
+}
+
+TEST(ImuDecimator, attenuateAboveOutputNyquist){
+    const double INPUT_RATE = 960, OUTPUT_RATE = 200;
+    ImuDecimator decimator;
+    ASSERT_EQ(decimator.init(INPUT_RATE, OUTPUT_RATE), 0);
+
+    // constant signal passes with unity gain, 400 Hz vibration is suppressed
+    Eigen::Vector3d acc(0, 0, -9.8), gyro(0.1, -0.2, 0.3), vibration(2.0, 2.0, 2.0);
+    Eigen::Vector3d filteredAcc, filteredGyro;
+    double maxError = 0;
+    for(size_t idx = 0; idx < 960; idx++){
+        double phase = 2 * M_PI * 400 * idx / INPUT_RATE;
+        decimator.push(acc + vibration * std::sin(phase), gyro + vibration * std::sin(phase), 1 / INPUT_RATE);
+        decimator.getFiltered(filteredAcc, filteredGyro);
+        if(idx > decimator.getTapsAmount()){
+            maxError = std::max(maxError, (filteredAcc - acc).cwiseAbs().maxCoeff());
+            maxError = std::max(maxError, (filteredGyro - gyro).cwiseAbs().maxCoeff());
+        }
+    }
+    ASSERT_LT(maxError, 0.05 * vibration[0]);
+}
+
+TEST(ImuDecimator, deltasIntegrateFullRate){
+    const double INPUT_RATE = 960, OUTPUT_RATE = 200;
+    ImuDecimator decimator;
+    ASSERT_EQ(decimator.init(INPUT_RATE, OUTPUT_RATE), 0);
+
+    // zero mean vibration vanishes from the integrals over the whole periods
+    Eigen::Vector3d acc(1.0, 2.0, -9.8), gyro(0.1, -0.2, 0.3), vibration(5.0, 5.0, 5.0);
+    for(size_t idx = 0; idx < 960; idx++){
+        double phase = 2 * M_PI * 120 * idx / INPUT_RATE;
+        decimator.push(acc + vibration * std::sin(phase), gyro + vibration * std::sin(phase), 1 / INPUT_RATE);
+    }
+    Eigen::Vector3d deltaVelocity, deltaAngle;
+    double dtSecs;
+    decimator.popDeltas(deltaVelocity, deltaAngle, dtSecs);
+    ASSERT_NEAR(dtSecs, 1.0, 1e-9);
+    ASSERT_LT((deltaVelocity - acc).norm(), 1e-9);
+    ASSERT_LT((deltaAngle - gyro).norm(), 1e-9);
+
+    decimator.popDeltas(deltaVelocity, deltaAngle, dtSecs);
+    ASSERT_EQ(dtSecs, 0.0);
+    ASSERT_EQ(deltaAngle.norm(), 0.0);
+}
+
+TEST(VtolParamsIdentification, nelderMeadQuadratic){
+    auto cost = [](const std::vector<double>& x){
+        return (x[0] - 1) * (x[0] - 1) + 10 * (x[1] + 2) * (x[1] + 2) + (x[0] - 1) * (x[1] + 2);
+    };
+    std::vector<double> x{5, 5};
+    double bestCost = minimizeNelderMead(cost, x, {1, 1}, 500, 1e-14);
+    ASSERT_NEAR(x[0], 1, 1e-4);
+    ASSERT_NEAR(x[1], -2, 1e-4);
+    ASSERT_LT(bestCost, 1e-8);
+}
+
+TEST(VtolParamsIdentification, recoverPerturbedEntry){
+    InnoVtolDynamicsSim vtolDynamicsSim;
+    vtolDynamicsSim.init(RosParamsSource());
+    vtolDynamicsSim.setTurbulenceParameter(0);
+    vtolDynamicsSim.setInitialPosition(Eigen::Vector3d(0, 0, -100), Eigen::Quaterniond::Identity());
+    vtolDynamicsSim.setInitialVelocity(Eigen::Vector3d(22, 0, 0), Eigen::Vector3d::Zero());
+
+    // synthetic log recorded with the same step as the identification uses
+    FlightLog log;
+    std::vector<double> actuators{0, 0, 0, 0, 0.5, 0.1, 0, 0.6};
+    for(size_t idx = 0; idx < 200; idx++){
+        FlightLogSample sample;
+        sample.timeSec = idx * 0.01;
+        sample.position = vtolDynamicsSim.getVehiclePosition();
+        sample.linearVel = vtolDynamicsSim.getVehicleVelocity();
+        sample.attitude = vtolDynamicsSim.getVehicleAttitude();
+        sample.angularVel = vtolDynamicsSim.getVehicleAngularVelocity();
+        sample.actuators = actuators;
+        log.push_back(sample);
+        for(size_t step = 0; step < 5; step++){
+            vtolDynamicsSim.process(0.002, actuators, true);
+        }
+    }
+
+    VtolParamsIdentification identification;
+    std::vector<TableEntry> entries{{"CmyPolynomial", 3, 7}};
+    ASSERT_EQ(identification.init(RosParamsSource(), log, entries, 0.5, 4), 0);
+    ASSERT_EQ(identification.getSegmentsAmount(), 4);
+
+    auto values = identification.getInitialValues();
+    const double expected = values[0];
+    ASSERT_LT(identification.evaluate(values), 1e-12);
+
+    values[0] *= 1.5;
+    const double perturbedResidual = identification.evaluate(values);
+    ASSERT_GT(perturbedResidual, 1e-6);
+    ASSERT_LT(identification.evaluate(identification.getInitialValues()), 1e-12);
+    ASSERT_EQ(identification.evaluate(values), perturbedResidual);
+    identification.identify(values);
+    ASSERT_NEAR(values[0], expected, 1e-3 * std::abs(expected));
+}
+
+TEST(AeroTablesCache, roundTripAndRejectCorrupted){
+    InnoVtolDynamicsSim vtolDynamicsSim;
+    vtolDynamicsSim.init(RosParamsSource());
+    const TablesWithCoeffs& expected = vtolDynamicsSim.getTables();
+    std::string path = testing::TempDir() + "aero_tables_cache_test.bin";
+    const uint64_t SOURCE_CHECKSUM = 42;
+    ASSERT_EQ(AeroTablesCache::save(path, SOURCE_CHECKSUM, expected), 0);
+
+    TablesWithCoeffs loaded;
+    ASSERT_EQ(AeroTablesCache::load(path, SOURCE_CHECKSUM, loaded), 0);
+    ASSERT_EQ(loaded.CS_beta, expected.CS_beta);
+    ASSERT_EQ(loaded.AoS, expected.AoS);
+    ASSERT_EQ(loaded.CLPolynomial, expected.CLPolynomial);
+    ASSERT_EQ(loaded.prop, expected.prop);
+    ASSERT_EQ(loaded.actuatorTimeConstants, expected.actuatorTimeConstants);
+
+    // outdated source
+    ASSERT_EQ(AeroTablesCache::load(path, SOURCE_CHECKSUM + 1, loaded), -1);
+
+    // corrupted payload
+    std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(-1, std::ios::end);
+    file.put(0x55);
+    file.close();
+    ASSERT_EQ(AeroTablesCache::load(path, SOURCE_CHECKSUM, loaded), -1);
+    std::remove(path.c_str());
+}
+
+TEST(AeroTablesCache, keyedByLoadedTables){
+    const std::string configs = RosParamsSource().getConfigDirectory();
+    const std::string cachePath = testing::TempDir() + "aero_tables_cache_key_test.bin";
+    const std::string otherTablesPath = testing::TempDir() + "aero_tables_cache_key_test.yaml";
+    std::remove(cachePath.c_str());
+
+    YamlParamsSource packageParams;
+    ASSERT_EQ(packageParams.loadPackageConfigs(configs), 0);
+    packageParams.set("/uav/vtol_params/aeroTablesCachePath", cachePath);
+    InnoVtolDynamicsSim packageSim;
+    ASSERT_EQ(packageSim.init(packageParams), 0);
+
+    // another airframe yaml loaded into the same namespace must not reuse the cache
+    TablesWithCoeffs otherTables = packageSim.getTables();
+    otherTables.CLPolynomial(0, 0) += 1.0;
+    std::ofstream otherTablesFile(otherTablesPath);
+    forEachTable(otherTables, [&](const char* name, auto&){
+        printTable(otherTablesFile, otherTables, name);
+    });
+    otherTablesFile << "actuatorTimeConstants: [";
+    for(size_t idx = 0; idx < otherTables.actuatorTimeConstants.size(); idx++){
+        otherTablesFile << (idx ? ", " : "") << otherTables.actuatorTimeConstants[idx];
+    }
+    otherTablesFile << "]" << std::endl;
+    otherTablesFile.close();
+
+    YamlParamsSource otherParams;
+    ASSERT_EQ(otherParams.loadPackageConfigs(configs), 0);
+    ASSERT_EQ(otherParams.load(otherTablesPath, "/uav/aerodynamics_coeffs/"), 0);
+    otherParams.set("/uav/vtol_params/aeroTablesPath", otherTablesPath);
+    otherParams.set("/uav/vtol_params/aeroTablesCachePath", cachePath);
+    InnoVtolDynamicsSim otherSim;
+    ASSERT_EQ(otherSim.init(otherParams), 0);
+    ASSERT_NEAR(otherSim.getTables().CLPolynomial(0, 0), otherTables.CLPolynomial(0, 0), 1e-6);
+    ASSERT_NE(otherSim.getTables().CLPolynomial(0, 0), packageSim.getTables().CLPolynomial(0, 0));
+
+    std::remove(cachePath.c_str());
+    std::remove(otherTablesPath.c_str());
+}
+
+TEST(ParamsSource, yamlMatchesParameterServer){
+    InnoVtolDynamicsSim rosSim, yamlSim;
+    ASSERT_EQ(rosSim.init(RosParamsSource()), 0);
+
+    YamlParamsSource yamlParams;
+    ASSERT_EQ(yamlParams.loadPackageConfigs(RosParamsSource().getConfigDirectory()), 0);
+    ASSERT_EQ(yamlSim.init(yamlParams), 0);
+    double mass;
+    ASSERT_TRUE(yamlParams.get("/uav/vtol_params/mass", mass));
+    ASSERT_FALSE(yamlParams.get("/uav/vtol_params/notExistedParameter", mass));
+
+    const TablesWithCoeffs& expected = rosSim.getTables();
+    const TablesWithCoeffs& actual = yamlSim.getTables();
+    ASSERT_EQ(actual.CS_rudder, expected.CS_rudder);
+    ASSERT_EQ(actual.CLPolynomial, expected.CLPolynomial);
+    ASSERT_EQ(actual.prop, expected.prop);
+    ASSERT_EQ(actual.actuatorTimeConstants, expected.actuatorTimeConstants);
+
+    std::vector<double> actuators{700, 700, 700, 700, 0, 0, 0, 0};
+    for(auto sim : {&rosSim, &yamlSim}){
+        sim->setInitialPosition(Eigen::Vector3d(0, 0, -10), Eigen::Quaterniond::Identity());
+        sim->setTurbulenceParameter(0);
+    }
+    for(size_t idx = 0; idx < 100; idx++){
+        rosSim.process(0.002, actuators, false);
+        yamlSim.process(0.002, actuators, false);
+    }
+    ASSERT_TRUE(yamlSim.getVehiclePosition().isApprox(rosSim.getVehiclePosition()));
+    ASSERT_TRUE(yamlSim.getVehicleVelocity().isApprox(rosSim.getVehicleVelocity()));
+}
+
+TEST(UavDynamicsSimBase, stepNMatchesProcess){
+    InnoVtolDynamicsSim loopSim, batchSim;
+    ASSERT_EQ(loopSim.init(RosParamsSource()), 0);
+    ASSERT_EQ(batchSim.init(RosParamsSource()), 0);
+    for(auto sim : {&loopSim, &batchSim}){
+        sim->setInitialPosition(Eigen::Vector3d(0, 0, -10), Eigen::Quaterniond::Identity());
+        sim->setTurbulenceParameter(0);
+    }
+
+    const size_t STEPS_AMOUNT = 200;
+    const size_t ACTUATORS_AMOUNT = 8;
+    const double DT = 0.002;
+    std::vector<double> commands(STEPS_AMOUNT * ACTUATORS_AMOUNT);
+    for(size_t step = 0; step < STEPS_AMOUNT; step++){
+        for(size_t idx = 0; idx < 4; idx++){
+            commands[step * ACTUATORS_AMOUNT + idx] = 600 + step + 10 * idx;
+        }
+    }
+    std::vector<double> states(STEPS_AMOUNT * UavDynamicsSimBase::STATE_SIZE);
+    batchSim.stepN(DT, commands.data(), ACTUATORS_AMOUNT, STEPS_AMOUNT, states.data(), false);
+
+    std::vector<double> expected(UavDynamicsSimBase::STATE_SIZE);
+    for(size_t step = 0; step < STEPS_AMOUNT; step++){
+        std::vector<double> command(commands.begin() + step * ACTUATORS_AMOUNT,
+                                    commands.begin() + (step + 1) * ACTUATORS_AMOUNT);
+        loopSim.process(DT, command, false);
+        loopSim.getStateVector(expected.data());
+        for(size_t idx = 0; idx < UavDynamicsSimBase::STATE_SIZE; idx++){
+            ASSERT_DOUBLE_EQ(states[step * UavDynamicsSimBase::STATE_SIZE + idx], expected[idx]);
+        }
+    }
+    ASSERT_DOUBLE_EQ(states[(STEPS_AMOUNT - 1) * UavDynamicsSimBase::STATE_SIZE + 2],
+                     loopSim.getVehiclePosition()[2]);
+}
+
+TEST(VtolVectorEnv, stepMatchesSingleSim){
+    const size_t ENVS_AMOUNT = 5;
+    const size_t STEPS_AMOUNT = 50;
+    const double DT = 0.01;
+    const size_t SUBSTEPS_AMOUNT = 5;
+    VtolVectorEnv env;
+    ASSERT_EQ(env.init(RosParamsSource(), ENVS_AMOUNT, DT, SUBSTEPS_AMOUNT, 2), 0);
+    State snapshot = env.getSnapshot();
+    snapshot.position << 0, 0, -20;
+    env.setSnapshot(snapshot);
+    env.resetAll();
+
+    InnoVtolDynamicsSim sim;
+    ASSERT_EQ(sim.init(RosParamsSource()), 0);
+    sim.setState(snapshot);
+
+    std::vector<double> actions(ENVS_AMOUNT * VtolVectorEnv::ACTIONS_SIZE, 0);
+    std::vector<double> observations(ENVS_AMOUNT * VtolVectorEnv::OBSERVATIONS_SIZE);
+    std::vector<double> expected(VtolVectorEnv::OBSERVATIONS_SIZE);
+    const size_t CHECKED_ENV = 3;
+    for(size_t step = 0; step < STEPS_AMOUNT; step++){
+        for(size_t envIdx = 0; envIdx < ENVS_AMOUNT; envIdx++){
+            for(size_t idx = 0; idx < 4; idx++){
+                actions[envIdx * VtolVectorEnv::ACTIONS_SIZE + idx] = 500 + 20 * envIdx + step;
+            }
+        }
+        env.step(actions.data(), observations.data());
+
+        std::vector<double> command(actions.begin() + CHECKED_ENV * VtolVectorEnv::ACTIONS_SIZE,
+                                    actions.begin() + (CHECKED_ENV + 1) * VtolVectorEnv::ACTIONS_SIZE);
+        for(size_t substep = 0; substep < SUBSTEPS_AMOUNT; substep++){
+            sim.process(DT / SUBSTEPS_AMOUNT, command, false);
+        }
+        sim.getStateVector(expected.data());
+        for(size_t idx = 0; idx < VtolVectorEnv::OBSERVATIONS_SIZE; idx++){
+            ASSERT_DOUBLE_EQ(observations[CHECKED_ENV * VtolVectorEnv::OBSERVATIONS_SIZE + idx], expected[idx]);
+        }
+    }
+
+    // envs with different actions diverge, reset returns to the snapshot
+    ASSERT_NE(observations[2], observations[VtolVectorEnv::OBSERVATIONS_SIZE + 2]);
+    env.reset(1);
+    ASSERT_DOUBLE_EQ(env.getEnv(1).getVehiclePosition()[2], -20);
+}
+
+TEST(VtolVectorEnv, resetReseedsEachEpisode){
+    VtolVectorEnv env;
+    ASSERT_EQ(env.init(RosParamsSource(), 3, 0.01, 2, 1), 0);
+    State snapshot = env.getSnapshot();
+    snapshot.windFieldTime = 5.0;
+    env.setSnapshot(snapshot);
+    env.resetAll();
+
+    auto generatorOf = [&env](size_t envIdx){
+        return env.getEnv(envIdx).getState().turbulenceState.generator;
+    };
+    ASSERT_NE(generatorOf(0), generatorOf(1));
+    ASSERT_NE(generatorOf(1), generatorOf(2));
+
+    // the clock is advanced only by a loaded wind field, so move it by hand
+    auto firstEpisode = generatorOf(0);
+    State finished = env.getEnv(0).getState();
+    finished.windFieldTime = 42.0;
+    env.getEnv(0).setState(finished);
+
+    env.reset(0);
+    ASSERT_NE(generatorOf(0), firstEpisode);
+    ASSERT_DOUBLE_EQ(env.getEnv(0).getState().windFieldTime, 5.0);
+}
+
+TEST(VectorEnvRing, serveRequests){
+    const size_t ENVS_AMOUNT = 3;
+    const uint32_t TIMEOUT_MS = 5000;
+    VtolVectorEnv env;
+    ASSERT_EQ(env.init(RosParamsSource(), ENVS_AMOUNT, 0.01, 2, 2), 0);
+
+    std::string name = "/vtol_vector_env_test_" + std::to_string(getpid());
+    VectorEnvRing serverRing, clientRing;
+    ASSERT_EQ(serverRing.create(name, 2, ENVS_AMOUNT, VtolVectorEnv::ACTIONS_SIZE, VtolVectorEnv::OBSERVATIONS_SIZE), 0);
+    ASSERT_EQ(clientRing.open(name), 0);
+    ASSERT_EQ(clientRing.getEnvsAmount(), ENVS_AMOUNT);
+
+    std::atomic<bool> isRunning{true};
+    std::thread server([&]{env.serve(serverRing, isRunning);});
+
+    std::vector<double> heights(ENVS_AMOUNT);
+    for(uint64_t request = 0; request < 5; request++){
+        ASSERT_TRUE(clientRing.waitFreeSlot(request, TIMEOUT_MS));
+        double* actions = clientRing.getActions(request);
+        uint8_t* resetFlags = clientRing.getResetFlags(request);
+        for(size_t idx = 0; idx < ENVS_AMOUNT * VtolVectorEnv::ACTIONS_SIZE; idx++){
+            actions[idx] = 0;
+        }
+        for(size_t envIdx = 0; envIdx < ENVS_AMOUNT; envIdx++){
+            resetFlags[envIdx] = request == 0;
+        }
+        clientRing.publishRequest();
+        ASSERT_TRUE(clientRing.waitResponse(request, TIMEOUT_MS));
+        const double* observations = clientRing.getObservations(request);
+        for(size_t envIdx = 0; envIdx < ENVS_AMOUNT; envIdx++){
+            heights[envIdx] = observations[envIdx * VtolVectorEnv::OBSERVATIONS_SIZE + 2];
+            ASSERT_DOUBLE_EQ(heights[envIdx], env.getEnv(envIdx).getVehiclePosition()[2]);
+        }
+    }
+    ASSERT_EQ(clientRing.getRequestsAmount(), 5);
+
+    isRunning = false;
+    server.join();
+    clientRing.close();
+    serverRing.close();
+    ASSERT_EQ(clientRing.open(name), -1);
+}
+
+TEST(SharedStateExport, readersSeeOnlyConsistentStates){
+    std::string name = "/inno_vtol_state_test_" + std::to_string(getpid());
+    SharedStateWriter writer;
+    SharedStateReader reader;
+    SharedVehicleState state{};
+    ASSERT_EQ(reader.open(name), -1);
+    ASSERT_EQ(writer.create(name), 0);
+    ASSERT_EQ(reader.open(name), 0);
+    ASSERT_FALSE(reader.read(state));
+
+    // each written state has all fields equal to its index, so a torn read is visible
+    const uint64_t WRITES_AMOUNT = 200000;
+    auto fill = [](SharedVehicleState& state, uint64_t value){
+        for(double* field = state.position; field < state.motorsRpm + SharedVehicleState::MAX_MOTORS; field++){
+            *field = value;
+        }
+        state.timeNsec = value;
+    };
+    std::thread writerThread([&]{
+        SharedVehicleState written{};
+        for(uint64_t idx = 1; idx <= WRITES_AMOUNT; idx++){
+            fill(written, idx);
+            writer.write(written);
+        }
+    });
+
+    uint64_t lastTimeNsec = 0;
+    while(lastTimeNsec < WRITES_AMOUNT){
+        if(!reader.read(state)){
+            continue;
+        }
+        ASSERT_GE(state.timeNsec, lastTimeNsec);
+        ASSERT_EQ(state.position[0], state.timeNsec);
+        ASSERT_EQ(state.attitude[3], state.timeNsec);
+        ASSERT_EQ(state.Mtotal[2], state.timeNsec);
+        ASSERT_EQ(state.motorsRpm[SharedVehicleState::MAX_MOTORS - 1], state.timeNsec);
+        lastTimeNsec = state.timeNsec;
+    }
+    writerThread.join();
+    ASSERT_EQ(reader.getSequence(), 2 * WRITES_AMOUNT);
+
+    reader.close();
+    writer.close();
+    ASSERT_EQ(reader.open(name), -1);
+}
+
+template<class Sim>
+static void initQuadcopter(Sim& sim){
+    sim.setMotorProperties(1.91e-6, 2.6e-7, 0.02, 0.0, 2200.0, 6.62e-6);
+    sim.setVehicleProperties(1.0, Eigen::Vector3d(0.0049, 0.0049, 0.0069).asDiagonal(),
+                             Eigen::Matrix3d::Identity() * 0.003, 0.1, 0.0, 0.0);
+    sim.setGravityVector(Eigen::Vector3d(0, 0, -9.81));
+    const double ARM = 0.08;
+    const double SIGNS[4][3] = {{1, 1, 1}, {-1, 1, -1}, {-1, -1, 1}, {1, -1, -1}};
+    for(int idx = 0; idx < 4; idx++){
+        Eigen::Isometry3d motorFrame = Eigen::Isometry3d::Identity();
+        motorFrame.translation() = Eigen::Vector3d(SIGNS[idx][0] * ARM, SIGNS[idx][1] * ARM, 0);
+        sim.setMotorFrame(motorFrame, SIGNS[idx][2], idx);
+    }
+    sim.setVehiclePosition(Eigen::Vector3d(0, 0, 50), Eigen::Quaterniond::Identity());
+}
+
+TEST(MulticopterDynamics, fixedMatchesDynamic){
+    MulticopterDynamics<4> fixedSim;
+    MulticopterDynamicsSim dynamicSim(4);
+    initQuadcopter(fixedSim);
+    initQuadcopter(dynamicSim);
+
+    std::vector<double> command(4);
+    for(size_t step = 0; step < 500; step++){
+        for(size_t idx = 0; idx < 4; idx++){
+            command[idx] = 0.6 + 0.1 * std::sin(0.01 * step * (idx + 1));
+        }
+        if(step % 2){
+            fixedSim.proceedState_RK4(0.002, Eigen::Map<const Eigen::Array4d>(command.data()), true);
+            dynamicSim.proceedState_RK4(0.002, command, true);
+        }else{
+            fixedSim.proceedState_ExplicitEuler(0.002, Eigen::Map<const Eigen::Array4d>(command.data()), true);
+            dynamicSim.proceedState_ExplicitEuler(0.002, command, true);
+        }
+    }
+
+    std::vector<double> motorSpeed;
+    Eigen::Vector3d position, velocity, angularVelocity;
+    Eigen::Quaterniond attitude;
+    dynamicSim.getVehicleState(position, velocity, angularVelocity, attitude, motorSpeed);
+    ASSERT_EQ(motorSpeed.size(), 4);
+    EXPECT_GT(angularVelocity.norm(), 1e-3);
+    EXPECT_NEAR((fixedSim.getVehiclePosition() - position).norm(), 0, 1e-9);
+    EXPECT_NEAR((fixedSim.getVehicleVelocity() - velocity).norm(), 0, 1e-9);
+    EXPECT_NEAR((fixedSim.getVehicleAngularVelocity() - angularVelocity).norm(), 0, 1e-9);
+    EXPECT_NEAR(fixedSim.getVehicleAttitude().angularDistance(attitude), 0, 1e-9);
+    for(size_t idx = 0; idx < 4; idx++){
+        EXPECT_NEAR(fixedSim.getMotorSpeed()[idx], motorSpeed[idx], 1e-6);
+    }
+}
+
+TEST(MulticopterDynamics, rk4MotorsSpinUpAndFreeFall){
+    MulticopterDynamics<4> sim;
+    initQuadcopter(sim);
+    sim.setVehicleProperties(1.0, Eigen::Matrix3d::Identity() * 0.005, Eigen::Matrix3d::Zero(), 0.0, 0.0, 0.0);
+    sim.setMotorProperties(0.0, 0.0, 0.02, 0.0, 2200.0, 0.0);
+
+    const double DT = 0.001;
+    const double COMMAND = 1000;
+    for(size_t step = 1; step <= 1000; step++){
+        sim.proceedState_RK4(DT, Eigen::Array4d::Constant(COMMAND));
+        if(step % 100 == 0){
+            double expectedSpeed = COMMAND * (1 - std::exp(-(step * DT) / 0.02));
+            EXPECT_NEAR(sim.getMotorSpeed()[0], expectedSpeed, 1e-6 * COMMAND);
+        }
+    }
+    EXPECT_NEAR(sim.getVehicleVelocity()[2], -9.81, 1e-9);
+    EXPECT_NEAR(sim.getVehiclePosition()[2], 50 - 0.5 * 9.81, 1e-9);
+    EXPECT_NEAR(sim.getVehicleAngularVelocity().norm(), 0, 1e-12);
+}
+
+TEST(MulticopterDynamics, rk4StaysOnGround){
+    MulticopterDynamics<4> sim;
+    initQuadcopter(sim);
+    sim.setVehiclePosition(Eigen::Vector3d::Zero(), Eigen::Quaterniond::Identity());
+
+    for(size_t step = 0; step < 100; step++){
+        sim.proceedState_RK4(0.01, Eigen::Array4d::Zero(), true);
+        ASSERT_GE(sim.getVehiclePosition()[2], 0.0);
+    }
+    EXPECT_EQ(sim.getVehicleVelocity().norm(), 0.0);
+    EXPECT_EQ(sim.getVehicleAngularVelocity().norm(), 0.0);
+}
+
+TEST(FlightgogglesDynamics, rk4SubstepsMatchFineEuler){
+    FlightgogglesDynamics coarseSim, fineSim;
+    ASSERT_EQ(coarseSim.init(RosParamsSource()), 0);
+    ASSERT_EQ(fineSim.init(RosParamsSource()), 0);
+    ASSERT_EQ(coarseSim.getIntegrationMethod(), FlightgogglesDynamics::INTEGRATION_EULER);
+    ASSERT_EQ(coarseSim.getSubstepsAmount(), 1);
+    coarseSim.setIntegrationPolicy(FlightgogglesDynamics::INTEGRATION_RK4, 10);
+    fineSim.setIntegrationPolicy(FlightgogglesDynamics::INTEGRATION_EULER, 40);
+    for(auto sim : {&coarseSim, &fineSim}){
+        sim->setInitialPosition(Eigen::Vector3d(0, 0, 10), Eigen::Quaterniond::Identity());
+    }
+
+    const double OUTER_DT = 0.02;
+    const std::vector<double> command{0.7, 0.7, 0.7, 0.7};
+    for(size_t step = 0; step < 50; step++){
+        coarseSim.process(OUTER_DT, command, true);
+        fineSim.process(OUTER_DT, command, true);
+    }
+    EXPECT_GT(fineSim.getVehicleVelocity()[2], 1.0);
+    EXPECT_NEAR(coarseSim.getVehicleVelocity()[2], fineSim.getVehicleVelocity()[2], 0.1);
+    EXPECT_NEAR(coarseSim.getVehiclePosition()[2], fineSim.getVehiclePosition()[2], 0.1);
+}
+
+TEST(InnoVtolDynamicsSim, multiRateMatchesSingleRate){
+    InnoVtolDynamicsSim singleRateSim, multiRateSim;
+    ASSERT_EQ(singleRateSim.init(RosParamsSource()), 0);
+    ASSERT_EQ(multiRateSim.init(RosParamsSource()), 0);
+    VtolParameters params = multiRateSim.getParams();
+    params.innerSubsteps = 4;
+    params.aeroUpdatePeriod = 0.01;
+    params.aeroForcesPolicy = AERO_FORCES_EXTRAPOLATE;
+    ASSERT_EQ(multiRateSim.init(params, multiRateSim.getTables()), 0);
+    for(auto sim : {&singleRateSim, &multiRateSim}){
+        sim->setInitialPosition(Eigen::Vector3d(0, 0, -100), Eigen::Quaterniond::Identity());
+        sim->setInitialVelocity(Eigen::Vector3d(20, 0, 0), Eigen::Vector3d::Zero());
+        sim->setTurbulenceParameter(0);
+        sim->setWindParameter(Eigen::Vector3d::Zero(), 0);
+    }
+
+    const size_t OUTER_STEPS = 200;
+    const double OUTER_DT = 0.004;
+    const std::vector<double> command{0, 0, 0, 0, 500, 2, -3, 1};
+    for(size_t step = 0; step < OUTER_STEPS; step++){
+        for(size_t substep = 0; substep < 4; substep++){
+            singleRateSim.process(OUTER_DT / 4, command, false);
+        }
+        multiRateSim.process(OUTER_DT, command, false);
+    }
+
+    EXPECT_EQ(singleRateSim.getAeroEvaluationsAmount(), 4 * OUTER_STEPS);
+    EXPECT_NEAR(multiRateSim.getAeroEvaluationsAmount(), OUTER_STEPS * OUTER_DT / 0.01, 1);
+    EXPECT_GT(singleRateSim.getFaero().norm(), 1.0);
+    EXPECT_LT((singleRateSim.getVehiclePosition() - multiRateSim.getVehiclePosition()).norm(), 0.05);
+    EXPECT_LT((singleRateSim.getVehicleVelocity() - multiRateSim.getVehicleVelocity()).norm(), 0.05);
+    EXPECT_LT((singleRateSim.getVehicleAttitude().coeffs() - multiRateSim.getVehicleAttitude().coeffs()).norm(), 0.01);
+}
+
+TEST(AttitudeIntegration, exactForConstantRate){
+    const Eigen::Vector3d angularVel(3.0, -8.0, 5.0);
+    const double DT = 0.05;
+    Eigen::Quaterniond attitude(Eigen::AngleAxisd(0.3, Eigen::Vector3d::UnitX()));
+    Eigen::Quaterniond expected = attitude * Eigen::AngleAxisd(angularVel.norm() * 20 * DT, angularVel.normalized());
+    for(size_t step = 0; step < 20; step++){
+        AttitudeIntegration::integrateAttitude(attitude, angularVel, DT);
+    }
+    EXPECT_NEAR(attitude.angularDistance(expected), 0.0, 1e-9);
+    EXPECT_NEAR(AttitudeIntegration::expMap(Eigen::Vector3d(1e-9, 0, 0)).x(), 0.5e-9, 1e-20);
+}
+
+TEST(AttitudeIntegration, crouchGrossmanTorqueFreeTop){
+    const Eigen::Matrix3d inertia = Eigen::Vector3d(0.6, 0.65, 1.25).asDiagonal();
+    const Eigen::Matrix3d inertiaInverse = inertia.inverse();
+    const Eigen::Vector3d initialAngularVel(0.5, 4.0, 0.3);
+    const double DURATION = 2.0;
+    auto integrate = [&](double dt, bool isCrouchGrossman, Eigen::Quaterniond& attitude,
+                         Eigen::Vector3d& angularVel){
+        attitude.setIdentity();
+        angularVel = initialAngularVel;
+        for(size_t step = 0; step < static_cast<size_t>(std::round(DURATION / dt)); step++){
+            if(isCrouchGrossman){
+                AttitudeIntegration::integrateRigidBody(attitude, angularVel, inertia, inertiaInverse,
+                                                        Eigen::Vector3d::Zero(), dt);
+            }else{
+                angularVel += inertiaInverse * (-angularVel.cross(inertia * angularVel)) * dt;
+                AttitudeIntegration::integrateAttitude(attitude, angularVel, dt);
+            }
+        }
+    };
+
+    Eigen::Quaterniond reference, coarse, fine, euler;
+    Eigen::Vector3d referenceVel, coarseVel, fineVel, eulerVel;
+    integrate(0.0001, true, reference, referenceVel);
+    integrate(0.02, true, coarse, coarseVel);
+    integrate(0.01, true, fine, fineVel);
+    integrate(0.01, false, euler, eulerVel);
+
+    double coarseError = reference.angularDistance(coarse);
+    double fineError = reference.angularDistance(fine);
+    EXPECT_LT(fineError, 1e-6);
+    EXPECT_GT(coarseError / fineError, 6.0);
+    EXPECT_LT(100 * fineError, reference.angularDistance(euler));
+    EXPECT_NEAR(coarseVel.dot(inertia * coarseVel), initialAngularVel.dot(inertia * initialAngularVel), 1e-3);
+}
+
+TEST(VtolDynamicsKernel, floatAccuracyEnvelope){
+    VtolParameters params;
+    TablesWithCoeffs tables;
+    InnoVtolDynamicsSim::loadParams(RosParamsSource(), "/uav/vtol_params/", params);
+    InnoVtolDynamicsSim::loadTables(RosParamsSource(), "/uav/aerodynamics_coeffs/", tables);
+    VtolDynamicsKernel<double> doubleKernel;
+    VtolDynamicsKernel<float> floatKernel;
+    doubleKernel.init(params, tables);
+    floatKernel.init(params, tables);
+    EXPECT_LT(sizeof(TablesWithCoeffsT<float>), 0.6 * sizeof(TablesWithCoeffs));
+
+    VtolDynamicsKernel<double>::RigidBodyState doubleState;
+    VtolDynamicsKernel<float>::RigidBodyState floatState;
+    doubleState.position << 0, 0, -100;
+    doubleState.linearVel << 20, 0, 0;
+    floatState.position = doubleState.position.cast<float>();
+    floatState.linearVel = doubleState.linearVel.cast<float>();
+    VtolDynamicsKernel<double>::Actuators actuators;
+    actuators << 0, 0, 0, 0, 600, 2, -3, 1;
+
+    const double DT = 0.001;
+    for(size_t step = 0; step < 2000; step++){
+        doubleKernel.step(doubleState, actuators, DT);
+        floatKernel.step(floatState, actuators.cast<float>(), DT);
+    }
+    EXPECT_GT(doubleState.angularVel.norm(), 0.1);
+    EXPECT_LT((doubleState.position - floatState.position.cast<double>()).norm(), 0.001);
+    EXPECT_LT((doubleState.linearVel - floatState.linearVel.cast<double>()).norm(), 0.001);
+    EXPECT_LT(doubleState.attitude.angularDistance(floatState.attitude.cast<double>()), 1e-4);
+}
+
+TEST(VtolLinearization, jacobiansMatchFiniteDifferences){
+    VtolParameters params;
+    TablesWithCoeffs tables;
+    InnoVtolDynamicsSim::loadParams(RosParamsSource(), "/uav/vtol_params/", params);
+    InnoVtolDynamicsSim::loadTables(RosParamsSource(), "/uav/aerodynamics_coeffs/", tables);
+    VtolLinearization linearization;
+    linearization.init(params, tables);
+    VtolDynamicsKernel<double> kernel;
+    kernel.init(params, tables);
+
+    VtolLinearization::RigidBodyState state;
+    state.position << 10, -5, -100;
+    state.linearVel << 17.3, 1.7, -0.9;
+    state.attitude = Eigen::AngleAxisd(0.13, Eigen::Vector3d(0.2, 0.9, 0.3).normalized());
+    state.angularVel << 0.31, -0.22, 0.17;
+    VtolLinearization::Actuators actuators;
+    actuators << 301, 279, 313, 288, 455, 2.3, -3.1, 1.3;
+
+    LinearModel model;
+    linearization.linearize(state, actuators, model);
+
+    auto derivative = [&](const VtolLinearization::RigidBodyState& x, const VtolLinearization::Actuators& u,
+                          const Eigen::Vector3d& attitudeError){
+        Eigen::Matrix<double, 12, 1> xDot;
+        Eigen::Vector3d linearAccel, angularAccel;
+        kernel.calculateDerivative(x, u, linearAccel, angularAccel);
+        xDot << x.linearVel, linearAccel, x.angularVel + 0.5 * attitudeError.cross(x.angularVel), angularAccel;
+        return xDot;
+    };
+    EXPECT_LT((model.stateDerivative - derivative(state, actuators, Eigen::Vector3d::Zero())).norm(), 1e-9);
+
+    const double EPS = 1e-6;
+    for(size_t col = 0; col < 20; col++){
+        Eigen::Matrix<double, 12, 1> xDot[2];
+        for(size_t side = 0; side < 2; side++){
+            double delta = (side == 0) ? EPS : -EPS;
+            auto x = state;
+            auto u = actuators;
+            Eigen::Vector3d attitudeError = Eigen::Vector3d::Zero();
+            if(col < 3){
+                x.position[col] += delta;
+            }else if(col < 6){
+                x.linearVel[col - 3] += delta;
+            }else if(col < 9){
+                attitudeError[col - 6] = delta;
+                x.attitude = state.attitude * AttitudeIntegration::expMap<double>(attitudeError);
+            }else if(col < 12){
+                x.angularVel[col - 9] += delta;
+            }else{
+                u[col - 12] += delta;
+            }
+            xDot[side] = derivative(x, u, attitudeError);
+        }
+        Eigen::Matrix<double, 12, 1> numerical = (xDot[0] - xDot[1]) / (2 * EPS);
+        Eigen::Matrix<double, 12, 1> analytical;
+        if(col < 12){
+            analytical = model.A.col(col);
+        }else{
+            analytical = model.B.col(col - 12);
+        }
+        EXPECT_LT((numerical - analytical).norm(), 1e-5 * std::max(1.0, analytical.norm())) << col;
+    }
+}
+
+TEST(VtolLinearization, trimSweep){
+    VtolParameters params;
+    TablesWithCoeffs tables;
+    InnoVtolDynamicsSim::loadParams(RosParamsSource(), "/uav/vtol_params/", params);
+    InnoVtolDynamicsSim::loadTables(RosParamsSource(), "/uav/aerodynamics_coeffs/", tables);
+
+    std::vector<double> airspeeds = {0, 10, 22};
+    std::vector<double> altitudes = {0, 2000};
+    std::vector<TrimPoint, Eigen::aligned_allocator<TrimPoint>> points;
+    EXPECT_EQ(sweepTrimPoints(params, tables, airspeeds, altitudes, points, 4), 0);
+    ASSERT_EQ(points.size(), 6);
+
+    for(const auto& point : points){
+        EXPECT_TRUE(point.isConverged);
+        EXPECT_LT(point.residual, VtolLinearization::TOLERANCE);
+        EXPECT_LT(point.model.stateDerivative.segment<3>(3).norm(), VtolLinearization::TOLERANCE);
+    }
+    EXPECT_EQ(points[0].mode, TRIM_HOVER);
+    EXPECT_EQ(points[1].mode, TRIM_TRANSITION);
+    EXPECT_EQ(points[2].mode, TRIM_CRUISE);
+    EXPECT_EQ(points[2].actuators.head<4>().abs().maxCoeff(), 0);
+    EXPECT_LT(points[0].actuators.head<4>().maxCoeff() - points[0].actuators.head<4>().minCoeff(), 1e-6);
+
+    // the thinner air needs a higher angle of attack and a stronger pusher
+    auto pitch = [](const Eigen::Quaterniond& q){return std::asin(-q.toRotationMatrix()(2, 0));};
+    EXPECT_GT(pitch(points[5].attitude), pitch(points[2].attitude));
+    EXPECT_GT(points[5].actuators[4], points[2].actuators[4]);
+}
+
+static std::string readTextFile(const std::string& path){
+    std::ifstream file(path);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+static void writeTextFile(const std::string& path, const std::string& content){
+    std::ofstream file(path);
+    file << content;
+}
+
+TEST(VtolModelReloader, rejectsInvalidAndSwapsAtStepBoundary){
+    const std::string packageConfigs = RosParamsSource().getConfigDirectory();
+    const std::string configs = testing::TempDir();
+    std::string vtolParams = readTextFile(packageConfigs + "/vtol_params.yaml");
+    std::string tables = readTextFile(packageConfigs + "/aerodynamics_coeffs.yaml");
+    writeTextFile(configs + "/aerodynamics_coeffs.yaml", tables);
+
+    InnoVtolDynamicsSim sim;
+    ASSERT_EQ(sim.init(RosParamsSource()), 0);
+    VtolModelReloader reloader;
+    sim.setModelReloader(&reloader);
+    std::vector<double> cmd(8, 0.0);
+
+    // the model is taken only on the next step
+    size_t massPos = vtolParams.find("mass:");
+    ASSERT_NE(massPos, std::string::npos);
+    std::string heavierParams = vtolParams;
+    heavierParams.replace(massPos, vtolParams.find('#', massPos) - massPos, "mass: 9.0 ");
+    writeTextFile(configs + "/vtol_params.yaml", heavierParams);
+    ASSERT_EQ(reloader.reload(configs), 0);
+    EXPECT_EQ(sim.getParams().mass, 7.0);
+    const uint32_t turbulenceSeed = sim.getParams().turbulenceSeed;
+    sim.process(0.001, cmd, true);
+    EXPECT_EQ(sim.getParams().mass, 9.0);
+    EXPECT_EQ(sim.getModelReloadsAmount(), 1);
+    EXPECT_EQ(sim.getParams().turbulenceSeed, turbulenceSeed);
+    sim.process(0.001, cmd, true);
+    EXPECT_EQ(sim.getModelReloadsAmount(), 1);
+
+    // a broken model is rejected and the current one is kept
+    std::string brokenParams = vtolParams;
+    brokenParams.replace(massPos, vtolParams.find('#', massPos) - massPos, "mass: -1.0 ");
+    writeTextFile(configs + "/vtol_params.yaml", brokenParams);
+    EXPECT_EQ(reloader.reload(configs), -1);
+    sim.process(0.001, cmd, true);
+    EXPECT_EQ(sim.getParams().mass, 9.0);
+    EXPECT_EQ(reloader.getRejectedAmount(), 1);
+
+    TablesWithCoeffs unsorted = sim.getTables();
+    unsorted.prop(3, 0) = unsorted.prop(1, 0);
+    EXPECT_EQ(VtolModelReloader::validate(sim.getParams(), unsorted), -1);
+    TablesWithCoeffs notFinite = sim.getTables();
+    notFinite.CmyElevator(2, 2) = std::numeric_limits<double>::quiet_NaN();
+    EXPECT_EQ(VtolModelReloader::validate(sim.getParams(), notFinite), -1);
+    EXPECT_EQ(VtolModelReloader::validate(sim.getParams(), sim.getTables()), 0);
+
+    // the watcher notices the changed file
+    writeTextFile(configs + "/vtol_params.yaml", vtolParams);
+    ASSERT_EQ(reloader.start(configs, 0.005), 0);
+    writeTextFile(configs + "/vtol_params.yaml", heavierParams);
+    for(size_t idx = 0; idx < 400 && sim.getModelReloadsAmount() < 2; idx++){
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        sim.process(0.001, cmd, true);
+    }
+    reloader.stop();
+    EXPECT_EQ(sim.getModelReloadsAmount(), 2);
+    EXPECT_EQ(sim.getParams().mass, 9.0);
+
+    std::remove((configs + "/vtol_params.yaml").c_str());
+    std::remove((configs + "/aerodynamics_coeffs.yaml").c_str());
+}
+
+TEST(AirframeRegistry, sharesTablesInProcessAndAcrossProcesses){
+    TablesWithCoeffs expected;
+    InnoVtolDynamicsSim::loadTables(RosParamsSource(), "/uav/aerodynamics_coeffs/", expected);
+    VtolParameters params{};
+    InnoVtolDynamicsSim::loadParams(RosParamsSource(), "/uav/vtol_params/", params);
+    size_t loadsAmount = 0;
+    auto loader = [&expected, &loadsAmount](TablesWithCoeffs& tables){
+        tables = expected;
+        loadsAmount++;
+    };
+
+    // in-process: a single load for all the simulators, it is released with the last of them
+    AirframeRegistry registry;
+    {
+        InnoVtolDynamicsSim first, second;
+        ASSERT_EQ(first.init(params, registry.get("inno_vtol", loader)), 0);
+        ASSERT_EQ(second.init(params, registry.get("inno_vtol", loader)), 0);
+        EXPECT_EQ(&first.getTables(), &second.getTables());
+        EXPECT_EQ(first.getSharedTables().use_count(), 2);
+        EXPECT_EQ(loadsAmount, 1);
+    }
+    registry.get("inno_vtol", loader);
+    EXPECT_EQ(loadsAmount, 2);
+
+    // cross-process: another registry maps the object as another process does
+    const std::string name = "/inno_vtol_airframe_test_" + std::to_string(getpid());
+    AirframeRegistry::unlinkShared(name);
+    AirframeRegistry otherRegistry;
+    auto published = registry.getShared(name, loader);
+    auto attached = otherRegistry.getShared(name, [](TablesWithCoeffs&){
+        FAIL() << "the published tables must be attached without loading";
+    });
+    ASSERT_NE(published, nullptr);
+    ASSERT_NE(attached, nullptr);
+    EXPECT_NE(published.get(), attached.get());
+    EXPECT_EQ(loadsAmount, 3);
+    EXPECT_EQ(otherRegistry.getLoadsAmount(), 0);
+    EXPECT_TRUE(attached->CS_beta == expected.CS_beta);
+    EXPECT_TRUE(attached->prop == expected.prop);
+    EXPECT_EQ(attached->actuatorTimeConstants, expected.actuatorTimeConstants);
+
+    VtolDynamicsKernel<double> sharedKernel, ownKernel;
+    sharedKernel.init(params, attached);
+    ownKernel.init(params, expected);
+    Eigen::Vector3d airspeed(15, 1, 2), sharedForce, sharedMoment, ownForce, ownMoment;
+    sharedKernel.calculateAerodynamics(airspeed, 0.1, -0.05, 3, 4, 5, sharedForce, sharedMoment);
+    ownKernel.calculateAerodynamics(airspeed, 0.1, -0.05, 3, 4, 5, ownForce, ownMoment);
+    EXPECT_TRUE(sharedForce == ownForce);
+    EXPECT_TRUE(sharedMoment == ownMoment);
+    EXPECT_EQ(AirframeRegistry::unlinkShared(name), 0);
+
+    // simulators initialized from the parameters attach by airframeName
+    YamlParamsSource source;
+    ASSERT_EQ(source.loadPackageConfigs(RosParamsSource().getConfigDirectory()), 0);
+    source.set("/uav/vtol_params/airframeName", std::string("inno_vtol_from_params"));
+    InnoVtolDynamicsSim first, second;
+    ASSERT_EQ(first.init(source), 0);
+    ASSERT_EQ(second.init(source), 0);
+    EXPECT_EQ(&first.getTables(), &second.getTables());
+}
+
+TEST(AirframeRegistry, recreatesStaleSharedTables){
+    TablesWithCoeffs expected;
+    InnoVtolDynamicsSim::loadTables(RosParamsSource(), "/uav/aerodynamics_coeffs/", expected);
+    TablesWithCoeffs modified = expected;
+    modified.prop(0, 1) += 1.0;
+    auto loader = [&expected](TablesWithCoeffs& tables){tables = expected;};
+    auto modifiedLoader = [&modified](TablesWithCoeffs& tables){tables = modified;};
+    const std::string name = "/inno_vtol_airframe_stale_test_" + std::to_string(getpid());
+    AirframeRegistry::unlinkShared(name);
+
+    // the creator died before it sized the object
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+    ASSERT_GE(fd, 0);
+    close(fd);
+    AirframeRegistry registry;
+    registry.setAttachTimeout(0.05);
+    auto published = registry.getShared(name, loader, 1);
+    ASSERT_NE(published, nullptr);
+    EXPECT_EQ(registry.getLoadsAmount(), 1);
+    EXPECT_TRUE(published->prop == expected.prop);
+
+    // another source yaml replaces the object, the old mapping stays valid
+    AirframeRegistry otherRegistry;
+    auto replaced = otherRegistry.getShared(name, modifiedLoader, 2);
+    ASSERT_NE(replaced, nullptr);
+    EXPECT_EQ(otherRegistry.getLoadsAmount(), 1);
+    EXPECT_TRUE(replaced->prop == modified.prop);
+    EXPECT_TRUE(published->prop == expected.prop);
+
+    // the same source and an unknown one attach without loading
+    AirframeRegistry sameRegistry;
+    auto attached = sameRegistry.getShared(name, loader, 2);
+    auto anySource = sameRegistry.getShared(name, loader);
+    ASSERT_NE(attached, nullptr);
+    EXPECT_EQ(sameRegistry.getLoadsAmount(), 0);
+    EXPECT_TRUE(attached->prop == modified.prop);
+    EXPECT_EQ(anySource, attached);
+    EXPECT_EQ(AirframeRegistry::unlinkShared(name), 0);
+}
+
+TEST(ActuatorsDynamics, stepResponseIsExactAndCached){
+    const double TAU = 0.05;
+    const double DT = 0.002;
+    ActuatorsDynamics first, second;
+    second.setModel(ActuatorsDynamics::SECOND_ORDER);
+    for(auto dynamics : {&first, &second}){
+        dynamics->setTimeConstants(ActuatorsArray::Constant(TAU));
+    }
+    ActuatorsState firstState, secondState;
+    const ActuatorsArray cmd = ActuatorsArray::Constant(10.0);
+
+    for(size_t step = 1; step <= 100; step++){
+        first.process(firstState, cmd, DT);
+        second.process(secondState, cmd, DT);
+        double t = step * DT;
+        EXPECT_NEAR(firstState.position[0], 10.0 * (1 - exp(-t / TAU)), 1e-9);
+        EXPECT_NEAR(secondState.position[7], 10.0 * (1 - exp(-t / TAU) * (1 + t / TAU)), 1e-9);
+        EXPECT_NEAR(secondState.rate[3], 10.0 * t / (TAU * TAU) * exp(-t / TAU), 1e-7);
+    }
+    EXPECT_EQ(first.getCoefficientsUpdatesAmount(), 1);
+    first.process(firstState, cmd, DT / 2);
+    EXPECT_EQ(first.getCoefficientsUpdatesAmount(), 2);
+
+    // a wall-clock dt jitters below the quantum and still hits the cache
+    for(size_t step = 0; step < 100; step++){
+        second.process(secondState, cmd, DT + 1e-7 * std::sin(step));
+    }
+    EXPECT_EQ(second.getCoefficientsUpdatesAmount(), 1);
+}
+
+TEST(ActuatorsDynamics, rateAndPositionLimits){
+    const double DT = 0.01;
+    ActuatorsDynamics dynamics;
+    dynamics.setModel(ActuatorsDynamics::SECOND_ORDER);
+    dynamics.setTimeConstants(ActuatorsArray::Constant(0.01));
+    dynamics.setLimits(ActuatorsArray::Constant(-20), ActuatorsArray::Constant(20),
+                       ActuatorsArray::Constant(100));
+    ActuatorsState state;
+
+    for(size_t step = 1; step <= 10; step++){
+        dynamics.process(state, ActuatorsArray::Constant(30.0), DT);
+        EXPECT_NEAR(state.position[0], std::min(100 * step * DT, 20.0), 1e-9);
+        EXPECT_LE(state.rate.abs().maxCoeff(), 100.0);
+    }
+    for(size_t step = 0; step < 100; step++){
+        dynamics.process(state, ActuatorsArray::Constant(30.0), DT);
+    }
+    EXPECT_EQ(state.position[5], 20.0);
+    EXPECT_EQ(state.rate[5], 0.0);
+}
+
 int main(int argc, char *argv[]){
     testing::InitGoogleTest(&argc, argv);
     ros::init(argc, argv, "tester");
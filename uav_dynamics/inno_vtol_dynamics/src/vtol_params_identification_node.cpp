@@ -0,0 +1,66 @@
+/**
+ * @file vtol_params_identification_node.cpp
+ * @brief Offline identification of the aerodynamic tables entries from a flight log.
+ * The tables are loaded from the parameter server (load_parameters.launch), the refined
+ * tables are printed to stdout in aerodynamics_coeffs.yaml format.
+ *
+ * Private parameters:
+ * - log_path - csv flight log, see loadFlightLog
+ * - entries - list of the identified entries in "table/row/col" format
+ * - segment_duration - open loop simulation duration, sec
+ * - threads - amount of parallel simulators, 0 means hardware concurrency
+ * - iterations - maximum amount of the optimizer iterations
+ */
+
+#include <ros/ros.h>
+#include <set>
+#include <iostream>
+#include "vtolParamsIdentification.hpp"
+#include "ros_params_source.hpp"
+
+int main(int argc, char **argv){
+    ros::init(argc, argv, "vtol_params_identification_node");
+    ros::NodeHandle node_handler("~");
+
+    std::string logPath;
+    std::vector<std::string> entriesNames;
+    if(!node_handler.getParam("log_path", logPath) || !node_handler.getParam("entries", entriesNames)){
+        ROS_ERROR("Identification: There is no `log_path` or `entries` parameter.");
+        return -1;
+    }
+    double segmentDuration = node_handler.param("segment_duration",
+                                                VtolParamsIdentification::DEFAULT_SEGMENT_DURATION);
+    int threadsAmount = node_handler.param("threads", 0);
+    int maxIterations = node_handler.param("iterations",
+                                           static_cast<int>(VtolParamsIdentification::DEFAULT_MAX_ITERATIONS));
+
+    std::vector<TableEntry> entries(entriesNames.size());
+    std::set<std::string> tablesNames;
+    for(size_t idx = 0; idx < entriesNames.size(); idx++){
+        if(parseTableEntry(entriesNames[idx], entries[idx]) == -1){
+            ROS_ERROR_STREAM("Identification: wrong entry " << entriesNames[idx]);
+            return -1;
+        }
+        tablesNames.insert(entries[idx].table);
+    }
+
+    FlightLog log;
+    VtolParamsIdentification identification;
+    if(loadFlightLog(logPath, log) == -1 ||
+       identification.init(RosParamsSource(), log, entries, segmentDuration, std::max(threadsAmount, 0)) == -1){
+        ROS_ERROR("Identification: initialization failed.");
+        return -1;
+    }
+
+    auto values = identification.getInitialValues();
+    double initialResidual = identification.evaluate(values);
+    double residual = identification.identify(values, std::max(maxIterations, 0));
+    ROS_INFO_STREAM("Identification: " << identification.getSegmentsAmount() << " segments, residual "
+                    << initialResidual << " -> " << residual);
+
+    TablesWithCoeffs tables = identification.getTables();
+    for(const auto& name : tablesNames){
+        printTable(std::cout, tables, name);
+    }
+    return 0;
+}
@@ -0,0 +1,55 @@
+/**
+ * @file vtol_vector_env_server.cpp
+ * @brief Standalone server of the vectorized vtol environment, it doesn't need roscore.
+ * The parameters are read from the package configs and the trainer talks to the server
+ * through the shared memory ring, see VectorEnvRing for the layout.
+ *
+ * Usage: vtol_vector_env_server <config_dir> <shm_name> <envs> [threads] [dt] [substeps] [slots]
+ */
+
+#include <iostream>
+#include <csignal>
+#include <cstdlib>
+#include <atomic>
+#include "vtolVectorEnv.hpp"
+
+static std::atomic<bool> isRunning{true};
+
+static void handleSignal(int){
+    isRunning = false;
+}
+
+int main(int argc, char **argv){
+    if(argc < 4){
+        std::cerr << "Usage: " << argv[0]
+                  << " <config_dir> <shm_name> <envs> [threads] [dt] [substeps] [slots]" << std::endl;
+        return -1;
+    }
+    const std::string configDirectory = argv[1];
+    const std::string shmName = argv[2];
+    const size_t envsAmount = std::strtoul(argv[3], nullptr, 10);
+    const size_t threadsAmount = argc > 4 ? std::strtoul(argv[4], nullptr, 10) : 0;
+    const double dtSecs = argc > 5 ? std::strtod(argv[5], nullptr) : VtolVectorEnv::DEFAULT_DT;
+    const size_t substepsAmount = argc > 6 ? std::strtoul(argv[6], nullptr, 10) : 1;
+    const uint32_t slotsAmount = argc > 7 ? std::strtoul(argv[7], nullptr, 10) : 2;
+
+    YamlParamsSource params;
+    VtolVectorEnv env;
+    if(params.loadPackageConfigs(configDirectory) == -1 ||
+       env.init(params, envsAmount, dtSecs, substepsAmount, threadsAmount) == -1){
+        std::cerr << "VectorEnvServer: initialization failed." << std::endl;
+        return -1;
+    }
+
+    VectorEnvRing ring;
+    if(ring.create(shmName, slotsAmount, envsAmount,
+                   VtolVectorEnv::ACTIONS_SIZE, VtolVectorEnv::OBSERVATIONS_SIZE) == -1){
+        std::cerr << "VectorEnvServer: can't create the ring " << shmName << std::endl;
+        return -1;
+    }
+
+    std::signal(SIGINT, handleSignal);
+    std::signal(SIGTERM, handleSignal);
+    std::cout << "VectorEnvServer: " << envsAmount << " envs are served on /dev/shm" << shmName << std::endl;
+    return env.serve(ring, isRunning);
+}